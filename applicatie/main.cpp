@@ -1,21 +1,106 @@
-#define DEADZONE 2000
+// PID gains, from degrees of tilt to steps per second
+#define KP 150.0f
+#define KI 10.0f
+#define KD 2.0f
+// errors smaller than about half a step (360 / 4096 degrees) are ignored
+#define DEADBAND 0.05f
+#define MAX_STEP_RATE 1500.0f
+// after 200ms without a step the coils only get 25% of the time, the motors barely have to hold a balanced platform
+#define IDLE_TIME 200000
+#define IDLE_DUTY 25
+// 1kHz with the 184Hz filter and the most sensitive ranges: a sample shows a movement within 3ms
+#define SENSOR_CONFIG Mpu6050Config{dlpfBandwidth::hz184, 0, 0, 0}
+// 1 with a second MPU6050 on the base, with AD0 high so it answers at 0x69: then StepLossMonitors compare the steps
+// with the rotation of the platform relative to the base, and lower the step rate of a motor that loses steps.
+// Without it every movement of the base would look like lost steps to them.
+#define BASE_SENSOR 0
 
 #include "hwlib.hpp"
 #include "MPU6050.hpp"
+#include "dueTwiBus.hpp"
+#include "dueInterruptPin.hpp"
+#include "dataReadyMonitor.hpp"
 #include "stepper28BYJ48.hpp"
+#include "stepperEngine.hpp"
+#include "motionProfile.hpp"
+#include "attitudeEstimator.hpp"
+#include "pidController.hpp"
+#include "stabilizer.hpp"
+#include "cycleCounter.hpp"
+#include "traceBuffer.hpp"
+#include "mpu6050Calibrator.hpp"
+#include "dueFlashStore.hpp"
+#include "dueUartTx.hpp"
+#include "telemetry.hpp"
+#include "sampleLog.hpp"
+#include "stepLossMonitor.hpp"
 
+// The MPU6050 is mounted with its X-axis pointing up. Rotates the sample so Z points up,
+// which is what the AttitudeEstimator expects.
+Mpu6050Sample zUp(const Mpu6050Sample & sample){
+  Mpu6050Sample rotated = sample;
+  rotated.accX = sample.accY;
+  rotated.accY = sample.accZ;
+  rotated.accZ = sample.accX;
+  rotated.gyroX = sample.gyroY;
+  rotated.gyroY = sample.gyroZ;
+  rotated.gyroZ = sample.gyroX;
+  return rotated;
+}
+
+// The last 1024 events of the control loop, about 200ms, dumped when a 'd' comes in over the serial port.
+TraceEvent traceStorage[1024];
+
+// Room for about 130 telemetry packets, 130ms at 1kHz, to ride out moments the loop can't drain the ring.
+uint8_t telemetryStorage[4096];
+
+// The last 3 seconds or so of samples, dumped when an 'l' comes in over the serial port.
+uint8_t sampleLogStorage[128 * SampleLog::BLOCK_SIZE];
+
+// Prints the part of the time the coils of a motor were energized since the previous report, and starts over.
+void reportEnergized(const char * name, steppermotor & motor){
+  auto measured = motor.getMeasuredTime();
+  auto promille = measured > 0 ? motor.getEnergizedTime() * 1000 / measured : 0;
+  hwlib::cout << name << " energized " << static_cast<uint32_t>(promille / 10) << "." << static_cast<uint32_t>(promille % 10)
+    << "% of " << static_cast<uint32_t>(measured / 1000) << "ms" << hwlib::endl;
+  motor.resetEnergizedTime();
+}
+
+// Measures the offsets of the MPU6050 until it stood still long enough, and keeps them in flash.
+void recalibrate(Mpu6050Calibrator & calibrator, PersistentStore & store, Mpu6050Offsets & offsets){
+  hwlib::cout << "calibrating, keep the gimbal still and level" << hwlib::endl;
+  while(!calibrator.measure( offsets, 500, upAxis::xUp )){
+    hwlib::cout << "moved, trying again" << hwlib::endl;
+  }
+  if(!Mpu6050Calibrator::save( store, offsets )){
+    hwlib::cout << "saving the offsets failed" << hwlib::endl;
+  }
+}
+
+static_assert( mpu6050Config::latency( SENSOR_CONFIG ) <= 3000, "the control loop is tuned for at most 3ms of sensor latency" );
 
 int main(){
-  auto scl = hwlib::target::pin_oc(hwlib::target::pins::scl);
-	auto sda = hwlib::target::pin_oc(hwlib::target::pins::sda);
-  auto bus = hwlib::i2c_bus_bit_banged_scl_sda(scl, sda);
+  // the TWI peripheral runs the bus at 400kHz without the CPU
+  auto bus = DueTwiBus(400000);
   auto mpu = Mpu6050(bus, 0x68);
   hwlib::wait_ms( 500 );
 
   mpu.disableSleep();
-  mpu.setGyroConfig(0);
-  mpu.setAcceleroConfig(0);
-  mpu.setConfig(0);
+  // the INT pin (wired to pin 22) rises on every sample, SENSOR_CONFIG sets how often that is
+  mpu.configure( SENSOR_CONFIG );
+  mpu.enableDataReadyInterrupt();
+
+  // the offsets survive in the last page of flash until a new program is uploaded, then they are measured again
+  auto store = DueFlashStore();
+  auto calibrator = Mpu6050Calibrator( mpu );
+  Mpu6050Offsets offsets;
+  if(!Mpu6050Calibrator::load( store, offsets )){
+    recalibrate( calibrator, store, offsets );
+  }
+  calibrator.apply( offsets );
+
+  auto intPin = DueInterruptPin( 1, 26 );
+  DataReadyMonitor dataReady( intPin );
 
   auto input0 = hwlib::target::pin_out( 3, 4 );
   auto input1 = hwlib::target::pin_out( 3, 5 );
@@ -30,30 +115,79 @@ int main(){
   auto input7 = hwlib::target::pin_out( 2, 26 );
   auto poort1 = hwlib::port_out_from( input4, input5, input6, input7 );
   auto motor1 = stepper28BYJ48( poort1 );
+  motor0.setIdlePolicy( idlePolicy::pulse, IDLE_TIME, IDLE_DUTY );
+  motor1.setIdlePolicy( idlePolicy::pulse, IDLE_TIME, IDLE_DUTY );
+
+  // start at 500 steps/s, ramp up to 1500 steps/s with an S-curve
+  auto profile = MotionProfile( 1500, 8000, 100000, 500 );
+  auto engine0 = StepperEngine( motor0 );
+  auto engine1 = StepperEngine( motor1 );
+  engine0.setProfile( profile );
+  engine1.setProfile( profile );
 
-  int16_t AccY = 0;
-  int16_t AccZ = 0;
+  // motor0 levels what used to be the accelerometer's Y-axis, which is pitch after zUp,
+  // motor1 levels the Z-axis, which is roll after zUp.
+  auto estimator = ComplementaryFilter( mpu.readGyroConfig() );
+  auto pid0 = PidController( KP, KI, KD, MAX_STEP_RATE, 10000, DEADBAND );
+  auto pid1 = PidController( KP, KI, KD, MAX_STEP_RATE, 10000, DEADBAND );
+  auto stabilizer = Stabilizer( mpu, dataReady, estimator, pid0, pid1, engine0, engine1, zUp );
+#if BASE_SENSOR
+  // shares the bus, which leaves room for a second burst read of 14 bytes in every 1ms sample
+  auto baseMpu = Mpu6050( bus, 0x69 );
+  baseMpu.disableSleep();
+  baseMpu.configure( SENSOR_CONFIG );
+  // the pitch motor turns the pitch down, so the gyroscope sees its steps the other way around
+  auto monitor0 = StepLossMonitor( engine0, -360.0f / 4096, mpu.readGyroConfig(), MAX_STEP_RATE );
+  auto monitor1 = StepLossMonitor( engine1, 360.0f / 4096, mpu.readGyroConfig(), MAX_STEP_RATE );
+  stabilizer.setStepLossMonitors( &monitor0, &monitor1, &baseMpu );
+#endif
 
+  cycleCounter::enable();
+  auto trace = TraceBuffer( traceStorage, 1024 );
+  stabilizer.setTrace( &trace );
+  auto sampleLog = SampleLog( sampleLogStorage, sizeof( sampleLogStorage ), mpu6050Config::samplePeriod( SENSOR_CONFIG ) );
+  stabilizer.setSampleLog( &sampleLog );
+
+  // from here on the serial port runs at 400000 baud, for the PC as well: ./telemetryrecorder /dev/ttyACM0 log.csv
+  hwlib::cout << "streaming telemetry at 400000 baud" << hwlib::endl;
+  auto uart = DueUartTx( 400000 );
+  auto telemetry = Telemetry( telemetryStorage, sizeof( telemetryStorage ) );
+  stabilizer.setTelemetry( &telemetry );
+
+  stabilizer.start( hwlib::now_us() );
   for(;;)
   {
-    AccY = mpu.readAccYRaw();
-    AccZ = mpu.readAccZRaw();
-    if(AccY > DEADZONE)
-    {
-      motor0.turnCounterClockwise();
-    }
-    else if(AccY < -DEADZONE)
-    {
-      motor0.turnClockwise();
-    }
-    if(AccZ > DEADZONE)
-    {
-      motor1.turnCounterClockwise();
-    }
-    else if(AccZ < -DEADZONE)
+    stabilizer.poll( hwlib::now_us() );
+    telemetry.drain( uart );
+    if(hwlib::uart_char_available())
     {
-      motor1.turnClockwise();
+      // don't print in the middle of a packet
+      while(uart.busy()){}
+      auto command = hwlib::uart_getc();
+      if(command == 'd')
+      {
+        trace.dump( [](uint8_t b){ hwlib::uart_putc( b ); } );
+      }
+      else if(command == 'l')
+      {
+        sampleLog.dump( [](uint8_t b){ hwlib::uart_putc( b ); } );
+      }
+      else if(command == 'e')
+      {
+        reportEnergized( "motor0", motor0 );
+        reportEnergized( "motor1", motor1 );
+#if BASE_SENSOR
+        hwlib::cout << "lost steps " << monitor0.getSlips() << " and " << monitor1.getSlips()
+          << " times, speed limits " << monitor0.getSpeedLimit() << " and " << monitor1.getSpeedLimit() << hwlib::endl;
+#endif
+      }
+      else if(command == 'c')
+      {
+        // the offsets applied so far are part of what measure returns
+        recalibrate( calibrator, store, offsets );
+        calibrator.apply( offsets );
+        stabilizer.start( hwlib::now_us() );
+      }
     }
-    hwlib::wait_ms(1);
   }
 }
@@ -0,0 +1,235 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "hwlib.hpp"
+#include "MPU6050.hpp"
+#include "staticMpu6050.hpp"
+#include "dueTwiBus.hpp"
+#include "dueInterruptPin.hpp"
+#include "dataReadyMonitor.hpp"
+#include "stepper28BYJ48.hpp"
+#include "stepperEngine.hpp"
+#include "motionProfile.hpp"
+#include "attitudeEstimator.hpp"
+#include "pidController.hpp"
+#include "stabilizer.hpp"
+#include "cycleCounter.hpp"
+#include "cycleStatistics.hpp"
+#include "traceBuffer.hpp"
+#include "telemetry.hpp"
+#include "sampleLog.hpp"
+
+// Times pieces of the driver and the control loop with the DWT cycle counter and prints
+// min, mean, 99th percentile and max of every one over the serial console.
+// Needs the same hardware as applicatie: the MPU6050 on SDA/SCL with its INT pin on pin 22, and the two motors.
+
+// The most timings kept per measurement.
+const size_t MAX_RUNS = 2000;
+
+uint32_t storage[MAX_RUNS];
+uint32_t idleStorage[MAX_RUNS];
+TraceEvent traceStorage[256];
+
+// The cycles it takes to read the cycle counter twice, subtracted from every timing.
+uint32_t overhead = 0;
+
+// Prints cycles as microseconds with one decimal, at 84MHz.
+void printMicroseconds(uint32_t cycles){
+  uint32_t tenths = (cycles * 10 + 42) / 84;
+  hwlib::cout << tenths / 10 << "." << tenths % 10;
+}
+
+void printStatistics(const char * name, CycleStatistics & statistics){
+  hwlib::cout << name << " (" << statistics.size() << " runs): min " << statistics.min()
+    << ", mean " << statistics.mean()
+    << ", p99 " << statistics.percentile(99)
+    << ", max " << statistics.max() << " cycles, p99 ";
+  printMicroseconds(statistics.percentile(99));
+  hwlib::cout << "us" << hwlib::endl;
+}
+
+// Times f runs times and prints the result.
+template< typename F >
+void measure(const char * name, uint16_t runs, F f){
+  CycleStatistics statistics(storage, MAX_RUNS);
+  for(uint16_t i = 0; i < runs; i++){
+    uint32_t start = cycleCounter::now();
+    f();
+    uint32_t cycles = cycleCounter::now() - start;
+    statistics.add(cycles > overhead ? cycles - overhead : 0);
+  }
+  printStatistics(name, statistics);
+}
+
+// Times f runs times like measure above, but calls setup before every run, outside the timed part.
+template< typename S, typename F >
+void measure(const char * name, uint16_t runs, S setup, F f){
+  CycleStatistics statistics(storage, MAX_RUNS);
+  for(uint16_t i = 0; i < runs; i++){
+    setup();
+    uint32_t start = cycleCounter::now();
+    f();
+    uint32_t cycles = cycleCounter::now() - start;
+    statistics.add(cycles > overhead ? cycles - overhead : 0);
+  }
+  printStatistics(name, statistics);
+}
+
+// Times all single register reads and conversions on the given bus.
+void benchmarkDriver(const char * bus, Mpu6050 & mpu){
+  hwlib::cout << "-- " << bus << hwlib::endl;
+  measure("readAccYRaw", 1000, [&](){ mpu.readAccYRaw(); });
+  measure("readAccY", 1000, [&](){ mpu.readAccY(); });
+  measure("readGyroX", 1000, [&](){ mpu.readGyroX(); });
+  measure("readAll", 1000, [&](){ mpu.readAll(); });
+}
+
+int main(){
+  hwlib::wait_ms( 500 );
+  cycleCounter::enable();
+
+  uint32_t start = cycleCounter::now();
+  overhead = cycleCounter::now() - start;
+  hwlib::cout << "Overhead: " << overhead << " cycles" << hwlib::endl;
+
+  // the bit banged bus first, DueTwiBus takes the pins over for good
+  auto scl = hwlib::target::pin_oc(hwlib::target::pins::scl);
+  auto sda = hwlib::target::pin_oc(hwlib::target::pins::sda);
+  auto bitBangedBus = hwlib::i2c_bus_bit_banged_scl_sda(scl, sda);
+  auto slowMpu = Mpu6050(bitBangedBus, 0x68);
+  slowMpu.disableSleep();
+  slowMpu.setGyroConfig(0);
+  slowMpu.setAcceleroConfig(0);
+  slowMpu.setConfig(1);
+  benchmarkDriver("bit banged i2c", slowMpu);
+
+  auto twiBus = DueTwiBus(400000);
+  auto mpu = Mpu6050(twiBus, 0x68);
+  benchmarkDriver("TWI at 400kHz", mpu);
+
+  // the same reads with everything fixed at compile time, on the same bus
+  hwlib::cout << "-- StaticMpu6050, TWI at 400kHz" << hwlib::endl;
+  auto staticMpu = StaticMpu6050< DueTwiBus >(twiBus);
+  measure("readAccYRaw", 1000, [&](){ staticMpu.readAccYRaw(); });
+  measure("readAccY", 1000, [&](){ staticMpu.readAccY(); });
+  measure("readGyroX", 1000, [&](){ staticMpu.readGyroX(); });
+  measure("readAll", 1000, [&](){ staticMpu.readAll(); });
+  hwlib::cout << "sizeof Mpu6050: " << sizeof(Mpu6050)
+    << ", sizeof StaticMpu6050: " << sizeof(staticMpu) << hwlib::endl;
+
+  hwlib::cout << "-- conversions and estimators" << hwlib::endl;
+  volatile int16_t value = 12345;
+  measure("convertAccelero", 1000, [&](){ int16_t v = value; mpu.convertAccelero(v); value = v; });
+  measure("convertGyro", 1000, [&](){ int16_t v = value; mpu.convertGyro(v); value = v; });
+  measure("StaticMpu6050::convertAccelero", 1000, [&](){ value = staticMpu.convertAccelero(value); });
+  measure("StaticMpu6050::convertGyro", 1000, [&](){ value = staticMpu.convertGyro(value); });
+  // the float and fixed point versions of the same conversion, the difference is what soft float costs
+  volatile int32_t scaled = 0;
+  measure("sensorUnits::floatAccelero", 1000, [&](){ scaled = sensorUnits::floatAccelero(value, 0); });
+  measure("sensorUnits::fixedAccelero", 1000, [&](){ scaled = sensorUnits::fixedAccelero(value, 0); });
+  measure("sensorUnits::floatGyro", 1000, [&](){ scaled = sensorUnits::floatGyro(value, 0); });
+  measure("sensorUnits::fixedGyro", 1000, [&](){ scaled = sensorUnits::fixedGyro(value, 0); });
+  measure("sensorUnits::floatTemperature", 1000, [&](){ scaled = sensorUnits::floatTemperature(value); });
+  measure("sensorUnits::fixedTemperature", 1000, [&](){ scaled = sensorUnits::fixedTemperature(value); });
+  Mpu6050Sample raw = {1000, -2000, 16384, -340, 131, -262, 32767};
+  measure("Mpu6050::scale", 1000, [&](){ raw.accY++; scaled = mpu.scale(raw).accY; });
+  Mpu6050Sample sample = {0, 0, 16384, 0, 131, -65, 0};
+  auto complementary = ComplementaryFilter();
+  auto madgwick = MadgwickFilter();
+  measure("ComplementaryFilter::update", 1000, [&](){ sample.accY += 8; complementary.update(sample, 1000); });
+  measure("MadgwickFilter::update", 1000, [&](){ sample.accY += 8; madgwick.update(sample, 1000); });
+  auto trace = TraceBuffer( traceStorage, 256 );
+  measure("TraceBuffer::record", 1000, [&](){ trace.record(TRACE_USER, 42); });
+
+  hwlib::cout << "-- motors" << hwlib::endl;
+  auto input0 = hwlib::target::pin_out( 3, 4 );
+  auto input1 = hwlib::target::pin_out( 3, 5 );
+  auto input2 = hwlib::target::pin_out( 0, 13 );
+  auto input3 = hwlib::target::pin_out( 0, 12 );
+  auto poort0 = hwlib::port_out_from( input0, input1, input2, input3 );
+  auto motor0 = stepper28BYJ48( poort0 );
+
+  auto input4 = hwlib::target::pin_out( 0, 9 );
+  auto input5 = hwlib::target::pin_out( 1, 25 );
+  auto input6 = hwlib::target::pin_out( 2, 28 );
+  auto input7 = hwlib::target::pin_out( 2, 26 );
+  auto poort1 = hwlib::port_out_from( input4, input5, input6, input7 );
+  auto motor1 = stepper28BYJ48( poort1 );
+
+  // the motor needs a millisecond between steps, which is left out of the timing
+  measure("stepClockwise", 1000, [&](){ hwlib::wait_ms(1); }, [&](){ motor0.stepClockwise(); });
+  measure("turnClockwise (waits 650us)", 200, [&](){ motor0.turnClockwise(); });
+
+  hwlib::cout << "-- telemetry" << hwlib::endl;
+  // a port that is never busy, so the ring never fills and only encoding and queueing are timed
+  struct discardPort {
+    bool busy(){ return false; }
+    void send(const uint8_t [], size_t){}
+  } discard;
+  static uint8_t telemetryStorage[1024];
+  auto telemetry = Telemetry( telemetryStorage, sizeof( telemetryStorage ) );
+  auto telemetrySample = mpu.readAll();
+  measure("Telemetry::sendLoop and drain", 1000, [&](){
+    telemetry.sendLoop( 0, telemetrySample, 1.5f, -2.5f, 500, -500 );
+    telemetry.drain( discard );
+    telemetry.drain( discard );
+  });
+
+  hwlib::cout << "-- sample log" << hwlib::endl;
+  // live samples at 1kHz, so the compression is that of the real noise of the chip on the desk
+  static uint8_t logStorage[64 * SampleLog::BLOCK_SIZE];
+  auto sampleLog = SampleLog( logStorage, sizeof( logStorage ) );
+  CycleStatistics recording(storage, MAX_RUNS);
+  auto next = hwlib::now_us();
+  for(int i = 0; i < 1000; i++){
+    next += 1000;
+    while(hwlib::now_us() < next){}
+    auto time = hwlib::now_us();
+    auto sample = mpu.readAll();
+    uint32_t begin = cycleCounter::now();
+    sampleLog.record( time, sample );
+    recording.add( cycleCounter::now() - begin - overhead );
+  }
+  printStatistics("SampleLog::record", recording);
+  hwlib::cout << sampleLog.size() << " samples in " << sampleLog.bytes() << " bytes, "
+    << sampleLog.bytes() * 10 / sampleLog.size() / 10 << "." << sampleLog.bytes() * 10 / sampleLog.size() % 10 << " per sample, raw "
+    << sizeof(Mpu6050Sample) + sizeof(uint32_t) << hwlib::endl;
+
+  hwlib::cout << "-- control loop" << hwlib::endl;
+  mpu.enableDataReadyInterrupt();
+  auto intPin = DueInterruptPin( 1, 26 );
+  DataReadyMonitor dataReady( intPin );
+  auto profile = MotionProfile( 1500, 8000, 100000, 500 );
+  auto engine0 = StepperEngine( motor0 );
+  auto engine1 = StepperEngine( motor1 );
+  engine0.setProfile( profile );
+  engine1.setProfile( profile );
+  auto estimator = ComplementaryFilter( mpu.readGyroConfig() );
+  auto pid0 = PidController( 150, 10, 2, 1500, 10000, 0.05f );
+  auto pid1 = PidController( 150, 10, 2, 1500, 10000, 0.05f );
+  auto stabilizer = Stabilizer( mpu, dataReady, estimator, pid0, pid1, engine0, engine1 );
+
+  // iterations that handle a sample and the ones that only poll the engines cost very different amounts
+  CycleStatistics sampled(storage, MAX_RUNS);
+  CycleStatistics idle(idleStorage, MAX_RUNS);
+  stabilizer.start( hwlib::now_us() );
+  while(sampled.size() < MAX_RUNS){
+    auto now = hwlib::now_us();
+    uint32_t begin = cycleCounter::now();
+    bool used = stabilizer.poll( now );
+    uint32_t cycles = cycleCounter::now() - begin - overhead;
+    if(used){
+      sampled.add(cycles);
+    }else{
+      idle.add(cycles);
+    }
+  }
+  engine0.stop();
+  engine1.stop();
+  printStatistics("loop iteration with a sample", sampled);
+  printStatistics("loop iteration without a sample", idle);
+
+  hwlib::cout << "Benchmark complete" << hwlib::endl;
+}
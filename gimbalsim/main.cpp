@@ -0,0 +1,110 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "gimbalSimulator.hpp"
+#include <stdio.h>
+
+// Runs every control strategy against every disturbance and prints a table to compare them.
+// Add a strategy or a disturbance to the lists below to try it.
+
+struct strategy {
+  const char *name;
+  ControllerSettings settings;
+};
+
+struct scenario {
+  const char *name;
+  Disturbance disturbance;
+  uint_fast64_t duration;
+};
+
+static ControllerSettings pOnly(){
+  ControllerSettings s;
+  s.ki = 0;
+  s.kd = 0;
+  return s;
+}
+
+static ControllerSettings soft(){
+  ControllerSettings s;
+  s.kp = 60;
+  s.ki = 4;
+  return s;
+}
+
+static ControllerSettings madgwick(){
+  ControllerSettings s;
+  s.madgwick = true;
+  return s;
+}
+
+static ControllerSettings overdriven(){
+  ControllerSettings s;
+  s.kp = 400;
+  s.maxStepRate = 2500;
+  s.maxSpeed = 2500;
+  s.acceleration = 30000;
+  return s;
+}
+
+static ControllerSettings guarded(){
+  ControllerSettings s = overdriven();
+  s.stepLossMonitor = true;
+  return s;
+}
+
+static ControllerSettings calibrated(){
+  ControllerSettings s;
+  s.calibrate = true;
+  return s;
+}
+
+static ControllerSettings releaseIdle(){
+  ControllerSettings s;
+  s.idle = idlePolicy::release;
+  return s;
+}
+
+static ControllerSettings pulseIdle(){
+  ControllerSettings s;
+  s.idle = idlePolicy::pulse;
+  return s;
+}
+
+int main(){
+  const strategy strategies[] = {
+    { "applicatie", ControllerSettings() },
+    { "P only", pOnly() },
+    { "soft", soft() },
+    { "madgwick", madgwick() },
+    { "calibrated", calibrated() },
+    { "overdriven", overdriven() },
+    { "guarded", guarded() },
+    { "release idle", releaseIdle() },
+    { "pulse idle", pulseIdle() },
+  };
+  const scenario scenarios[] = {
+    { "step 10 roll", Disturbance::step(10, 0), 3000000 },
+    { "step 10/-10", Disturbance::step(10, -10), 3000000 },
+    { "sine 5 1Hz", Disturbance::sine(5, 5, 1), 5000000 },
+    { "shake 8", Disturbance::shake(8), 5000000 },
+  };
+
+  printf("%-14s %-12s %9s %9s %12s %8s %6s %6s %10s\n", "disturbance", "strategy", "rms deg", "max deg", "settling ms", "steps", "lost", "slips", "energized");
+  for(const scenario & sc : scenarios){
+    for(const strategy & st : strategies){
+      GimbalSimulator simulator(sc.disturbance);
+      SimulationReport r = simulator.run(st.settings, sc.duration);
+      char settling[24];
+      if(r.settlingTime < 0){
+        snprintf(settling, sizeof(settling), "-");
+      }else{
+        snprintf(settling, sizeof(settling), "%lld", static_cast<long long>(r.settlingTime / 1000));
+      }
+      printf("%-14s %-12s %9.3f %9.3f %12s %8u %6u %6u %9.1f%%\n", sc.name, st.name, r.rmsError, r.maxError, settling, r.steps, r.lostSteps, r.slips, r.energized * 100);
+    }
+  }
+  return 0;
+}
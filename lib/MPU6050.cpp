@@ -8,31 +8,162 @@
 #include "hwlib.hpp"
 #include <cmath>
 
-Mpu6050::Mpu6050(hwlib::i2c_bus_bit_banged_scl_sda &sensor, const uint8_t &sensorAddress):
-	sensor( sensor ),
+const size_t Mpu6050::FIFO_BURST_FRAMES;
+
+Mpu6050::Mpu6050(hwlib::i2c_bus &sensor, const uint8_t &sensorAddress):
+	hwlibSensor( &sensor ),
+	sensor( nullptr ),
 	sensorAddress( sensorAddress )
 {}
 
+Mpu6050::Mpu6050(i2cRegisterBus &sensor, const uint8_t &sensorAddress):
+	hwlibSensor( nullptr ),
+	sensor( &sensor ),
+	sensorAddress( sensorAddress )
+{}
+
+void Mpu6050::busWrite(const uint8_t data[], size_t n){
+	if(sensor != nullptr){
+		sensor->write(sensorAddress, data, n);
+	}else{
+		hwlib::i2c_write_transaction(*hwlibSensor, sensorAddress).write(data, n);
+	}
+}
+
+void Mpu6050::busRead(uint8_t data[], size_t n){
+	if(sensor != nullptr){
+		sensor->read(sensorAddress, data, n);
+	}else{
+		hwlib::i2c_read_transaction(*hwlibSensor, sensorAddress).read(data, n);
+	}
+}
+
+uint8_t Mpu6050::busReadByte(){
+	uint8_t value;
+	busRead(&value, 1);
+	return value;
+}
+
 void Mpu6050::selectRegister(const uint8_t &registerAdress){
-  hwlib::i2c_write_transaction(sensor, sensorAddress).write(registerAdress);
+  busWrite(&registerAdress, 1);
 }
 
 void Mpu6050::disableSleep(){
 	const uint8_t sleepValue[2] = {PWR_MGMT_1, 0};
-	hwlib::i2c_write_transaction(sensor, sensorAddress).write(sleepValue, 2);
+	busWrite(sleepValue, 2);
 }
 
 void Mpu6050::enableSleep(){
 	const uint8_t sleepValue[2] = {PWR_MGMT_1, 1};
-	hwlib::i2c_write_transaction(sensor, sensorAddress).write(sleepValue, 2);
+	busWrite(sleepValue, 2);
 }
 
 uint8_t Mpu6050::readRegister(const uint8_t &registerAdress){
-	selectRegister(registerAdress);
-	uint8_t value = hwlib::i2c_read_transaction(sensor, sensorAddress).read_byte();
+	uint8_t value;
+	readRegisters(registerAdress, &value, 1);
 	return value;
 }
 
+void Mpu6050::readRegisters(const uint8_t &registerAdress, uint8_t data[], size_t n){
+	if(sensor != nullptr){
+		sensor->readRegisters(sensorAddress, registerAdress, data, n);
+	}else{
+		selectRegister(registerAdress);
+		busRead(data, n);
+	}
+}
+
+Mpu6050Sample Mpu6050::decodeSample(const uint8_t data[14]){
+	Mpu6050Sample sample;
+	sample.accX =        concatenateBytes(data[0], data[1]);
+	sample.accY =        concatenateBytes(data[2], data[3]);
+	sample.accZ =        concatenateBytes(data[4], data[5]);
+	sample.temperature = concatenateBytes(data[6], data[7]);
+	sample.gyroX =       concatenateBytes(data[8], data[9]);
+	sample.gyroY =       concatenateBytes(data[10], data[11]);
+	sample.gyroZ =       concatenateBytes(data[12], data[13]);
+	return sample;
+}
+
+Mpu6050Sample Mpu6050::readAll(){
+	uint8_t data[14];
+	readRegisters(ACCEL_XOUT_H, data, 14);
+	return decodeSample(data);
+}
+
+void Mpu6050::enableFifo(){
+	const uint8_t fifoValue[2] = {FIFO_EN, 0xF8}; // TEMP, XG, YG, ZG and ACCEL
+	busWrite(fifoValue, 2);
+	const uint8_t userValue[2] = {USER_CTRL, 0x44}; // FIFO_EN and FIFO_RESET
+	busWrite(userValue, 2);
+}
+
+void Mpu6050::disableFifo(){
+	const uint8_t userValue[2] = {USER_CTRL, 0};
+	busWrite(userValue, 2);
+	const uint8_t fifoValue[2] = {FIFO_EN, 0};
+	busWrite(fifoValue, 2);
+}
+
+void Mpu6050::resetFifo(){
+	auto userControl = readRegister(USER_CTRL);
+	const uint8_t userValue[2] = {USER_CTRL, static_cast<uint8_t>(userControl | 0x04)}; // FIFO_RESET clears itself
+	busWrite(userValue, 2);
+}
+
+uint16_t Mpu6050::readFifoCount(){
+	uint8_t data[2];
+	readRegisters(FIFO_COUNTH, data, 2);
+	return (data[0] << 8) | data[1];
+}
+
+size_t Mpu6050::readFifo(Mpu6050SampleBuffer & buffer, size_t maxFrames){
+	auto count = readFifoCount();
+	if(count >= FIFO_SIZE){
+		fifoOverflows++;
+		resetFifo();
+		return 0;
+	}
+	size_t frames = count / FIFO_FRAME_SIZE;
+	if(frames > maxFrames){ frames = maxFrames; }
+	if(frames > buffer.space()){ frames = buffer.space(); }
+	if(frames == 0){
+		return 0;
+	}
+	// reading FIFO_R_W doesn't increment the register pointer, it pops the FIFO
+	uint8_t data[FIFO_BURST_FRAMES * 14];
+	for(size_t done = 0; done < frames; ){
+		size_t burst = frames - done;
+		if(burst > FIFO_BURST_FRAMES){ burst = FIFO_BURST_FRAMES; }
+		readRegisters(FIFO_R_W, data, burst * FIFO_FRAME_SIZE);
+		for(size_t i = 0; i < burst; i++){
+			buffer.push(decodeSample(data + i * FIFO_FRAME_SIZE));
+		}
+		done += burst;
+	}
+	return frames;
+}
+
+uint32_t Mpu6050::readFifoOverflows(){
+	return fifoOverflows;
+}
+
+void Mpu6050::enableDataReadyInterrupt(){
+	const uint8_t pinValue[2] = {INT_PIN_CFG, 0}; // active high, push-pull, 50us pulse
+	busWrite(pinValue, 2);
+	const uint8_t enableValue[2] = {INT_ENABLE, 0x01}; // DATA_RDY_EN
+	busWrite(enableValue, 2);
+}
+
+void Mpu6050::disableDataReadyInterrupt(){
+	const uint8_t enableValue[2] = {INT_ENABLE, 0};
+	busWrite(enableValue, 2);
+}
+
+uint8_t Mpu6050::readInterruptStatus(){
+	return readRegister(INT_STATUS);
+}
+
 int16_t Mpu6050::concatenateBytes(const uint8_t &msb, const uint8_t &lsb){
 	int16_t value = 0;
 	value = (msb << 8) | lsb;
@@ -41,7 +172,7 @@ int16_t Mpu6050::concatenateBytes(const uint8_t &msb, const uint8_t &lsb){
 
 int16_t Mpu6050::readAccX(){
 	auto msb = readRegister(ACCEL_XOUT_H);
-	auto lsb = hwlib::i2c_read_transaction(sensor, sensorAddress).read_byte();
+	auto lsb = busReadByte();
 	int16_t value = concatenateBytes(msb, lsb);
 	convertAccelero(value);
 	return value;
@@ -49,14 +180,14 @@ int16_t Mpu6050::readAccX(){
 
 int16_t Mpu6050::readAccXRaw(){
 	auto msb = readRegister(ACCEL_XOUT_H);
-	auto lsb = hwlib::i2c_read_transaction(sensor, sensorAddress).read_byte();
+	auto lsb = busReadByte();
 	int16_t value = concatenateBytes(msb, lsb);
 	return value;
 }
 
 int16_t Mpu6050::readAccY(){
 	auto msb = readRegister(ACCEL_YOUT_H);
-	auto lsb = hwlib::i2c_read_transaction(sensor, sensorAddress).read_byte();
+	auto lsb = busReadByte();
 	int16_t value = concatenateBytes(msb, lsb);
 	convertAccelero(value);
 	return value;
@@ -64,14 +195,14 @@ int16_t Mpu6050::readAccY(){
 
 int16_t Mpu6050::readAccYRaw(){
 	auto msb = readRegister(ACCEL_YOUT_H);
-	auto lsb = hwlib::i2c_read_transaction(sensor, sensorAddress).read_byte();
+	auto lsb = busReadByte();
 	int16_t value = concatenateBytes(msb, lsb);
 	return value;
 }
 
 int16_t Mpu6050::readAccZ(){
 	auto msb = readRegister(ACCEL_ZOUT_H);
-	auto lsb = hwlib::i2c_read_transaction(sensor, sensorAddress).read_byte();
+	auto lsb = busReadByte();
 	int16_t value = concatenateBytes(msb, lsb);
 	convertAccelero(value);
 	return value;
@@ -79,7 +210,7 @@ int16_t Mpu6050::readAccZ(){
 
 int16_t Mpu6050::readAccZRaw(){
 	auto msb = readRegister(ACCEL_ZOUT_H);
-	auto lsb = hwlib::i2c_read_transaction(sensor, sensorAddress).read_byte();
+	auto lsb = busReadByte();
 	int16_t value = concatenateBytes(msb, lsb);
 	return value;
 }
@@ -130,36 +261,49 @@ int16_t Mpu6050::readTemperature(){
 	auto msb = readRegister(TEMP_OUT_H);
 	auto lsb = readRegister(TEMP_OUT_L);
 	auto value = concatenateBytes(msb, lsb);
-	value = value / 340 + 31.53;
+	value = value / 340 + 31.53f;
 	return value;
 }
 
 void Mpu6050::convertGyro(int16_t & value){
+	// LSB per degree per second for fs_sel 0 to 3
+	static const float sensitivities[4] = {131.0f, 65.5f, 32.8f, 16.4f};
 	float input = value;
-	input /= readGyroConfig();
+	input /= sensitivities[(gyroConfigShadow >> 3) & 0x03];
 	value = input;
 }
 
 void Mpu6050::convertAccelero(int16_t & value){
 	float input = value;
 	input *= 981;
-	input /= readAcceleroConfig();
+	input /= 16384 >> ((acceleroConfigShadow >> 3) & 0x03);
 	value = input;
 }
 
+Mpu6050ScaledSample Mpu6050::scale(const Mpu6050Sample & sample){
+	return sensorUnits::scale(sample, (acceleroConfigShadow >> 3) & 0x03, (gyroConfigShadow >> 3) & 0x03);
+}
+
+Mpu6050ScaledSample Mpu6050::readAllScaled(){
+	return scale(readAll());
+}
+
 void Mpu6050::setAcceleroConfig(uint8_t afs_sel){
 	if(afs_sel >= 0 && afs_sel <= 3){
 		afs_sel = afs_sel << 3;
 		const uint8_t configValue[2] = {ACCEL_CONFIG, afs_sel};
-		hwlib::i2c_write_transaction(sensor, sensorAddress).write(configValue, 2);
+		busWrite(configValue, 2);
+		acceleroConfigShadow = afs_sel;
 	}else{
 		const uint8_t configValue[2] = {ACCEL_CONFIG, 0};
-		hwlib::i2c_write_transaction(sensor, sensorAddress).write(configValue, 2);
+		busWrite(configValue, 2);
+		acceleroConfigShadow = 0;
 	}
 }
 
 int16_t Mpu6050::readAcceleroConfig(){
 	auto config = readRegister(ACCEL_CONFIG);
+	acceleroConfigShadow = config;
 	int16_t returnValue = 16384;
 	config &= 0x18; // get rid of ST bits, which are not needed
 	config = config >> 3; // shift the two desired bits all the way to the right for the appropriate int.
@@ -171,19 +315,21 @@ void Mpu6050::setGyroConfig(uint8_t fs_sel){
 	if(fs_sel >= 0 && fs_sel <= 3){
 		fs_sel = fs_sel << 3;
 		const uint8_t configValue[2] = {GYRO_CONFIG, fs_sel};
-		hwlib::i2c_write_transaction(sensor, sensorAddress).write(configValue, 2);
+		busWrite(configValue, 2);
+		gyroConfigShadow = fs_sel;
 	}else{
 		const uint8_t configValue[2] = {GYRO_CONFIG, 0};
-		hwlib::i2c_write_transaction(sensor, sensorAddress).write(configValue, 2); // write default of zero in case of unexpected input
+		busWrite(configValue, 2); // write default of zero in case of unexpected input
+		gyroConfigShadow = 0;
 	}
 }
 
 float Mpu6050::readGyroConfig(){
 	uint8_t config = readRegister(GYRO_CONFIG);
+	gyroConfigShadow = config;
 	float returnValue;
 	config = config << 3; // get rid of ST bits, which are not needed
 	config = config >> 6; // shift the two desired bits all the way to the right for the appropriate int.
-	hwlib::cout << config << hwlib::endl;
 	if(config == 3){ returnValue = 16.4; }
 	if(config == 2){ returnValue = 32.8; }
 	if(config == 1){ returnValue = 65.5; }
@@ -194,15 +340,94 @@ float Mpu6050::readGyroConfig(){
 void Mpu6050::setConfig(uint8_t dlpf){
 	if(dlpf >= 0 && dlpf <= 6){
 		const uint8_t configValue[2] = {CONFIG, dlpf};
-		hwlib::i2c_write_transaction(sensor, sensorAddress).write(configValue, 2);
+		busWrite(configValue, 2);
+		configShadow = dlpf;
 	}else{
 		const uint8_t configValue[2] = {CONFIG, 0};
-		hwlib::i2c_write_transaction(sensor, sensorAddress).write(configValue, 2); // write default of zero in case of unexpected input
+		busWrite(configValue, 2); // write default of zero in case of unexpected input
+		configShadow = 0;
 	}
 }
 
 uint8_t Mpu6050::readConfig(){
 	auto config = readRegister(CONFIG);
+	configShadow = config;
 	config &= 0b00000111;
 	return config;
 }
+
+void Mpu6050::configure(const Mpu6050Config & config){
+	uint8_t dlpf = static_cast<uint8_t>(config.bandwidth);
+	if(dlpf > 6){ dlpf = 0; }
+	uint8_t afs_sel = config.afs_sel <= 3 ? config.afs_sel : 0;
+	uint8_t fs_sel = config.fs_sel <= 3 ? config.fs_sel : 0;
+	// SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG are consecutive registers
+	const uint8_t data[5] = {SMPLRT_DIV, config.rateDivider, dlpf, static_cast<uint8_t>(fs_sel << 3), static_cast<uint8_t>(afs_sel << 3)};
+	busWrite(data, 5);
+	rateDividerShadow = data[1];
+	configShadow = data[2];
+	gyroConfigShadow = data[3];
+	acceleroConfigShadow = data[4];
+}
+
+Mpu6050Config Mpu6050::getConfiguration(){
+	uint8_t dlpf = configShadow & 0x07;
+	if(dlpf > 6){ dlpf = 0; } // DLPF_CFG 7 is reserved, the chip then samples like at 0
+	return Mpu6050Config{
+		static_cast<dlpfBandwidth>(dlpf),
+		rateDividerShadow,
+		static_cast<uint8_t>((acceleroConfigShadow >> 3) & 0x03),
+		static_cast<uint8_t>((gyroConfigShadow >> 3) & 0x03)
+	};
+}
+
+uint32_t Mpu6050::samplePeriod(){
+	return mpu6050Config::samplePeriod(getConfiguration());
+}
+
+uint32_t Mpu6050::filterDelay(){
+	return mpu6050Config::filterDelay(getConfiguration());
+}
+
+void Mpu6050::readAcceleroOffsets(int16_t offsets[3]){
+	uint8_t data[6];
+	readRegisters(XA_OFFS_H, data, 6);
+	for(int i = 0; i < 3; i++){
+		offsets[i] = concatenateBytes(data[2 * i], data[2 * i + 1]);
+	}
+}
+
+void Mpu6050::writeAcceleroOffsets(const int16_t offsets[3]){
+	uint8_t data[7] = {XA_OFFS_H};
+	for(int i = 0; i < 3; i++){
+		data[2 * i + 1] = static_cast<uint16_t>(offsets[i]) >> 8;
+		data[2 * i + 2] = offsets[i] & 0xFF;
+	}
+	busWrite(data, 7);
+}
+
+void Mpu6050::readGyroOffsets(int16_t offsets[3]){
+	uint8_t data[6];
+	readRegisters(XG_OFFS_USRH, data, 6);
+	for(int i = 0; i < 3; i++){
+		offsets[i] = concatenateBytes(data[2 * i], data[2 * i + 1]);
+	}
+}
+
+void Mpu6050::writeGyroOffsets(const int16_t offsets[3]){
+	uint8_t data[7] = {XG_OFFS_USRH};
+	for(int i = 0; i < 3; i++){
+		data[2 * i + 1] = static_cast<uint16_t>(offsets[i]) >> 8;
+		data[2 * i + 2] = offsets[i] & 0xFF;
+	}
+	busWrite(data, 7);
+}
+
+void Mpu6050::resyncConfig(){
+	uint8_t data[4];
+	readRegisters(SMPLRT_DIV, data, 4); // SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG are consecutive registers
+	rateDividerShadow = data[0];
+	configShadow = data[1];
+	gyroConfigShadow = data[2];
+	acceleroConfigShadow = data[3];
+}
@@ -7,6 +7,10 @@
 #define MPU6050_HPP
 
 #include "hwlib.hpp"
+#include "sampleBuffer.hpp"
+#include "sensorUnits.hpp"
+#include "mpu6050Config.hpp"
+#include "i2cRegisterBus.hpp"
 
 /// @file
 
@@ -21,19 +25,38 @@
 
 class Mpu6050 {
 private:
-  /// The i2c Bus Bit Banged SCL SDA object used
-  hwlib::i2c_bus_bit_banged_scl_sda &sensor;
+  /// The hwlib i2c bus used, when constructed with one, otherwise nullptr.
+  hwlib::i2c_bus *hwlibSensor;
+
+  /// The i2cRegisterBus used, when constructed with one, otherwise nullptr.
+  i2cRegisterBus *sensor;
   /// The MPU6050's Master Adress.
   ///
   /// 0x68 when the AD0 pin on the chip's board is low and 0x69 when said
   /// pin is high.
   const uint8_t sensorAddress;
 
+  // Offset Registers
+  //
+  // Not in the register map, but described in the MPU6050's offset register application note.
+  const uint8_t XA_OFFS_H =      0x06;
+  const uint8_t XG_OFFS_USRH =   0x13;
+
   // Configuration Registers
+  const uint8_t SMPLRT_DIV =     0x19;
   const uint8_t CONFIG =         0x1A;
   const uint8_t GYRO_CONFIG =    0x1B;
   const uint8_t ACCEL_CONFIG =   0x1C;
 
+  // Shadow copies of the configuration registers.
+  //
+  // Kept up to date by every set and read function for these registers, so converting a
+  // measurement doesn't need an extra register read. All four are 0 after the chip powers up.
+  uint8_t rateDividerShadow =    0;
+  uint8_t configShadow =         0;
+  uint8_t gyroConfigShadow =     0;
+  uint8_t acceleroConfigShadow = 0;
+
   // Accelerometer Registers
   const uint8_t ACCEL_XOUT_H =   0x3B;
   const uint8_t ACCEL_XOUT_L =   0x3C;
@@ -54,6 +77,42 @@ private:
 	const uint8_t GYRO_ZOUT_H =    0x47;
 	const uint8_t GYRO_ZOUT_L =    0x48;
 
+  // FIFO Registers
+  const uint8_t FIFO_EN =        0x23;
+  const uint8_t USER_CTRL =      0x6A;
+  const uint8_t FIFO_COUNTH =    0x72;
+  const uint8_t FIFO_COUNTL =    0x73;
+  const uint8_t FIFO_R_W =       0x74;
+
+  /// The size of the MPU6050's FIFO in bytes.
+  const uint16_t FIFO_SIZE =     1024;
+
+  /// The size of one FIFO frame in bytes: accelerometer, temperature and gyroscope, like readAll.
+  const uint8_t FIFO_FRAME_SIZE = 14;
+
+  /// The maximum amount of FIFO frames read in one transaction, which sets the size of readFifo's buffer on the stack.
+  static const size_t FIFO_BURST_FRAMES = 16;
+
+  // Interrupt Registers
+  const uint8_t INT_PIN_CFG =    0x37;
+  const uint8_t INT_ENABLE =     0x38;
+  const uint8_t INT_STATUS =     0x3A;
+
+  /// The amount of times readFifo found the FIFO overflowed.
+  uint32_t fifoOverflows = 0;
+
+  /// Fills a Mpu6050Sample from 14 bytes in register map order.
+  Mpu6050Sample decodeSample(const uint8_t data[14]);
+
+  /// Writes n bytes to the MPU6050 in one write transaction on whichever bus is used.
+  void busWrite(const uint8_t data[], size_t n);
+
+  /// Reads n bytes from the MPU6050 in one read transaction on whichever bus is used.
+  void busRead(uint8_t data[], size_t n);
+
+  /// Reads one byte from the MPU6050 in one read transaction on whichever bus is used.
+  uint8_t busReadByte();
+
   // Powermanagement Register
   const uint8_t PWR_MGMT_1 =     0x6B;
 
@@ -63,8 +122,15 @@ private:
 public:
   /// Constructor
   ///
-  /// Constructs an i2c object for the Mpu6050 using an i2c_bus_bit_banged_scl_sda bus and a 7-bit address, which defaults to 0x68.
-  Mpu6050(hwlib::i2c_bus_bit_banged_scl_sda &sensor, const uint8_t &sensorAdress = 0x68);
+  /// Constructs an i2c object for the Mpu6050 using any hwlib::i2c_bus, such as an i2c_bus_bit_banged_scl_sda,
+  /// and a 7-bit address, which defaults to 0x68.
+  Mpu6050(hwlib::i2c_bus &sensor, const uint8_t &sensorAdress = 0x68);
+
+  /// Constructor
+  ///
+  /// Constructs an i2c object for the Mpu6050 using an i2cRegisterBus, such as a DueTwiBus,
+  /// and a 7-bit address, which defaults to 0x68.
+  Mpu6050(i2cRegisterBus &sensor, const uint8_t &sensorAdress = 0x68);
 
   /// Selects register to write to.
   ///
@@ -88,6 +154,74 @@ public:
   /// Gets data from the register corresponding to the given address and returns a uint8_t.
   virtual uint8_t readRegister(const uint8_t &registerAdress);
 
+  /// Gets data from a range of consecutive registers.
+  ///
+  /// Selects the register corresponding to the given address once and reads n bytes in a single
+  /// read transaction, or in a single transfer when the i2cRegisterBus supports that. The MPU6050 increments
+  /// its register pointer after every byte, so data[i] contains the value of register registerAdress + i.
+  virtual void readRegisters(const uint8_t &registerAdress, uint8_t data[], size_t n);
+
+  /// Gets all accelerometer, temperature and gyroscope measurements at once.
+  ///
+  /// Reads the 14 registers from ACCEL_XOUT_H to GYRO_ZOUT_L using the readRegisters function,
+  /// so one complete sample costs two i2c transactions instead of one or two per byte.
+  /// All values in the returned Mpu6050Sample are raw.
+  virtual Mpu6050Sample readAll();
+
+  /// Starts buffering samples in the MPU6050's FIFO.
+  ///
+  /// Selects the accelerometer, temperature and gyroscope measurements in FIFO_EN, empties
+  /// the FIFO and enables it in USER_CTRL. From then on the chip adds a 14 byte frame to the FIFO
+  /// at the sample rate, even while nobody reads the bus. Keep in mind that the sample rate is 8kHz
+  /// when the dlpf is disabled (setConfig(0)), which fills the 1024 byte FIFO in about 9 ms.
+  virtual void enableFifo();
+
+  /// Stops buffering samples in the FIFO.
+  ///
+  /// Clears FIFO_EN and the FIFO enable bit in USER_CTRL.
+  virtual void disableFifo();
+
+  /// Empties the FIFO.
+  ///
+  /// Sets the FIFO_RESET bit in USER_CTRL, which throws away everything in the FIFO.
+  virtual void resetFifo();
+
+  /// Returns the amount of bytes in the FIFO.
+  ///
+  /// Reads FIFO_COUNTH and FIFO_COUNTL in one burst.
+  virtual uint16_t readFifoCount();
+
+  /// Moves complete frames from the FIFO into the given buffer.
+  ///
+  /// Reads FIFO_COUNT and then reads at most maxFrames frames, never more than fit in the buffer,
+  /// using one read transaction per 16 frames. Returns the amount of frames added to the buffer.
+  /// When the FIFO is found full, the chip has been overwriting old data and the frame boundaries
+  /// are lost, so the FIFO is emptied instead, nothing is added and the overflow is counted.
+  virtual size_t readFifo(Mpu6050SampleBuffer & buffer, size_t maxFrames = SIZE_MAX);
+
+  /// Returns the amount of times readFifo found the FIFO overflowed since construction.
+  ///
+  /// Each overflow means samples have been lost, so if this number rises readFifo should be called more often.
+  virtual uint32_t readFifoOverflows();
+
+  /// Makes the INT pin signal every new sample.
+  ///
+  /// Sets INT_PIN_CFG to an active high, push-pull pulse of 50us and sets DATA_RDY_EN in INT_ENABLE.
+  /// The pin then rises once per sample, every samplePeriod microseconds.
+  /// Attach the pin to a DataReadyMonitor to know when to read.
+  virtual void enableDataReadyInterrupt();
+
+  /// Stops the INT pin from signalling anything.
+  ///
+  /// Writes a 0 to INT_ENABLE.
+  virtual void disableDataReadyInterrupt();
+
+  /// Returns the INT_STATUS register, which is cleared by reading it.
+  ///
+  /// Bit 0 (DATA_RDY_INT) is set when a new sample has arrived since the last read, bit 4 (FIFO_OFLOW_INT)
+  /// when the FIFO has overflowed.
+  virtual uint8_t readInterruptStatus();
+
   /// Concatenates an int16_t from two given uint8_t's.
   ///
   /// Returns an int16_t which most significant byte consists of the given msb
@@ -169,37 +303,95 @@ public:
 
   /// Converts to cm/s^2
   ///
-  /// Converts raw Accelerometer data to cm/s^2 using the current ACCEL_CONFIG value.
+  /// Converts raw Accelerometer data to cm/s^2 using the shadow copy of the ACCEL_CONFIG value.
+  /// Doesn't use the i2c bus.
   virtual void convertAccelero(int16_t & value);
 
   /// Converts to degrees per second
   ///
-  /// Converts raw Gyroscope data to degrees per second using the current GYRO_CONFIG value.
+  /// Converts raw Gyroscope data to degrees per second using the shadow copy of the GYRO_CONFIG value.
+  /// Doesn't use the i2c bus.
   virtual void convertGyro(int16_t & value);
 
+  /// Converts a sample to mm/s^2, millidegrees per second and millidegrees Celsius.
+  ///
+  /// Uses the shadow copies of ACCEL_CONFIG and GYRO_CONFIG, and the fixed point conversions of sensorUnits
+  /// instead of the float ones convertAccelero and convertGyro use. Doesn't use the i2c bus.
+  virtual Mpu6050ScaledSample scale(const Mpu6050Sample & sample);
+
+  /// Gets all measurements at once, converted by scale.
+  virtual Mpu6050ScaledSample readAllScaled();
+
   /// Configures the ACCEL_CONFIG register.
   ///
   /// Writes a given value between 0 and 3 to the afs_sel portion of the ACCEL_CONFIG
   /// register. Defaults to writing 0 when given value is not applicable by being out of range.
+  /// The written value is remembered for convertAccelero.
   virtual void setAcceleroConfig(uint8_t afs_sel);
 
   /// Configures the GYRO_CONFIG register.
   ///
   /// Writes a given value between 0 and 3 to the fs_sel portion of the GYRO_CONFIG
   /// register. Defaults to writing 0 when given value is not applicable by being out of range.
+  /// The written value is remembered for convertGyro.
   virtual void setGyroConfig(uint8_t fs_sel);
 
   /// Configures the Digital Low Pass Filter register.
   ///
   /// Writes a given value between 0 and 3 to the dlpf portion of the CONFIG
   /// register. Defaults to writing 0 when given value is not applicable by
-  /// being out of range.
+  /// being out of range. The written value is remembered in the shadow copy of CONFIG.
   virtual void setConfig(uint8_t dlpf);
 
+  /// Configures output rate, filter and full scale ranges at once.
+  ///
+  /// Writes SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG, which are consecutive registers, in one burst.
+  /// Full scale ranges above 3 and DLPF settings above 6 are replaced by 0, like the set functions do.
+  /// Everything written is remembered for the conversion functions, samplePeriod and filterDelay.
+  virtual void configure(const Mpu6050Config & config);
+
+  /// Returns the configuration as last written or read, without using the i2c bus.
+  virtual Mpu6050Config getConfiguration();
+
+  /// Returns the time between two samples in microseconds, without using the i2c bus.
+  virtual uint32_t samplePeriod();
+
+  /// Returns the delay the DLPF adds to every measurement in microseconds, without using the i2c bus.
+  virtual uint32_t filterDelay();
+
+  /// Reads the accelerometer offset registers XA_OFFS, YA_OFFS and ZA_OFFS.
+  ///
+  /// Reads all six bytes in one burst. The values are in LSB of the +-16g range (2048 per g) and are added to every
+  /// measurement. They hold the chip's factory trim after power up. Bit 0 isn't part of the offset and has to be kept.
+  virtual void readAcceleroOffsets(int16_t offsets[3]);
+
+  /// Writes the accelerometer offset registers XA_OFFS, YA_OFFS and ZA_OFFS in one burst.
+  ///
+  /// The registers aren't kept when the chip loses power.
+  virtual void writeAcceleroOffsets(const int16_t offsets[3]);
+
+  /// Reads the gyroscope offset registers XG_OFFS_USR, YG_OFFS_USR and ZG_OFFS_USR.
+  ///
+  /// Reads all six bytes in one burst. The values are in LSB of the +-1000dps range (32.8 per dps) and are added
+  /// to every measurement. They are 0 after power up.
+  virtual void readGyroOffsets(int16_t offsets[3]);
+
+  /// Writes the gyroscope offset registers XG_OFFS_USR, YG_OFFS_USR and ZG_OFFS_USR in one burst.
+  ///
+  /// The registers aren't kept when the chip loses power.
+  virtual void writeGyroOffsets(const int16_t offsets[3]);
+
+  /// Reads SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG back from the chip.
+  ///
+  /// Reads all four registers in one burst and replaces the shadow copies used by the conversion functions.
+  /// Only needed when the configuration might have been changed by something other than this object,
+  /// for example after the chip has been reset.
+  virtual void resyncConfig();
+
   /// Returns the sensitivity of the Accelerometer.
   ///
   /// Reads the afs_sel bits out of the ACCEL_CONFIG register and calculates the
-  /// corresponding sensitivity of the Accelerometer.
+  /// corresponding sensitivity of the Accelerometer. Also updates the shadow copy of ACCEL_CONFIG.
   /// Useful to be able to divide by the current sensitivity while converting the raw
   /// Accelerometer data to more readable units.
   virtual int16_t readAcceleroConfig();
@@ -207,7 +399,7 @@ public:
   /// Returns the sensitivity of the Gyroscope.
   ///
   /// Reads the fs_sel bits out of the GYRO_CONFIG register and calculates the
-  /// corresponding sensitivity of the Gyroscope.
+  /// corresponding sensitivity of the Gyroscope. Also updates the shadow copy of GYRO_CONFIG.
   /// Useful to be able to divide by the current sensitivity while converting the raw
   /// Gyroscope data to more readable units.
   virtual float readGyroConfig();
@@ -215,6 +407,7 @@ public:
   /// Returns the dlpf_cfg value
   ///
   /// Reads the dlpf_cfg bits out of the CONFIG register and returns the value.
+  /// Also updates the shadow copy of CONFIG.
   /// Useful for checking in which mode the dlpf is.
   virtual uint8_t readConfig();
 };
@@ -0,0 +1,132 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "attitudeEstimator.hpp"
+#include <math.h>
+
+static const float RADIANS_TO_DEGREES = 57.2957795f;
+static const float DEGREES_TO_RADIANS = 0.0174532925f;
+
+AttitudeEstimator::AttitudeEstimator(float gyroSensitivity):
+  gyroSensitivity( gyroSensitivity ),
+  roll( 0.0f ),
+  pitch( 0.0f )
+{}
+
+void AttitudeEstimator::accelerometerAngles(const Mpu6050Sample & sample, float & accRoll, float & accPitch){
+  float ax = sample.accX;
+  float ay = sample.accY;
+  float az = sample.accZ;
+  accRoll = atan2f(ay, az) * RADIANS_TO_DEGREES;
+  accPitch = atan2f(-ax, sqrtf(ay * ay + az * az)) * RADIANS_TO_DEGREES;
+}
+
+void AttitudeEstimator::reset(const Mpu6050Sample & sample){
+  accelerometerAngles(sample, roll, pitch);
+}
+
+float AttitudeEstimator::getRoll() const {
+  return roll;
+}
+
+float AttitudeEstimator::getPitch() const {
+  return pitch;
+}
+
+ComplementaryFilter::ComplementaryFilter(float gyroSensitivity, uint32_t timeConstant):
+  AttitudeEstimator( gyroSensitivity ),
+  timeConstant( timeConstant )
+{}
+
+void ComplementaryFilter::update(const Mpu6050Sample & sample, uint32_t dt){
+  float seconds = dt * 0.000001f;
+  float accRoll, accPitch;
+  accelerometerAngles(sample, accRoll, accPitch);
+  float gyroRoll = roll + sample.gyroX / gyroSensitivity * seconds;
+  float gyroPitch = pitch + sample.gyroY / gyroSensitivity * seconds;
+  float alpha = timeConstant / (timeConstant + dt);
+  roll = alpha * gyroRoll + (1.0f - alpha) * accRoll;
+  pitch = alpha * gyroPitch + (1.0f - alpha) * accPitch;
+}
+
+MadgwickFilter::MadgwickFilter(float gyroSensitivity, float beta):
+  AttitudeEstimator( gyroSensitivity ),
+  beta( beta ),
+  q0( 1.0f ), q1( 0.0f ), q2( 0.0f ), q3( 0.0f )
+{}
+
+void MadgwickFilter::updateAngles(){
+  roll = atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * RADIANS_TO_DEGREES;
+  float sinPitch = 2.0f * (q0 * q2 - q3 * q1);
+  if(sinPitch > 1.0f){ sinPitch = 1.0f; }
+  if(sinPitch < -1.0f){ sinPitch = -1.0f; }
+  pitch = asinf(sinPitch) * RADIANS_TO_DEGREES;
+}
+
+void MadgwickFilter::reset(const Mpu6050Sample & sample){
+  AttitudeEstimator::reset(sample);
+  float halfRoll = roll * DEGREES_TO_RADIANS * 0.5f;
+  float halfPitch = pitch * DEGREES_TO_RADIANS * 0.5f;
+  float cr = cosf(halfRoll), sr = sinf(halfRoll);
+  float cp = cosf(halfPitch), sp = sinf(halfPitch);
+  q0 = cr * cp;
+  q1 = sr * cp;
+  q2 = cr * sp;
+  q3 = -sr * sp;
+}
+
+void MadgwickFilter::update(const Mpu6050Sample & sample, uint32_t dt){
+  float seconds = dt * 0.000001f;
+  float toRadians = DEGREES_TO_RADIANS / gyroSensitivity;
+  float gx = sample.gyroX * toRadians;
+  float gy = sample.gyroY * toRadians;
+  float gz = sample.gyroZ * toRadians;
+
+  // rate of change of the quaternion according to the gyroscope
+  float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+  float qDot1 = 0.5f * ( q0 * gx + q2 * gz - q3 * gy);
+  float qDot2 = 0.5f * ( q0 * gy - q1 * gz + q3 * gx);
+  float qDot3 = 0.5f * ( q0 * gz + q1 * gy - q2 * gx);
+
+  float ax = sample.accX;
+  float ay = sample.accY;
+  float az = sample.accZ;
+  float norm = ax * ax + ay * ay + az * az;
+  if(norm > 0.0f){ // in free fall there is no down to correct towards
+    float recipNorm = 1.0f / sqrtf(norm);
+    ax *= recipNorm;
+    ay *= recipNorm;
+    az *= recipNorm;
+
+    // gradient of the difference between the measured and the estimated down direction
+    float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+    float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+    float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+    float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+    float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+    float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+    float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+    float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+    float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+    if(sNorm > 0.0f){
+      recipNorm = 1.0f / sqrtf(sNorm);
+      qDot0 -= beta * s0 * recipNorm;
+      qDot1 -= beta * s1 * recipNorm;
+      qDot2 -= beta * s2 * recipNorm;
+      qDot3 -= beta * s3 * recipNorm;
+    }
+  }
+
+  q0 += qDot0 * seconds;
+  q1 += qDot1 * seconds;
+  q2 += qDot2 * seconds;
+  q3 += qDot3 * seconds;
+  float recipNorm = 1.0f / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+  q0 *= recipNorm;
+  q1 *= recipNorm;
+  q2 *= recipNorm;
+  q3 *= recipNorm;
+  updateAngles();
+}
@@ -0,0 +1,109 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ATTITUDEESTIMATOR_HPP
+#define ATTITUDEESTIMATOR_HPP
+
+#include "sampleBuffer.hpp"
+
+/// @file
+
+/// Estimates roll and pitch from the gyroscope and accelerometer measurements of a MPU6050.
+///
+/// The accelerometer alone knows which way is down, but is noisy and can't tell gravity from shaking.
+/// The gyroscope alone is smooth and ignores shaking, but drifts away over time. An AttitudeEstimator
+/// combines both. Subclasses decide how: ComplementaryFilter is cheap, MadgwickFilter is more accurate at
+/// large angles and costs more. All calculations use float only, never double, because the Arduino Due
+/// has no FPU and double precision would cost twice the soft-float time.
+///
+/// Angles are in degrees, using the axes of the MPU6050: roll is the rotation around the X-axis and pitch
+/// the rotation around the Y-axis, both 0 when the Z-axis points up.
+class AttitudeEstimator {
+protected:
+  /// The amount of raw gyroscope units per degree per second, 131 for fs_sel 0.
+  float gyroSensitivity;
+
+  /// The estimated roll in degrees.
+  float roll;
+
+  /// The estimated pitch in degrees.
+  float pitch;
+
+  /// Calculates roll and pitch from the accelerometer measurements only.
+  void accelerometerAngles(const Mpu6050Sample & sample, float & accRoll, float & accPitch);
+
+public:
+  /// Constructor
+  ///
+  /// Constructs an estimator for samples taken with the given gyroscope sensitivity, which is
+  /// what Mpu6050::readGyroConfig returns. The estimate starts at level.
+  AttitudeEstimator(float gyroSensitivity = 131.0f);
+
+  /// Processes a new sample.
+  ///
+  /// dt is the time in microseconds since the previous sample.
+  virtual void update(const Mpu6050Sample & sample, uint32_t dt) = 0;
+
+  /// Starts over from the given sample.
+  ///
+  /// Sets the estimate to the angles measured by the accelerometer, which avoids waiting for the
+  /// estimate to settle after starting.
+  virtual void reset(const Mpu6050Sample & sample);
+
+  /// Returns the estimated roll in degrees.
+  float getRoll() const;
+
+  /// Returns the estimated pitch in degrees.
+  float getPitch() const;
+};
+
+/// A complementary filter.
+///
+/// Integrates the gyroscope and slowly pulls the result towards the accelerometer angles. The time constant
+/// decides how slowly: shaking shorter than the time constant is mostly ignored, gyroscope drift slower
+/// than it is corrected. Takes two atan2f calls per update.
+class ComplementaryFilter : public AttitudeEstimator {
+private:
+  /// The time constant in microseconds.
+  float timeConstant;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a complementary filter with the given time constant in microseconds, which defaults to half a second.
+  ComplementaryFilter(float gyroSensitivity = 131.0f, uint32_t timeConstant = 500000);
+
+  void update(const Mpu6050Sample & sample, uint32_t dt) override;
+};
+
+/// A Madgwick filter for a 6 axis IMU.
+///
+/// Keeps the orientation as a quaternion, which is integrated using the gyroscope and corrected with a gradient
+/// descent step towards the accelerometer's down direction. Unlike the complementary filter it doesn't assume
+/// roll and pitch are independent, so it stays accurate when both are large. beta sets how strongly the accelerometer
+/// corrects the gyroscope, in radians per second.
+class MadgwickFilter : public AttitudeEstimator {
+private:
+  /// The gain of the accelerometer correction.
+  float beta;
+
+  /// The orientation quaternion.
+  float q0, q1, q2, q3;
+
+  /// Calculates roll and pitch from the quaternion.
+  void updateAngles();
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a Madgwick filter with the given gain, which defaults to 0.1.
+  MadgwickFilter(float gyroSensitivity = 131.0f, float beta = 0.1f);
+
+  void update(const Mpu6050Sample & sample, uint32_t dt) override;
+
+  void reset(const Mpu6050Sample & sample) override;
+};
+
+#endif
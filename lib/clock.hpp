@@ -0,0 +1,45 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include "hwlib.hpp"
+
+/// @file
+
+/// A source of time that can also be waited on.
+///
+/// Classes that wait take a Clock, which defaults to hwlibClock, instead of calling hwlib::wait_ms directly.
+/// On the Arduino Due that changes nothing, but a simulation can pass a clock that only moves when told to,
+/// so waiting costs no real time and everything that happens can be given an exact timestamp.
+class Clock {
+public:
+  /// Returns the current time in microseconds.
+  virtual uint_fast64_t now_us() = 0;
+
+  /// Waits n microseconds.
+  virtual void wait_us(uint_fast32_t n) = 0;
+};
+
+/// The Clock of hwlib, which is the real time of the target.
+class HwlibClock : public Clock {
+public:
+  uint_fast64_t now_us() override {
+    return hwlib::now_us();
+  }
+
+  void wait_us(uint_fast32_t n) override {
+    hwlib::wait_us(n);
+  }
+};
+
+/// Returns the one HwlibClock.
+inline Clock & hwlibClock(){
+  static HwlibClock clock;
+  return clock;
+}
+
+#endif
@@ -0,0 +1,39 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CYCLECOUNTER_HPP
+#define CYCLECOUNTER_HPP
+
+#include <stdint.h>
+
+/// @file
+
+/// Access to the cycle counter of the Cortex-M3 on the Arduino Due.
+///
+/// The DWT (Data Watchpoint and Trace) unit counts every clock cycle in its CYCCNT register,
+/// which at 84MHz wraps around after about 51 seconds. Reading it costs a single load, so it
+/// can time pieces of code down to the cycle without disturbing them.
+namespace cycleCounter {
+
+  /// Starts the cycle counter.
+  ///
+  /// Enables the trace unit in DEMCR and the counter in DWT_CTRL. Call once before using now.
+  inline void enable(){
+    volatile uint32_t & DEMCR =    *reinterpret_cast<volatile uint32_t *>(0xE000EDFC);
+    volatile uint32_t & DWT_CTRL = *reinterpret_cast<volatile uint32_t *>(0xE0001000);
+    DEMCR |= 1u << 24;   // TRCENA
+    DWT_CTRL |= 1u << 0; // CYCCNTENA
+  }
+
+  /// Returns the amount of clock cycles counted so far.
+  ///
+  /// Take the difference between two calls to get the cycles in between, which is correct
+  /// even when the counter wrapped around once.
+  inline uint32_t now(){
+    return *reinterpret_cast<volatile uint32_t *>(0xE0001004); // DWT_CYCCNT
+  }
+}
+
+#endif
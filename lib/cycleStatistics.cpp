@@ -0,0 +1,63 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "cycleStatistics.hpp"
+#include <algorithm>
+
+CycleStatistics::CycleStatistics(uint32_t storage[], size_t capacity):
+  storage( storage ),
+  capacity( capacity ),
+  count( 0 ),
+  total( 0 ),
+  sorted( true )
+{}
+
+bool CycleStatistics::add(uint32_t cycles){
+  if(count == capacity){
+    return false;
+  }
+  storage[count++] = cycles;
+  total += cycles;
+  sorted = false;
+  return true;
+}
+
+void CycleStatistics::clear(){
+  count = 0;
+  total = 0;
+  sorted = true;
+}
+
+size_t CycleStatistics::size() const {
+  return count;
+}
+
+uint32_t CycleStatistics::min(){
+  return percentile(0);
+}
+
+uint32_t CycleStatistics::max(){
+  return percentile(100);
+}
+
+uint32_t CycleStatistics::mean() const {
+  return count > 0 ? total / count : 0;
+}
+
+uint32_t CycleStatistics::percentile(uint8_t percent){
+  if(count == 0){
+    return 0;
+  }
+  if(!sorted){
+    std::sort(storage, storage + count);
+    sorted = true;
+  }
+  if(percent > 100){
+    percent = 100;
+  }
+  // the rank is percent / 100 * count rounded up, counting from 1
+  size_t rank = (static_cast<uint64_t>(percent) * count + 99) / 100;
+  return storage[rank > 0 ? rank - 1 : 0];
+}
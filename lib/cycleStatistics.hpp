@@ -0,0 +1,67 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef CYCLESTATISTICS_HPP
+#define CYCLESTATISTICS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @file
+
+/// Collects timings, for example in cycles from cycleCounter, and summarizes them.
+///
+/// Every timing is kept in memory supplied by the caller, so percentiles are exact instead of estimated.
+/// The average alone hides the occasional slow run that makes a control loop miss its deadline,
+/// which is what the maximum and the 99th percentile show.
+class CycleStatistics {
+private:
+  /// The memory the timings are stored in.
+  uint32_t *storage;
+
+  /// The amount of timings that fit in storage.
+  size_t capacity;
+
+  /// The amount of timings stored.
+  size_t count;
+
+  /// The sum of all timings.
+  uint64_t total;
+
+  /// Whether storage is sorted, which percentile needs.
+  bool sorted;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs an empty CycleStatistics that keeps at most capacity timings in the given array.
+  CycleStatistics(uint32_t storage[], size_t capacity);
+
+  /// Adds a timing. Returns false and ignores it when storage is full.
+  bool add(uint32_t cycles);
+
+  /// Forgets all timings.
+  void clear();
+
+  /// Returns the amount of timings.
+  size_t size() const;
+
+  /// Returns the shortest timing, or 0 when there are none.
+  uint32_t min();
+
+  /// Returns the longest timing, or 0 when there are none.
+  uint32_t max();
+
+  /// Returns the average timing, rounded down, or 0 when there are none.
+  uint32_t mean() const;
+
+  /// Returns the timing that percent percent of the timings are at most, or 0 when there are none.
+  ///
+  /// Uses the nearest rank: the smallest timing with at least percent percent of all timings at or below it.
+  /// Sorts the timings the first time it is called after an add.
+  uint32_t percentile(uint8_t percent);
+};
+
+#endif
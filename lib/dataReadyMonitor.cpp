@@ -0,0 +1,51 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dataReadyMonitor.hpp"
+
+DataReadyMonitor::DataReadyMonitor(InterruptPin & pin):
+  pin( pin ),
+  edges( 0 ),
+  lastEdge( 0 ),
+  taken( 0 ),
+  missed( 0 )
+{
+  pin.attach(onEdge, this);
+}
+
+DataReadyMonitor::~DataReadyMonitor(){
+  pin.detach();
+}
+
+void DataReadyMonitor::onEdge(void *context, uint_fast64_t timestamp){
+  DataReadyMonitor & self = *static_cast<DataReadyMonitor *>(context);
+  self.lastEdge = timestamp;
+  self.edges = self.edges + 1;
+}
+
+bool DataReadyMonitor::sampleReady() const {
+  return edges != taken;
+}
+
+bool DataReadyMonitor::takeSample(uint_fast64_t & timestamp){
+  // lastEdge takes two loads on the Cortex-M3, so read it again when an edge came in between
+  uint32_t e;
+  do{
+    e = edges;
+    timestamp = lastEdge;
+  }while(e != edges);
+
+  if(e == taken){
+    return false;
+  }
+  timestamp = pin.toMicroseconds(timestamp);
+  missed += e - taken - 1;
+  taken = e;
+  return true;
+}
+
+uint32_t DataReadyMonitor::readMissed() const {
+  return missed;
+}
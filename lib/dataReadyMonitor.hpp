@@ -0,0 +1,72 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DATAREADYMONITOR_HPP
+#define DATAREADYMONITOR_HPP
+
+#include "interruptPin.hpp"
+
+/// @file
+
+/// Keeps track of the data-ready signal of a sensor, such as the INT pin of an Mpu6050.
+///
+/// The interrupt only records the time of the edge and counts it, the bus is never touched from the interrupt.
+/// The main loop asks sampleReady whether there is a sample it hasn't taken yet and takes it with takeSample,
+/// which also gives the time the sample was ready. That way every sample is read exactly once, as soon
+/// as possible after it is ready, and the time between samples comes from the sensor instead of the loop:
+///
+///   uint_fast64_t timestamp;
+///   if(monitor.takeSample(timestamp)){
+///     auto sample = mpu.readAll();
+///     ...
+///   }
+///
+/// Samples that arrive while the previous one hasn't been taken are counted by readMissed.
+class DataReadyMonitor {
+private:
+  /// The pin the data-ready signal is connected to.
+  InterruptPin & pin;
+
+  /// The amount of edges seen, only written by the interrupt.
+  volatile uint32_t edges;
+
+  /// The time of the last edge, only written by the interrupt.
+  volatile uint_fast64_t lastEdge;
+
+  /// The amount of edges taken, only written by the main loop.
+  uint32_t taken;
+
+  /// The amount of samples skipped.
+  uint32_t missed;
+
+  /// Called by the pin on every edge.
+  static void onEdge(void *context, uint_fast64_t timestamp);
+
+public:
+  /// Constructor
+  ///
+  /// Attaches to the given pin. Edges before construction don't count.
+  DataReadyMonitor(InterruptPin & pin);
+
+  /// Destructor
+  ///
+  /// Detaches from the pin.
+  ~DataReadyMonitor();
+
+  /// Returns whether a sample is ready that hasn't been taken yet.
+  bool sampleReady() const;
+
+  /// Takes the newest sample when there is one.
+  ///
+  /// Returns false when no sample is ready. Otherwise sets timestamp to the time the newest sample was ready,
+  /// in microseconds as InterruptPin::toMicroseconds gives them, and counts any older samples that weren't taken
+  /// as missed.
+  bool takeSample(uint_fast64_t & timestamp);
+
+  /// Returns the amount of samples that were replaced by a newer one before they were taken.
+  uint32_t readMissed() const;
+};
+
+#endif
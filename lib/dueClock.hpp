@@ -0,0 +1,24 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DUECLOCK_HPP
+#define DUECLOCK_HPP
+
+#include <stdint.h>
+
+/// @file
+
+/// The clocks of the Arduino Due.
+///
+/// hwlib sets the SAM3X8E up to run from its PLL at 84MHz, and feeds the peripherals the same master clock.
+/// The Arduino core calls this VARIANT_MCK, but neither hwlib nor the CMSIS headers define it, so the
+/// drivers that derive their bus and baud rates from it take it from here.
+namespace dueClock {
+
+  /// The master clock in Hz, which the CPU and the peripherals run at.
+  const uint32_t MCK = 84000000;
+}
+
+#endif
@@ -0,0 +1,80 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dueFlashStore.hpp"
+#include "interruptLock.hpp"
+
+const size_t DueFlashStore::PAGE_SIZE;
+
+namespace {
+
+// the last page of the second bank, controlled by EFC1
+const uint32_t PAGE = IFLASH1_NB_OF_PAGES - 1;
+const uint32_t ADDRESS = IFLASH1_ADDR + PAGE * IFLASH1_PAGE_SIZE;
+
+// the command to erase the page and write the latch buffer to it
+const uint32_t ERASE_AND_WRITE_PAGE = 0x03;
+
+// the flash wait states the errata of the SAM3X requires while programming
+const uint32_t PROGRAM_WAIT_STATES = 6;
+
+}
+
+size_t DueFlashStore::capacity() const {
+  return PAGE_SIZE;
+}
+
+void DueFlashStore::read(uint8_t data[], size_t n){
+  const volatile uint8_t *flash = reinterpret_cast<const volatile uint8_t *>(ADDRESS);
+  for(size_t i = 0; i < n && i < PAGE_SIZE; i++){
+    data[i] = flash[i];
+  }
+}
+
+bool DueFlashStore::write(const uint8_t data[], size_t n){
+  if(n > PAGE_SIZE){
+    return false;
+  }
+  // The errata of the SAM3X require 6 wait states on both flash controllers while a page is programmed. Interrupts
+  // stay masked until the page is written and checked, so no handler runs with the changed wait states or fetches
+  // from the flash in between.
+  InterruptLock lock;
+  uint32_t modes[2] = {EFC0->EEFC_FMR, EFC1->EEFC_FMR};
+  EFC0->EEFC_FMR = (modes[0] & ~EEFC_FMR_FWS_Msk) | EEFC_FMR_FWS(PROGRAM_WAIT_STATES);
+  EFC1->EEFC_FMR = (modes[1] & ~EEFC_FMR_FWS_Msk) | EEFC_FMR_FWS(PROGRAM_WAIT_STATES);
+
+  // the latch buffer is filled by writing whole words to the page's addresses, erased bytes are 0xFF
+  volatile uint32_t *latch = reinterpret_cast<volatile uint32_t *>(ADDRESS);
+  for(size_t word = 0; word < PAGE_SIZE / 4; word++){
+    uint32_t value = 0xFFFFFFFF;
+    for(size_t b = 0; b < 4; b++){
+      size_t i = word * 4 + b;
+      if(i < n){
+        value = (value & ~(0xFFu << (8 * b))) | static_cast<uint32_t>(data[i]) << (8 * b);
+      }
+    }
+    latch[word] = value;
+  }
+
+  EFC1->EEFC_FCR = EEFC_FCR_FKEY(0x5A) | EEFC_FCR_FARG(PAGE) | EEFC_FCR_FCMD(ERASE_AND_WRITE_PAGE);
+  uint32_t status;
+  do{
+    status = EFC1->EEFC_FSR;
+  }while((status & EEFC_FSR_FRDY) == 0);
+  EFC0->EEFC_FMR = modes[0];
+  EFC1->EEFC_FMR = modes[1];
+  if(status & (EEFC_FSR_FCMDE | EEFC_FSR_FLOCKE)){
+    return false;
+  }
+
+  uint8_t check[PAGE_SIZE];
+  read(check, n);
+  for(size_t i = 0; i < n; i++){
+    if(check[i] != data[i]){
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,37 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DUEFLASHSTORE_HPP
+#define DUEFLASHSTORE_HPP
+
+#include "hwlib.hpp"
+#include "persistentStore.hpp"
+
+/// @file
+
+/// A PersistentStore in the last page of the flash of the Arduino Due.
+///
+/// The SAM3X8E has two flash banks of 256kB, each with its own controller, and the CPU can keep running from the first
+/// while the second is being written. The store is the last page (256 bytes) of the second bank, which stays free as
+/// long as the program is smaller than 511kB. Writing erases and programs the whole page, which takes a few
+/// milliseconds with interrupts masked, and a page survives about 10000 writes, so only write when something changed
+/// and never while the motors are running.
+///
+/// Uploading a new program erases the entire flash, the store included.
+///
+/// Only builds for the Arduino Due.
+class DueFlashStore final : public PersistentStore {
+public:
+  /// The amount of bytes in a page of flash, which is all the store holds.
+  static const size_t PAGE_SIZE = 256;
+
+  size_t capacity() const override;
+
+  void read(uint8_t data[], size_t n) override;
+
+  bool write(const uint8_t data[], size_t n) override;
+};
+
+#endif
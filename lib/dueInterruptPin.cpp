@@ -0,0 +1,97 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dueInterruptPin.hpp"
+#include "dueClock.hpp"
+#include "cycleCounter.hpp"
+
+const uint8_t DueInterruptPin::MAX_PINS;
+
+namespace {
+
+// What to call for an attached pin, found by the PIOx_Handlers.
+struct attachedPin {
+  Pio *port;
+  uint32_t mask;
+  InterruptPin::handler h;
+  void *context;
+};
+
+attachedPin attachedPins[DueInterruptPin::MAX_PINS] = {};
+
+Pio * const ports[4] = {PIOA, PIOB, PIOC, PIOD};
+const uint32_t portIds[4] = {ID_PIOA, ID_PIOB, ID_PIOC, ID_PIOD};
+const IRQn_Type portIrqs[4] = {PIOA_IRQn, PIOB_IRQn, PIOC_IRQn, PIOD_IRQn};
+
+void dispatch(Pio *port){
+  uint32_t timestamp = cycleCounter::now();
+  uint32_t status = port->PIO_ISR; // reading the status register acknowledges the interrupts
+  for(const attachedPin & a : attachedPins){
+    if(a.port == port && (status & a.mask) && a.h != nullptr){
+      a.h(a.context, timestamp);
+    }
+  }
+}
+
+}
+
+extern "C" void PIOA_Handler(){ dispatch(PIOA); }
+extern "C" void PIOB_Handler(){ dispatch(PIOB); }
+extern "C" void PIOC_Handler(){ dispatch(PIOC); }
+extern "C" void PIOD_Handler(){ dispatch(PIOD); }
+
+DueInterruptPin::DueInterruptPin(uint32_t port, uint32_t pin):
+  port( ports[port] ),
+  portId( portIds[port] ),
+  mask( 1u << pin )
+{
+  cycleCounter::enable();
+  PMC->PMC_PCER0 = 1 << portId;
+  this->port->PIO_PER = mask;
+  this->port->PIO_ODR = mask;
+  this->port->PIO_PUDR = mask;
+}
+
+void DueInterruptPin::attach(handler h, void *context){
+  detach();
+  attachedPin *slot = nullptr;
+  for(attachedPin & a : attachedPins){
+    if(a.port == nullptr){
+      slot = &a;
+      break;
+    }
+  }
+  if(slot == nullptr){
+    return;
+  }
+  // port last, it is what the handlers look for
+  slot->h = h;
+  slot->context = context;
+  slot->mask = mask;
+  slot->port = port;
+  // only rising edges
+  port->PIO_AIMER = mask;
+  port->PIO_ESR = mask;
+  port->PIO_REHLSR = mask;
+  port->PIO_ISR;
+  port->PIO_IER = mask;
+  IRQn_Type irq = portIrqs[portId - ID_PIOA];
+  NVIC_ClearPendingIRQ(irq);
+  NVIC_EnableIRQ(irq);
+}
+
+void DueInterruptPin::detach(){
+  port->PIO_IDR = mask;
+  for(attachedPin & a : attachedPins){
+    if(a.port == port && a.mask == mask){
+      a = attachedPin{};
+    }
+  }
+}
+
+uint_fast64_t DueInterruptPin::toMicroseconds(uint_fast64_t timestamp) const {
+  uint32_t age = cycleCounter::now() - static_cast<uint32_t>(timestamp);
+  return hwlib::now_us() - age / (dueClock::MCK / 1000000);
+}
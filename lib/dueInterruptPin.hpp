@@ -0,0 +1,51 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DUEINTERRUPTPIN_HPP
+#define DUEINTERRUPTPIN_HPP
+
+#include "hwlib.hpp"
+#include "interruptPin.hpp"
+
+/// @file
+
+/// An InterruptPin using a PIO controller of the Arduino Due.
+///
+/// The pin is given the same way as to hwlib::target::pin_in: a port (0 to 3 for PIOA to PIOD) and
+/// a pin number within that port. The timestamp passed to the handler is the cycle counter at the start of the
+/// interrupt: hwlib::now_us keeps state that an interrupt in the middle of a call from the main loop would corrupt.
+/// toMicroseconds turns it into hwlib::now_us time, for edges less than 51 seconds ago, when the counter wraps.
+///
+/// At most MAX_PINS pins can be attached at once. Only builds for the Arduino Due.
+class DueInterruptPin : public InterruptPin {
+public:
+  /// The maximum amount of pins attached at once.
+  static const uint8_t MAX_PINS = 4;
+
+private:
+  /// The PIO controller of the pin.
+  Pio *port;
+
+  /// The peripheral ID of the PIO controller.
+  uint32_t portId;
+
+  /// The bit of the pin in the PIO registers.
+  uint32_t mask;
+
+public:
+  /// Constructor
+  ///
+  /// Makes the given pin an input with its pull-up disabled. Edges are only seen after attach.
+  DueInterruptPin(uint32_t port, uint32_t pin);
+
+  /// Calls h on every rising edge. Does nothing when MAX_PINS pins are attached already.
+  void attach(handler h, void *context) override;
+
+  void detach() override;
+
+  uint_fast64_t toMicroseconds(uint_fast64_t timestamp) const override;
+};
+
+#endif
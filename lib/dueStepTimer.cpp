@@ -0,0 +1,42 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dueStepTimer.hpp"
+#include "dueClock.hpp"
+
+// The scheduler ticked by TC0_Handler, set by DueStepTimer::start.
+static StepScheduler * volatile activeScheduler = nullptr;
+
+extern "C" void TC0_Handler(){
+  TC0->TC_CHANNEL[0].TC_SR; // reading the status register acknowledges the interrupt
+  if(activeScheduler != nullptr){
+    activeScheduler->tick();
+  }
+}
+
+DueStepTimer::DueStepTimer(StepScheduler & scheduler, uint32_t tickPeriod):
+  scheduler( scheduler ),
+  tickPeriod( tickPeriod )
+{}
+
+void DueStepTimer::start(){
+  activeScheduler = &scheduler;
+  PMC->PMC_PCER0 = 1 << ID_TC0;
+  TcChannel & channel = TC0->TC_CHANNEL[0];
+  channel.TC_CCR = TC_CCR_CLKDIS;
+  channel.TC_CMR = TC_CMR_TCCLKS_TIMER_CLOCK1 | TC_CMR_WAVE | TC_CMR_WAVSEL_UP_RC; // MCK / 2, reset on RC
+  channel.TC_RC = dueClock::MCK / 2 / 1000000 * tickPeriod;
+  channel.TC_IER = TC_IER_CPCS;
+  NVIC_ClearPendingIRQ(TC0_IRQn);
+  NVIC_EnableIRQ(TC0_IRQn);
+  channel.TC_CCR = TC_CCR_CLKEN | TC_CCR_SWTRG;
+}
+
+void DueStepTimer::stop(){
+  TC0->TC_CHANNEL[0].TC_CCR = TC_CCR_CLKDIS;
+  TC0->TC_CHANNEL[0].TC_IDR = TC_IDR_CPCS;
+  NVIC_DisableIRQ(TC0_IRQn);
+  activeScheduler = nullptr;
+}
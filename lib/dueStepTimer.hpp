@@ -0,0 +1,42 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DUESTEPTIMER_HPP
+#define DUESTEPTIMER_HPP
+
+#include "hwlib.hpp"
+#include "stepScheduler.hpp"
+
+/// @file
+
+/// Calls StepScheduler::tick from a timer-counter interrupt of the Arduino Due.
+///
+/// Uses channel 0 of timer-counter TC0, clocked at MCK / 2, in waveform mode with an RC compare interrupt,
+/// so TC0_Handler runs exactly once every tick period regardless of what the main loop is doing. The tick
+/// period is converted to timer counts with dueClock::MCK, 42 counts per microsecond at 84MHz. There is
+/// only one TC0, so only one DueStepTimer can be running at a time.
+/// Only builds for the Arduino Due.
+class DueStepTimer {
+private:
+  /// The scheduler that is ticked.
+  StepScheduler &scheduler;
+
+  /// The time between two ticks in microseconds.
+  uint32_t tickPeriod;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a DueStepTimer that ticks the given scheduler every tickPeriod microseconds once started.
+  DueStepTimer(StepScheduler & scheduler, uint32_t tickPeriod = 100);
+
+  /// Starts the timer and enables its interrupt.
+  void start();
+
+  /// Stops the timer and disables its interrupt. The motors stop where they are.
+  void stop();
+};
+
+#endif
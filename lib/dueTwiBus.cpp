@@ -0,0 +1,175 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dueTwiBus.hpp"
+#include "dueClock.hpp"
+#include "interruptLock.hpp"
+
+DueTwiBus::DueTwiBus(uint32_t frequency, bool usePdc):
+  state( readState::idle ),
+  usePdc( usePdc ),
+  acked( true ),
+  readData( nullptr ),
+  readLength( 0 )
+{
+  // SDA is PB12 (TWD1) and SCL is PB13 (TWCK1), both peripheral A
+  PIOB->PIO_PDR = PIO_PB12A_TWD1 | PIO_PB13A_TWCK1;
+  PIOB->PIO_ABSR &= ~(PIO_PB12A_TWD1 | PIO_PB13A_TWCK1);
+  PMC->PMC_PCER0 = 1 << ID_TWI1;
+
+  TWI1->TWI_PTCR = TWI_PTCR_RXTDIS | TWI_PTCR_TXTDIS;
+  TWI1->TWI_CR = TWI_CR_SWRST;
+  TWI1->TWI_RHR;
+  TWI1->TWI_CR = TWI_CR_SVDIS | TWI_CR_MSEN;
+
+  // each half of the clock lasts (CLDIV * 2^CKDIV + 4) / MCK, CLDIV has to fit in 8 bits
+  uint32_t divider = dueClock::MCK / (2 * frequency) - 4;
+  uint32_t ckdiv = 0;
+  while(divider > 255 && ckdiv < 7){
+    divider >>= 1;
+    ckdiv++;
+  }
+  TWI1->TWI_CWGR = TWI_CWGR_CLDIV(divider) | TWI_CWGR_CHDIV(divider) | TWI_CWGR_CKDIV(ckdiv);
+}
+
+void DueTwiBus::write(uint8_t address, const uint8_t data[], size_t n){
+  TWI1->TWI_MMR = TWI_MMR_DADR(address);
+  TWI1->TWI_IADR = 0;
+  acked = true;
+  for(size_t i = 0; i < n; i++){
+    TWI1->TWI_THR = data[i];
+    // reading the status clears NACK, so it is read once per pass
+    uint32_t status;
+    do{
+      status = TWI1->TWI_SR;
+    }while((status & (TWI_SR_TXRDY | TWI_SR_NACK)) == 0);
+    if(status & TWI_SR_NACK){
+      // the chip didn't answer, the TWI has already sent a stop condition
+      acked = false;
+      break;
+    }
+  }
+  if(acked){
+    TWI1->TWI_CR = TWI_CR_STOP;
+  }
+  while((TWI1->TWI_SR & TWI_SR_TXCOMP) == 0){}
+}
+
+void DueTwiBus::read(uint8_t address, uint8_t data[], size_t n){
+  TWI1->TWI_MMR = TWI_MMR_DADR(address) | TWI_MMR_MREAD;
+  TWI1->TWI_IADR = 0;
+  beginRead(data, n);
+  while(!readDone()){}
+}
+
+void DueTwiBus::readRegisters(uint8_t address, uint8_t registerAddress, uint8_t data[], size_t n){
+  beginReadRegisters(address, registerAddress, data, n);
+  while(!readDone()){}
+}
+
+void DueTwiBus::beginReadRegisters(uint8_t address, uint8_t registerAddress, uint8_t data[], size_t n){
+  TWI1->TWI_MMR = TWI_MMR_DADR(address) | TWI_MMR_MREAD | TWI_MMR_IADRSZ_1_BYTE;
+  TWI1->TWI_IADR = registerAddress;
+  beginRead(data, n);
+}
+
+void DueTwiBus::beginRead(uint8_t data[], size_t n){
+  acked = true;
+  if(!usePdc || n <= 2){
+    readByCpu(data, n);
+    state = readState::idle;
+    return;
+  }
+  // the PDC receives all but the last two bytes, the CPU reads those to set the stop condition in time
+  readData = data;
+  readLength = n;
+  TWI1->TWI_RPR = reinterpret_cast<uintptr_t>(data);
+  TWI1->TWI_RCR = n - 2;
+  TWI1->TWI_PTCR = TWI_PTCR_RXTEN;
+  TWI1->TWI_CR = TWI_CR_START;
+  state = readState::pdc;
+}
+
+void DueTwiBus::readByCpu(uint8_t data[], size_t n){
+  if(n == 0){
+    return;
+  }
+  if(n == 1){
+    TWI1->TWI_CR = TWI_CR_START | TWI_CR_STOP;
+  }else{
+    TWI1->TWI_CR = TWI_CR_START;
+  }
+  for(size_t i = 0; i < n; i++){
+    uint32_t status;
+    do{
+      status = TWI1->TWI_SR;
+    }while((status & (TWI_SR_RXRDY | TWI_SR_NACK)) == 0);
+    if(status & TWI_SR_NACK){
+      acked = false;
+      break;
+    }
+    if(i + 2 == n){
+      readSecondToLast(data[i]);
+    }else{
+      data[i] = TWI1->TWI_RHR;
+    }
+  }
+  while((TWI1->TWI_SR & TWI_SR_TXCOMP) == 0){}
+}
+
+void DueTwiBus::readSecondToLast(uint8_t & data){
+  // Reading RHR lets the TWI start on the last byte, and the stop condition has to be set before that byte
+  // ends, or the TWI reads one more. Until RHR is read the TWI holds the clock, so only these two writes
+  // have a deadline, and an interrupt in between could make it miss.
+  InterruptLock lock;
+  data = TWI1->TWI_RHR;
+  TWI1->TWI_CR = TWI_CR_STOP;
+}
+
+bool DueTwiBus::readDone(){
+  uint32_t status = TWI1->TWI_SR;
+  switch(state){
+    case readState::pdc:
+      if(status & TWI_SR_NACK){
+        // the chip didn't answer, the TWI has already sent a stop condition
+        TWI1->TWI_PTCR = TWI_PTCR_RXTDIS;
+        acked = false;
+        state = readState::idle;
+        return true;
+      }
+      if((status & TWI_SR_ENDRX) == 0){
+        return false;
+      }
+      TWI1->TWI_PTCR = TWI_PTCR_RXTDIS;
+      state = readState::secondToLastByte;
+      return false;
+    case readState::secondToLastByte:
+      if((status & TWI_SR_RXRDY) == 0){
+        return false;
+      }
+      readSecondToLast(readData[readLength - 2]);
+      state = readState::lastByte;
+      return false;
+    case readState::lastByte:
+      if((status & TWI_SR_RXRDY) == 0){
+        return false;
+      }
+      readData[readLength - 1] = TWI1->TWI_RHR;
+      state = readState::complete;
+      return false;
+    case readState::complete:
+      if((status & TWI_SR_TXCOMP) == 0){
+        return false;
+      }
+      state = readState::idle;
+      return true;
+    default:
+      return true;
+  }
+}
+
+bool DueTwiBus::acknowledged() const {
+  return acked;
+}
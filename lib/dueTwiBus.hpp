@@ -0,0 +1,90 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DUETWIBUS_HPP
+#define DUETWIBUS_HPP
+
+#include "hwlib.hpp"
+#include "i2cRegisterBus.hpp"
+
+/// @file
+
+/// An i2cRegisterBus using the TWI1 peripheral of the Arduino Due.
+///
+/// TWI1 is connected to the SDA and SCL pins (20 and 21), the same pins hwlib's i2c_bus_bit_banged_scl_sda uses.
+/// The peripheral generates the bus signals itself, at up to 400kHz (fast mode), so the CPU doesn't have to.
+/// readRegisters uses the TWI's internal address feature, which writes the register address and reads the data
+/// in one transfer with a repeated start.
+///
+/// Reads longer than 2 bytes can be done by the PDC (the peripheral DMA controller) instead of the CPU. With
+/// beginReadRegisters and readDone the CPU can even do other work while the bytes come in:
+///
+///   bus.beginReadRegisters(0x68, 0x3B, data, 14);
+///   // ... something useful ...
+///   while(!bus.readDone()){}
+///
+/// The class is final, so code that knows it has a DueTwiBus, like a StaticMpu6050< DueTwiBus >, calls
+/// its functions directly instead of through the vtable.
+///
+/// Only builds for the Arduino Due.
+class DueTwiBus final : public i2cRegisterBus {
+private:
+  /// The steps of a read in the background.
+  enum class readState { idle, pdc, secondToLastByte, lastByte, complete };
+  readState state;
+
+  /// Whether reads longer than 2 bytes use the PDC.
+  bool usePdc;
+
+  /// Whether the chip acknowledged the last transfer.
+  bool acked;
+
+  /// The buffer and length of the read in the background.
+  uint8_t *readData;
+  size_t readLength;
+
+  /// Starts a read of n bytes, with the internal address set up by the caller.
+  void beginRead(uint8_t data[], size_t n);
+
+  /// Finishes a read done by the CPU.
+  void readByCpu(uint8_t data[], size_t n);
+
+  /// Reads the second to last byte of a read, which is in RHR, and sets the stop condition right after it.
+  void readSecondToLast(uint8_t & data);
+
+public:
+  /// Constructor
+  ///
+  /// Takes over the SDA and SCL pins and sets up TWI1 as master at the given frequency in Hz,
+  /// which defaults to 400kHz. usePdc selects whether longer reads use the PDC, which defaults to true.
+  DueTwiBus(uint32_t frequency = 400000, bool usePdc = true);
+
+  void write(uint8_t address, const uint8_t data[], size_t n) override;
+
+  void read(uint8_t address, uint8_t data[], size_t n) override;
+
+  void readRegisters(uint8_t address, uint8_t registerAddress, uint8_t data[], size_t n) override;
+
+  /// Starts reading n bytes starting at a register in the background.
+  ///
+  /// Returns immediately. data must stay alive and untouched until readDone returns true, and the bus must
+  /// not be used for anything else until then.
+  void beginReadRegisters(uint8_t address, uint8_t registerAddress, uint8_t data[], size_t n);
+
+  /// Returns whether the read started by beginReadRegisters is done.
+  ///
+  /// Has to be called until it returns true, because the CPU reads the last two bytes and sends the stop
+  /// condition. The TWI holds the bus while it waits for that, so calling it late only makes the read take
+  /// longer, it never reads a byte too many.
+  bool readDone();
+
+  /// Returns whether the chip acknowledged the last transfer.
+  ///
+  /// A chip that doesn't answer, because it is missing or busy, makes the transfer end at once. The functions
+  /// above return as usual then, with the data read left as it was, so check this when that matters.
+  bool acknowledged() const;
+};
+
+#endif
@@ -0,0 +1,38 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "dueUartTx.hpp"
+#include "dueClock.hpp"
+
+DueUartTx::DueUartTx(uint32_t baudrate){
+  // hwlib::cout may have left characters in the UART, which the reset below would cut off. When hwlib
+  // clocked the UART it also enabled the transmitter, so TXEMPTY comes up once they are sent.
+  if(PMC->PMC_PCSR0 & (1 << ID_UART)){
+    while((UART->UART_SR & UART_SR_TXEMPTY) == 0){}
+  }
+
+  // URXD is PA8 and UTXD is PA9, both peripheral A
+  PIOA->PIO_PDR = PIO_PA8A_URXD | PIO_PA9A_UTXD;
+  PIOA->PIO_ABSR &= ~(PIO_PA8A_URXD | PIO_PA9A_UTXD);
+  PMC->PMC_PCER0 = 1 << ID_UART;
+
+  UART->UART_PTCR = UART_PTCR_RXTDIS | UART_PTCR_TXTDIS;
+  UART->UART_CR = UART_CR_RSTRX | UART_CR_RSTTX | UART_CR_RXDIS | UART_CR_TXDIS;
+  UART->UART_MR = UART_MR_PAR_NO | UART_MR_CHMODE_NORMAL;
+  // rounded to the nearest divider
+  UART->UART_BRGR = (dueClock::MCK + 8 * baudrate) / (16 * baudrate);
+  UART->UART_CR = UART_CR_RXEN | UART_CR_TXEN;
+  UART->UART_PTCR = UART_PTCR_TXTEN;
+}
+
+bool DueUartTx::busy() const {
+  // ENDTX is set once the PDC has handed its last byte to the UART
+  return (UART->UART_SR & UART_SR_ENDTX) == 0;
+}
+
+void DueUartTx::send(const uint8_t data[], size_t n){
+  UART->UART_TPR = reinterpret_cast<uint32_t>(data);
+  UART->UART_TCR = n;
+}
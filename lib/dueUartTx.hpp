@@ -0,0 +1,44 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DUEUARTTX_HPP
+#define DUEUARTTX_HPP
+
+#include "hwlib.hpp"
+
+/// @file
+
+/// Sends blocks of bytes over the UART of the Arduino Due in the background, with the PDC.
+///
+/// The UART is the one behind the programming port, which the ATmega16U2 on the board turns into a USB serial port,
+/// the same one hwlib::cout writes to. send hands a block to the PDC and returns right away, so a Telemetry can
+/// stream from the control loop without waiting for the port.
+///
+/// The baud rate is MCK / (16 * divider), so not every rate is possible. The default, 400000, is 0.96% off and
+/// exactly what the 16U2 makes of it, and carries 40000 bytes per second, enough for a TELEMETRY_LOOP packet per
+/// sample at 1kHz. 115200 is 0.9% off. The PC has to open the port at the same rate.
+///
+/// hwlib sets up the UART at its own baud rate the first time it's used, so print something before constructing a
+/// DueUartTx, after which hwlib::cout uses the new rate as well. Bytes printed while a block is being sent end up in
+/// the middle of it, so wait until busy returns false before printing.
+///
+/// Only builds for the Arduino Due.
+class DueUartTx final {
+public:
+  /// Constructor
+  ///
+  /// Sets the UART to 8 data bits, no parity and the given baud rate, and enables both directions.
+  DueUartTx(uint32_t baudrate = 400000);
+
+  /// Returns whether the block given to send is still being handed to the UART.
+  bool busy() const;
+
+  /// Starts sending n bytes in the background.
+  ///
+  /// Returns immediately. data must stay alive and untouched until busy returns false.
+  void send(const uint8_t data[], size_t n);
+};
+
+#endif
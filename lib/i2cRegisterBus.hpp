@@ -0,0 +1,38 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef I2CREGISTERBUS_HPP
+#define I2CREGISTERBUS_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @file
+
+/// The i2c operations a register based chip like the MPU6050 needs.
+///
+/// hwlib's i2c_bus works with start conditions, single bytes and acknowledges, which suits a bit banged bus.
+/// An i2c peripheral like the TWI of the Arduino Due only does complete transfers and needs to know their
+/// length beforehand. This interface describes a bus in terms of complete transfers, so such a peripheral can be
+/// used as well. Mpu6050 accepts either a hwlib::i2c_bus or an i2cRegisterBus.
+class i2cRegisterBus {
+public:
+  /// Writes n bytes to the chip at the given address in one write transaction.
+  virtual void write(uint8_t address, const uint8_t data[], size_t n) = 0;
+
+  /// Reads n bytes from the chip at the given address in one read transaction.
+  virtual void read(uint8_t address, uint8_t data[], size_t n) = 0;
+
+  /// Reads n bytes starting at a register of the chip at the given address.
+  ///
+  /// Writes the register address and reads n bytes. A bus that can do both in one transfer
+  /// (with a repeated start) can override this.
+  virtual void readRegisters(uint8_t address, uint8_t registerAddress, uint8_t data[], size_t n){
+    write(address, &registerAddress, 1);
+    read(address, data, n);
+  }
+};
+
+#endif
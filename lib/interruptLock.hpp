@@ -0,0 +1,51 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef INTERRUPTLOCK_HPP
+#define INTERRUPTLOCK_HPP
+
+#include "hwlib.hpp"
+
+/// @file
+
+/// Masks interrupts for as long as it exists.
+///
+/// For the few instructions that have to happen without an interrupt in between, like a check and a write
+/// to something an interrupt handler writes as well, or two register writes that have to follow each other
+/// within a deadline:
+///
+///   {
+///     InterruptLock lock;
+///     ...
+///   }
+///
+/// Restores the previous mask instead of enabling interrupts, so locks can be nested and used in interrupt
+/// handlers. Keep what happens inside short, every interrupt waits for it. On the native target there are
+/// no interrupts, so it does nothing there.
+class InterruptLock {
+#ifdef BMPTK_TARGET_arduino_due
+private:
+  uint32_t primask;
+
+public:
+  InterruptLock():
+    primask( __get_PRIMASK() )
+  {
+    __disable_irq();
+  }
+
+  ~InterruptLock(){
+    __set_PRIMASK(primask);
+  }
+#else
+public:
+  InterruptLock(){}
+#endif
+
+  InterruptLock(const InterruptLock &) = delete;
+  InterruptLock & operator=(const InterruptLock &) = delete;
+};
+
+#endif
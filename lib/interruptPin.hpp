@@ -0,0 +1,39 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef INTERRUPTPIN_HPP
+#define INTERRUPTPIN_HPP
+
+#include <stdint.h>
+
+/// @file
+
+/// A pin that calls a function on every rising edge.
+///
+/// The function is called from an interrupt, together with the time of the edge. Reading the microsecond clock
+/// isn't always safe in an interrupt, so that time may be a raw count of the pin's own clock: convert it with
+/// toMicroseconds outside the interrupt. DueInterruptPin uses the PIO controllers of the Arduino Due, tests can use a pin that fires when told to.
+class InterruptPin {
+public:
+  /// The type of the function called on every rising edge.
+  ///
+  /// context is the pointer given to attach, timestamp is the time of the edge in the pin's own clock.
+  typedef void (*handler)(void *context, uint_fast64_t timestamp);
+
+  /// Calls h with context on every rising edge from now on, replacing any earlier handler.
+  virtual void attach(handler h, void *context) = 0;
+
+  /// Stops calling the handler.
+  virtual void detach() = 0;
+
+  /// Converts a timestamp given to the handler to microseconds, in the timebase of hwlib::now_us.
+  ///
+  /// Only call it outside the interrupt, and soon after the edge. By default the timestamp is in microseconds already.
+  virtual uint_fast64_t toMicroseconds(uint_fast64_t timestamp) const {
+    return timestamp;
+  }
+};
+
+#endif
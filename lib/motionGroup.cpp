@@ -0,0 +1,119 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "motionGroup.hpp"
+
+const uint8_t MotionGroup::MAX_MOTORS;
+
+MotionGroup::MotionGroup(uint32_t tickInterval, Clock & clock):
+  motorCount( 0 ),
+  ticks( 0 ),
+  ticksDone( 0 ),
+  tickInterval( tickInterval ),
+  lastTick( 0 ),
+  ticked( false ),
+  clock( clock )
+{}
+
+uint8_t MotionGroup::addMotor(steppermotor & motor){
+  if(motorCount == MAX_MOTORS){
+    return MAX_MOTORS;
+  }
+  axes[motorCount] = axis{&motor, 0, 0, 1, 0};
+  return motorCount++;
+}
+
+uint8_t MotionGroup::size() const {
+  return motorCount;
+}
+
+void MotionGroup::move(const int32_t steps[]){
+  ticks = 0;
+  ticksDone = 0;
+  for(uint8_t i = 0; i < motorCount; i++){
+    axes[i].direction = steps[i] < 0 ? -1 : 1;
+    axes[i].steps = steps[i] < 0 ? -steps[i] : steps[i];
+    if(axes[i].steps > ticks){
+      ticks = axes[i].steps;
+    }
+  }
+  // starting halfway centres the steps of the shorter axes between the ticks
+  for(uint8_t i = 0; i < motorCount; i++){
+    axes[i].error = ticks / 2;
+  }
+}
+
+void MotionGroup::moveTo(const int32_t targets[]){
+  int32_t steps[MAX_MOTORS];
+  for(uint8_t i = 0; i < motorCount; i++){
+    steps[i] = targets[i] - axes[i].position;
+  }
+  move(steps);
+}
+
+void MotionGroup::stop(){
+  ticks = ticksDone;
+}
+
+bool MotionGroup::isMoving() const {
+  return ticksDone < ticks;
+}
+
+int32_t MotionGroup::getPosition(uint8_t motor) const {
+  return axes[motor].position;
+}
+
+uint_fast64_t MotionGroup::moveDuration() const {
+  return static_cast<uint_fast64_t>(ticks) * tickInterval;
+}
+
+void MotionGroup::tick(){
+  for(uint8_t i = 0; i < motorCount; i++){
+    axis & a = axes[i];
+    a.error += a.steps;
+    if(a.error >= ticks){
+      a.error -= ticks;
+      if(a.direction > 0){
+        a.motor->stepClockwise();
+      }else{
+        a.motor->stepCounterClockwise();
+      }
+      a.position += a.direction;
+    }
+  }
+  ticksDone++;
+}
+
+void MotionGroup::update(uint_fast64_t now){
+  for(uint8_t i = 0; i < motorCount; i++){
+    axes[i].motor->update(now);
+  }
+}
+
+bool MotionGroup::poll(uint_fast64_t now){
+  if(!isMoving() || (ticked && now - lastTick < tickInterval)){
+    update(now);
+    return false;
+  }
+  tick();
+  lastTick = now;
+  ticked = true;
+  update(now);
+  return true;
+}
+
+void MotionGroup::run(){
+  while(isMoving()){
+    auto now = clock.now_us();
+    if(ticked && now - lastTick < tickInterval){
+      clock.wait_us(tickInterval - (now - lastTick));
+      now = clock.now_us();
+    }
+    tick();
+    lastTick = now;
+    ticked = true;
+    update(now);
+  }
+}
@@ -0,0 +1,135 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOTIONGROUP_HPP
+#define MOTIONGROUP_HPP
+
+#include "steppermotor.hpp"
+#include "clock.hpp"
+
+/// @file
+
+/// Moves several steppermotors together, so that they start and finish a move at the same time.
+///
+/// Turning one motor and then the other takes the sum of both times. A MotionGroup plans one move for all its
+/// motors instead: the motor with the most steps to take steps on every tick, and the others are spread evenly
+/// over those ticks with Bresenham's line algorithm. A move therefore takes as long as its longest axis alone,
+/// and a tilt around both axes is corrected in a straight line instead of an L.
+///
+/// Like StepperEngine, poll never waits and takes at most one tick when it's due, so it can share a loop:
+///
+///   auto group = MotionGroup();
+///   group.addMotor(motor0);
+///   group.addMotor(motor1);
+///   const int32_t steps[] = {400, -150};
+///   group.move(steps);
+///   while(group.isMoving()){
+///     group.poll(hwlib::now_us());
+///   }
+///
+/// run does the same, waiting on the group's Clock between ticks.
+class MotionGroup {
+public:
+  /// The maximum amount of motors in a group.
+  static const uint8_t MAX_MOTORS = 4;
+
+private:
+  /// What the group knows about one motor.
+  struct axis {
+    steppermotor *motor;
+
+    /// The position of the motor in steps, clockwise being positive.
+    int32_t position;
+
+    /// The amount of steps this axis takes in the current move.
+    int32_t steps;
+
+    /// 1 for clockwise and -1 for counterclockwise.
+    int8_t direction;
+
+    /// Bresenham's error term, the axis steps when it reaches the amount of ticks of the move.
+    int32_t error;
+  };
+
+  /// The motors, of which the first motorCount are in use.
+  axis axes[MAX_MOTORS];
+
+  /// The amount of motors added.
+  uint8_t motorCount;
+
+  /// The amount of ticks of the current move, which is the amount of steps of its longest axis.
+  int32_t ticks;
+
+  /// The amount of ticks taken of the current move.
+  int32_t ticksDone;
+
+  /// The time in microseconds between two ticks.
+  uint32_t tickInterval;
+
+  /// The time of the last tick in microseconds.
+  uint_fast64_t lastTick;
+
+  /// Whether a tick has been taken since the group was constructed.
+  bool ticked;
+
+  /// The clock run waits on.
+  Clock &clock;
+
+  /// Steps every axis whose step falls on the next tick.
+  void tick();
+
+  /// Lets every motor apply its idle policy.
+  void update(uint_fast64_t now);
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a MotionGroup without motors. On every tick, tickInterval microseconds apart, the longest axis takes
+  /// one step. It defaults to 1000, the fastest a 28BYJ-48 reliably follows. run waits on the given clock,
+  /// which defaults to the real time of hwlib.
+  MotionGroup(uint32_t tickInterval = 1000, Clock & clock = hwlibClock());
+
+  /// Adds a motor to the group and returns its number, the index in the arrays given to move and moveTo.
+  ///
+  /// The motor is assumed to be at position 0. Returns MAX_MOTORS when the group is full.
+  /// Only add motors while the group stands still.
+  uint8_t addMotor(steppermotor & motor);
+
+  /// Returns the amount of motors in the group.
+  uint8_t size() const;
+
+  /// Starts a move of the given amount of steps for every motor, clockwise being positive.
+  ///
+  /// steps holds one value for every motor, in the order they were added. A move still going on is abandoned
+  /// where it is, so the new steps count from the current positions.
+  void move(const int32_t steps[]);
+
+  /// Starts a move to the given positions, one for every motor.
+  void moveTo(const int32_t targets[]);
+
+  /// Stops the current move where it is.
+  void stop();
+
+  /// Returns whether the current move has ticks left.
+  bool isMoving() const;
+
+  /// Returns the position of a motor in steps.
+  int32_t getPosition(uint8_t motor) const;
+
+  /// Returns the time in microseconds the current move takes from its start.
+  uint_fast64_t moveDuration() const;
+
+  /// Takes the next tick of the current move if it's due.
+  ///
+  /// A tick is due tickInterval microseconds after the previous one. now is the current time in microseconds,
+  /// normally hwlib::now_us(). Also lets the motors apply their idle policies.
+  /// Returns whether a tick was taken. Never waits.
+  bool poll(uint_fast64_t now);
+
+  /// Finishes the current move, waiting on the clock between ticks.
+  void run();
+};
+
+#endif
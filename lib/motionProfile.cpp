@@ -0,0 +1,63 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "motionProfile.hpp"
+
+const uint16_t MotionProfile::MAX_RAMP_STEPS;
+
+MotionProfile::MotionProfile(uint32_t maxSpeed, uint32_t acceleration, uint32_t jerk, uint32_t startSpeed):
+  intervals{},
+  rampSteps( 0 )
+{
+  if(startSpeed < 16){
+    startSpeed = 16; // slower would not fit the uint16_t intervals
+  }
+  if(maxSpeed < startSpeed){
+    maxSpeed = startSpeed;
+  }
+  if(acceleration == 0){
+    acceleration = 1;
+  }
+
+  // Simulate the ramp in small time steps and write down when every step is reached.
+  const float dt = 0.00005f;
+  const float maxAcc = acceleration;
+  const float minAcc = jerk * dt; // keeps the S-curve from never quite reaching maxSpeed
+  float speed = startSpeed;
+  float acc = (jerk == 0) ? maxAcc : 0.0f;
+  float position = 0.0f;
+  float time = 0.0f;
+  float lastStepTime = 0.0f;
+
+  while(rampSteps < MAX_RAMP_STEPS - 1 && speed < maxSpeed){
+    if(jerk != 0){
+      if(maxSpeed - speed <= acc * acc / (2.0f * jerk)){
+        acc -= jerk * dt; // ease into maxSpeed
+        if(acc < minAcc){ acc = minAcc; }
+      }else{
+        acc += jerk * dt;
+        if(acc > maxAcc){ acc = maxAcc; }
+      }
+    }
+    speed += acc * dt;
+    if(speed > maxSpeed){
+      speed = maxSpeed;
+    }
+    position += speed * dt;
+    time += dt;
+    while(position >= rampSteps + 1 && rampSteps < MAX_RAMP_STEPS - 1){
+      float stepTime = time - (position - (rampSteps + 1)) / speed;
+      intervals[rampSteps] = (stepTime - lastStepTime) * 1000000.0f;
+      lastStepTime = stepTime;
+      rampSteps++;
+    }
+  }
+  intervals[rampSteps] = 1000000.0f / speed;
+  rampSteps++;
+}
+
+uint16_t MotionProfile::getRampSteps() const {
+  return rampSteps;
+}
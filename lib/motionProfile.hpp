@@ -0,0 +1,63 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOTIONPROFILE_HPP
+#define MOTIONPROFILE_HPP
+
+#include <stdint.h>
+
+/// @file
+
+/// A precomputed acceleration ramp for a steppermotor.
+///
+/// A steppermotor can't start at full speed: a 28BYJ-48 stalls when its first steps come faster than
+/// its pull-in rate. A MotionProfile describes how to get from a safe start speed up to the maximum speed,
+/// either with constant acceleration (trapezoidal profile) or with limited jerk (S-curve profile).
+/// The whole ramp is calculated once, in the constructor, and stored as a table of step intervals in
+/// microseconds, so using it (which happens in StepperEngine::poll) only takes integer operations.
+/// Braking uses the same table backwards.
+///
+/// Speeds are in steps per second, acceleration in steps per second^2 and jerk in steps per second^3.
+/// With the default 4096 steps per rotation of a stepper28BYJ48, 1000 steps per second is about 15 rpm.
+class MotionProfile {
+public:
+  /// The maximum amount of steps in a ramp.
+  ///
+  /// Ramps that would take longer end at the speed reached after this many steps.
+  static const uint16_t MAX_RAMP_STEPS = 256;
+
+private:
+  /// intervals[i] is the time in microseconds between step i and step i + 1 of the ramp.
+  uint16_t intervals[MAX_RAMP_STEPS];
+
+  /// The amount of used entries in intervals.
+  uint16_t rampSteps;
+
+public:
+  /// Constructor
+  ///
+  /// Calculates the ramp from startSpeed up to maxSpeed with the given acceleration. When jerk is 0
+  /// the acceleration is applied at once, which gives a trapezoidal profile. Otherwise the acceleration
+  /// builds up and dies down at the given jerk, which gives an S-curve profile. startSpeed is the speed at
+  /// which the motor can start and stop without a ramp and is raised to at least 16 steps per second.
+  MotionProfile(uint32_t maxSpeed, uint32_t acceleration, uint32_t jerk = 0, uint32_t startSpeed = 500);
+
+  /// Returns the amount of steps in the ramp.
+  ///
+  /// The interval of the last step in the ramp is the one at the maximum speed.
+  uint16_t getRampSteps() const;
+
+  /// Returns the time in microseconds between ramp step i and ramp step i + 1.
+  ///
+  /// Returns the interval at the maximum speed for every i past the end of the ramp.
+  uint16_t getInterval(uint16_t i) const {
+    if(i >= rampSteps){
+      return intervals[rampSteps - 1];
+    }
+    return intervals[i];
+  }
+};
+
+#endif
@@ -0,0 +1,165 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "mpu6050Calibrator.hpp"
+#include "sensorUnits.hpp"
+
+const size_t Mpu6050Calibrator::RECORD_SIZE;
+
+namespace {
+
+const uint8_t MAGIC[4] = {'M', 'C', 'A', 'L'};
+
+// Divides and rounds to the nearest integer, halves away from zero.
+int32_t roundedDivide(int32_t value, int32_t divisor){
+  return (value < 0 ? value - divisor / 2 : value + divisor / 2) / divisor;
+}
+
+int16_t clip(int32_t value){
+  return value > 32767 ? 32767 : (value < -32768 ? -32768 : value);
+}
+
+}
+
+Mpu6050Calibrator::Mpu6050Calibrator(Mpu6050 & mpu, Clock & clock):
+  mpu( mpu ),
+  clock( clock ),
+  applied{0, 0, 0, 0, 0, 0},
+  factoryAccelOffsets{0, 0, 0},
+  factoryKnown( false )
+{}
+
+bool Mpu6050Calibrator::measure(Mpu6050Offsets & offsets, uint16_t samples, upAxis up, uint16_t maxGyroSpread, uint32_t interval){
+  if(samples == 0){
+    return false;
+  }
+  int16_t accelSensitivity = mpu.readAcceleroConfig();
+  uint8_t afs_sel = 0;
+  while(afs_sel < 3 && (16384 >> afs_sel) > accelSensitivity){
+    afs_sel++;
+  }
+  float gyroSensitivity = mpu.readGyroConfig();
+  uint8_t fs_sel = 0;
+  while(fs_sel < 3 && sensorUnits::GYRO_SENSITIVITIES[fs_sel] > gyroSensitivity + 0.1f){
+    fs_sel++;
+  }
+
+  // 65535 samples of at most 32768 still fit
+  int32_t sums[6] = {0, 0, 0, 0, 0, 0};
+  int16_t lowest[3] = {32767, 32767, 32767};
+  int16_t highest[3] = {-32768, -32768, -32768};
+  for(uint16_t n = 0; n < samples; n++){
+    clock.wait_us(interval);
+    Mpu6050Sample s = mpu.readAll();
+    const int16_t values[6] = {s.accX, s.accY, s.accZ, s.gyroX, s.gyroY, s.gyroZ};
+    for(int i = 0; i < 6; i++){
+      sums[i] += values[i];
+    }
+    for(int i = 0; i < 3; i++){
+      lowest[i] = values[3 + i] < lowest[i] ? values[3 + i] : lowest[i];
+      highest[i] = values[3 + i] > highest[i] ? values[3 + i] : highest[i];
+    }
+  }
+  for(int i = 0; i < 3; i++){
+    if(highest[i] - lowest[i] > maxGyroSpread){
+      return false;
+    }
+  }
+
+  int32_t means[6];
+  for(int i = 0; i < 6; i++){
+    means[i] = roundedDivide(sums[i], samples);
+  }
+  uint8_t axis = static_cast<uint8_t>(up) / 2;
+  means[axis] -= (static_cast<uint8_t>(up) % 2 == 0) ? accelSensitivity : -accelSensitivity;
+
+  // what the chip measures now is on top of what apply already corrects
+  offsets.accX = clip(applied.accX + means[0] * (1 << afs_sel));
+  offsets.accY = clip(applied.accY + means[1] * (1 << afs_sel));
+  offsets.accZ = clip(applied.accZ + means[2] * (1 << afs_sel));
+  offsets.gyroX = clip(applied.gyroX + means[3] * (1 << fs_sel));
+  offsets.gyroY = clip(applied.gyroY + means[4] * (1 << fs_sel));
+  offsets.gyroZ = clip(applied.gyroZ + means[5] * (1 << fs_sel));
+  return true;
+}
+
+void Mpu6050Calibrator::apply(const Mpu6050Offsets & offsets){
+  if(!factoryKnown){
+    mpu.readAcceleroOffsets(factoryAccelOffsets);
+    factoryKnown = true;
+  }
+  // the accelerometer registers count 2048 per g, 8 times coarser than the offsets, but bit 0 isn't theirs,
+  // so they can only change in steps of 2
+  const int16_t accel[3] = {offsets.accX, offsets.accY, offsets.accZ};
+  int16_t accelRegisters[3];
+  for(int i = 0; i < 3; i++){
+    int32_t value = factoryAccelOffsets[i] - 2 * roundedDivide(accel[i], 16);
+    accelRegisters[i] = (clip(value) & ~1) | (factoryAccelOffsets[i] & 1);
+  }
+  // the gyroscope registers count 32.8 per dps, 4 times coarser than the offsets
+  const int16_t gyroRegisters[3] = {
+    clip(-roundedDivide(offsets.gyroX, 4)), clip(-roundedDivide(offsets.gyroY, 4)), clip(-roundedDivide(offsets.gyroZ, 4))
+  };
+  mpu.writeAcceleroOffsets(accelRegisters);
+  mpu.writeGyroOffsets(gyroRegisters);
+  applied = offsets;
+}
+
+Mpu6050Sample Mpu6050Calibrator::remove(const Mpu6050Sample & sample, const Mpu6050Offsets & offsets, uint8_t afs_sel, uint8_t fs_sel){
+  int32_t accelDivisor = 1 << (afs_sel & 0x03);
+  int32_t gyroDivisor = 1 << (fs_sel & 0x03);
+  Mpu6050Sample corrected = sample;
+  corrected.accX = clip(sample.accX - roundedDivide(offsets.accX, accelDivisor));
+  corrected.accY = clip(sample.accY - roundedDivide(offsets.accY, accelDivisor));
+  corrected.accZ = clip(sample.accZ - roundedDivide(offsets.accZ, accelDivisor));
+  corrected.gyroX = clip(sample.gyroX - roundedDivide(offsets.gyroX, gyroDivisor));
+  corrected.gyroY = clip(sample.gyroY - roundedDivide(offsets.gyroY, gyroDivisor));
+  corrected.gyroZ = clip(sample.gyroZ - roundedDivide(offsets.gyroZ, gyroDivisor));
+  return corrected;
+}
+
+bool Mpu6050Calibrator::save(PersistentStore & store, const Mpu6050Offsets & offsets){
+  if(store.capacity() < RECORD_SIZE){
+    return false;
+  }
+  const int16_t values[6] = {offsets.accX, offsets.accY, offsets.accZ, offsets.gyroX, offsets.gyroY, offsets.gyroZ};
+  uint8_t record[RECORD_SIZE];
+  for(int i = 0; i < 4; i++){
+    record[i] = MAGIC[i];
+  }
+  for(int i = 0; i < 6; i++){
+    record[4 + 2 * i] = values[i] & 0xFF;
+    record[5 + 2 * i] = static_cast<uint16_t>(values[i]) >> 8;
+  }
+  uint16_t sum = 0;
+  for(size_t i = 0; i < RECORD_SIZE - 2; i++){
+    sum += record[i];
+  }
+  record[RECORD_SIZE - 2] = sum & 0xFF;
+  record[RECORD_SIZE - 1] = sum >> 8;
+  return store.write(record, RECORD_SIZE);
+}
+
+bool Mpu6050Calibrator::load(PersistentStore & store, Mpu6050Offsets & offsets){
+  if(store.capacity() < RECORD_SIZE){
+    return false;
+  }
+  uint8_t record[RECORD_SIZE];
+  store.read(record, RECORD_SIZE);
+  uint16_t sum = 0;
+  for(size_t i = 0; i < RECORD_SIZE - 2; i++){
+    sum += record[i];
+  }
+  if(record[0] != MAGIC[0] || record[1] != MAGIC[1] || record[2] != MAGIC[2] || record[3] != MAGIC[3]
+    || sum != (record[RECORD_SIZE - 2] | record[RECORD_SIZE - 1] << 8)){
+    return false;
+  }
+  int16_t values[6];
+  for(int i = 0; i < 6; i++){
+    values[i] = static_cast<int16_t>(record[4 + 2 * i] | record[5 + 2 * i] << 8);
+  }
+  offsets = Mpu6050Offsets{values[0], values[1], values[2], values[3], values[4], values[5]};
+  return true;
+}
@@ -0,0 +1,102 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MPU6050CALIBRATOR_HPP
+#define MPU6050CALIBRATOR_HPP
+
+#include "MPU6050.hpp"
+#include "clock.hpp"
+#include "persistentStore.hpp"
+
+/// @file
+
+/// The offsets of an MPU6050, in LSB of its most sensitive ranges: +-2g (16384 per g) and +-250dps (131 per dps).
+///
+/// An offset is what the chip measures on top of the truth, so subtracting it corrects a sample.
+struct Mpu6050Offsets {
+  int16_t accX;
+  int16_t accY;
+  int16_t accZ;
+  int16_t gyroX;
+  int16_t gyroY;
+  int16_t gyroZ;
+};
+
+/// The axis of the MPU6050 that points up while calibrating, and so measures 1g.
+enum class upAxis : uint8_t { xUp, xDown, yUp, yDown, zUp, zDown };
+
+/// Measures the offsets of an MPU6050 and corrects them, on the chip or in software, and keeps them in a PersistentStore.
+///
+/// Every MPU6050 measures a small acceleration and rotation when there is none, up to 20dps and 0.08g according to the
+/// datasheet. A controller that has to ignore those needs a large deadband. measure averages samples taken while the
+/// chip stands still in a known orientation, and whatever differs from 1g along the up axis and 0 everywhere else is offset.
+///
+/// apply writes the offsets into the chip's offset registers, after which every sample, the FIFO included, comes out
+/// corrected. Those registers are lost at power down, so save keeps the offsets in a PersistentStore and load gets them
+/// back at the next start, which saves the chip from having to stand still during every startup:
+///
+///   auto calibrator = Mpu6050Calibrator( mpu );
+///   Mpu6050Offsets offsets;
+///   if(!Mpu6050Calibrator::load( store, offsets )){
+///     while(!calibrator.measure( offsets )){}
+///     Mpu6050Calibrator::save( store, offsets );
+///   }
+///   calibrator.apply( offsets );
+///
+/// remove corrects a sample in software instead, for a chip whose registers can't or shouldn't be changed.
+class Mpu6050Calibrator {
+public:
+  /// The amount of bytes save uses: a magic number, the offsets and a checksum.
+  static const size_t RECORD_SIZE = 18;
+
+private:
+  /// The chip being calibrated.
+  Mpu6050 &mpu;
+
+  /// The clock waited on between samples.
+  Clock &clock;
+
+  /// The offsets apply last wrote to the chip, which the chip no longer measures.
+  Mpu6050Offsets applied;
+
+  /// XA_OFFS, YA_OFFS and ZA_OFFS as they were before apply first changed them.
+  int16_t factoryAccelOffsets[3];
+  bool factoryKnown;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a Mpu6050Calibrator for a chip whose offset registers haven't been changed since it powered up.
+  /// measure waits on the given clock, which defaults to the real time of hwlib.
+  Mpu6050Calibrator(Mpu6050 & mpu, Clock & clock = hwlibClock());
+
+  /// Measures the offsets by averaging samples taken interval microseconds apart.
+  ///
+  /// The chip has to stand still with up pointing up. Works at any full scale range and DLPF setting, as long as interval
+  /// isn't shorter than the sample period. Offsets already written by apply are included, so measuring again after apply
+  /// gives the complete offsets, ready to be saved. Returns false, without changing offsets, when any gyroscope axis
+  /// varied by more than maxGyroSpread LSB (at the configured range), which means the chip was moved.
+  bool measure(Mpu6050Offsets & offsets, uint16_t samples = 500, upAxis up = upAxis::zUp,
+    uint16_t maxGyroSpread = 400, uint32_t interval = 1000);
+
+  /// Writes offsets into the chip's accelerometer and gyroscope offset registers, replacing earlier ones.
+  ///
+  /// Keeps the factory trim of the accelerometer, on which the offsets are added. The registers are coarser than the offsets:
+  /// what's left is at most 8 LSB (0.5mg) on the accelerometer and 2 LSB (0.015dps) on the gyroscope.
+  void apply(const Mpu6050Offsets & offsets);
+
+  /// Returns a sample with the offsets subtracted, for the given full scale ranges (afs_sel and fs_sel from 0 to 3).
+  static Mpu6050Sample remove(const Mpu6050Sample & sample, const Mpu6050Offsets & offsets, uint8_t afs_sel = 0, uint8_t fs_sel = 0);
+
+  /// Writes offsets to a store, returns whether that worked.
+  static bool save(PersistentStore & store, const Mpu6050Offsets & offsets);
+
+  /// Reads offsets saved earlier from a store.
+  ///
+  /// Returns false, without changing offsets, when the store doesn't hold saved offsets or they were damaged.
+  static bool load(PersistentStore & store, Mpu6050Offsets & offsets);
+};
+
+#endif
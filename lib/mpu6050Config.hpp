@@ -0,0 +1,117 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MPU6050CONFIG_HPP
+#define MPU6050CONFIG_HPP
+
+#include <stdint.h>
+
+/// @file
+
+/// The settings of the digital low pass filter, the DLPF_CFG values of CONFIG, named after the accelerometer's bandwidth.
+enum class dlpfBandwidth : uint8_t { hz260 = 0, hz184, hz94, hz44, hz21, hz10, hz5 };
+
+/// How an MPU6050 samples: output rate, filter and full scale ranges, as written by Mpu6050::configure.
+///
+/// The chip samples its gyroscope at 8kHz with the DLPF at hz260 and at 1kHz otherwise, and outputs every
+/// (1 + rateDivider)th sample. The accelerometer always samples at 1kHz, faster output rates repeat its values.
+struct Mpu6050Config {
+  /// The DLPF setting, for both the accelerometer and the gyroscope.
+  dlpfBandwidth bandwidth;
+
+  /// SMPLRT_DIV, from 0 to 255.
+  uint8_t rateDivider;
+
+  /// The full scale range of the accelerometer, from 0 (+-2g) to 3 (+-16g).
+  uint8_t afs_sel;
+
+  /// The full scale range of the gyroscope, from 0 (+-250dps) to 3 (+-2000dps).
+  uint8_t fs_sel;
+};
+
+/// The timing of every DLPF setting and what it means for a Mpu6050Config.
+///
+/// A narrower filter takes out more noise, but delays every change of the measurements longer. The table holds the
+/// bandwidths and delays of the register map, so the latency of a configuration is known at compile time:
+///
+///   constexpr auto config = mpu6050Config::forRate( 200, dlpfBandwidth::hz44 );
+///   static_assert( mpu6050Config::latency( config ) < 10000, "too slow for the control loop" );
+namespace mpu6050Config {
+  /// The timing of one DLPF setting.
+  struct dlpfInfo {
+    /// The -3dB bandwidth of the accelerometer in Hz.
+    uint16_t accelBandwidth;
+
+    /// The delay of the accelerometer in microseconds.
+    uint16_t accelDelay;
+
+    /// The -3dB bandwidth of the gyroscope in Hz.
+    uint16_t gyroBandwidth;
+
+    /// The delay of the gyroscope in microseconds.
+    uint16_t gyroDelay;
+
+    /// The time between two gyroscope samples in microseconds, before SMPLRT_DIV.
+    uint16_t gyroPeriod;
+  };
+
+  /// The timing of DLPF_CFG 0 to 6, from the register map.
+  constexpr dlpfInfo DLPF[7] = {
+    {260,     0, 256,   980,  125},
+    {184,  2000, 188,  1900, 1000},
+    { 94,  3000,  98,  2800, 1000},
+    { 44,  4900,  42,  4800, 1000},
+    { 21,  8500,  20,  8300, 1000},
+    { 10, 13800,  10, 13400, 1000},
+    {  5, 19000,   5, 18600, 1000}
+  };
+
+  /// Returns the timing of a DLPF setting.
+  constexpr const dlpfInfo & info(dlpfBandwidth bandwidth){
+    return DLPF[static_cast<uint8_t>(bandwidth)];
+  }
+
+  /// Returns the time between two samples in microseconds.
+  constexpr uint32_t samplePeriod(const Mpu6050Config & config){
+    return info(config.bandwidth).gyroPeriod * (1u + config.rateDivider);
+  }
+
+  /// Returns the amount of samples per second, rounded down.
+  constexpr uint32_t sampleRate(const Mpu6050Config & config){
+    return 1000000 / samplePeriod(config);
+  }
+
+  /// Returns the delay of the filter in microseconds, the longer one of the accelerometer and the gyroscope.
+  constexpr uint32_t filterDelay(const Mpu6050Config & config){
+    return info(config.bandwidth).accelDelay > info(config.bandwidth).gyroDelay
+      ? info(config.bandwidth).accelDelay : info(config.bandwidth).gyroDelay;
+  }
+
+  /// Returns the longest time in microseconds from a change of the motion until a sample shows it:
+  /// the delay of the filter plus a whole sample period.
+  constexpr uint32_t latency(const Mpu6050Config & config){
+    return filterDelay(config) + samplePeriod(config);
+  }
+
+  /// Returns whether the filter takes out everything the output rate is too slow for, which is when
+  /// both bandwidths are at most half the sample rate.
+  constexpr bool isAliasFree(const Mpu6050Config & config){
+    return 2u * info(config.bandwidth).accelBandwidth <= sampleRate(config)
+      && 2u * info(config.bandwidth).gyroBandwidth <= sampleRate(config);
+  }
+
+  /// Returns a configuration with the output rate closest to rate samples per second.
+  ///
+  /// Rates above the gyroscope rate of the filter give the gyroscope rate, rates below it divided by 256 give that.
+  constexpr Mpu6050Config forRate(uint32_t rate, dlpfBandwidth bandwidth, uint8_t afs_sel = 0, uint8_t fs_sel = 0){
+    uint32_t gyroRate = 1000000 / info(bandwidth).gyroPeriod;
+    uint32_t divisor = rate == 0 ? 256 : (gyroRate + rate / 2) / rate;
+    if(divisor < 1){ divisor = 1; }
+    if(divisor > 256){ divisor = 256; }
+    return Mpu6050Config{bandwidth, static_cast<uint8_t>(divisor - 1), afs_sel, fs_sel};
+  }
+}
+
+#endif
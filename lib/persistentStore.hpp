@@ -0,0 +1,33 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PERSISTENTSTORE_HPP
+#define PERSISTENTSTORE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @file
+
+/// A few bytes that survive a reset and a power cycle.
+///
+/// The store doesn't know what it holds, so whoever uses it has to recognise its own data, for example
+/// with a magic number and a checksum. A store that was never written holds whatever the memory holds after
+/// erasing, which is all 0xFF for flash. DueFlashStore uses the flash of the Arduino Due.
+class PersistentStore {
+public:
+  /// Returns the amount of bytes the store holds.
+  virtual size_t capacity() const = 0;
+
+  /// Copies the first n bytes of the store into data. n must not exceed capacity.
+  virtual void read(uint8_t data[], size_t n) = 0;
+
+  /// Replaces the contents of the store with n bytes from data, the rest is erased.
+  ///
+  /// n must not exceed capacity. Returns whether the bytes were written correctly.
+  virtual bool write(const uint8_t data[], size_t n) = 0;
+};
+
+#endif
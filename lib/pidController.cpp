@@ -0,0 +1,69 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "pidController.hpp"
+
+PidController::PidController(float kp, float ki, float kd, float outputLimit, uint32_t derivativeTimeConstant, float deadband):
+  kp( kp ),
+  ki( ki ),
+  kd( kd ),
+  outputLimit( outputLimit ),
+  derivativeTimeConstant( derivativeTimeConstant ),
+  deadband( deadband ),
+  integral( 0.0f ),
+  derivative( 0.0f ),
+  previousMeasurement( 0.0f ),
+  started( false )
+{}
+
+float PidController::update(float setpoint, float measurement, uint32_t dt){
+  float seconds = dt * 0.000001f;
+  float error = setpoint - measurement;
+
+  if(started && dt > 0){
+    float rate = (previousMeasurement - measurement) / seconds;
+    float alpha = dt / (derivativeTimeConstant + dt);
+    derivative += alpha * (rate - derivative);
+  }
+  previousMeasurement = measurement;
+  started = true;
+
+  if(error <= deadband && error >= -deadband){
+    return 0.0f;
+  }
+
+  float proportional = kp * error;
+  float derivativePart = kd * derivative;
+  float newIntegral = integral + ki * error * seconds;
+  float output = proportional + newIntegral + derivativePart;
+
+  // anti-windup: only let the integral grow while that doesn't push the command further past the limit
+  if(output > outputLimit){
+    if(newIntegral < integral){
+      integral = newIntegral;
+    }
+    output = outputLimit;
+  }else if(output < -outputLimit){
+    if(newIntegral > integral){
+      integral = newIntegral;
+    }
+    output = -outputLimit;
+  }else{
+    integral = newIntegral;
+  }
+  return output;
+}
+
+void PidController::reset(){
+  integral = 0.0f;
+  derivative = 0.0f;
+  started = false;
+}
+
+void PidController::setGains(float newKp, float newKi, float newKd){
+  kp = newKp;
+  ki = newKi;
+  kd = newKd;
+}
@@ -0,0 +1,76 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PIDCONTROLLER_HPP
+#define PIDCONTROLLER_HPP
+
+#include <stdint.h>
+
+/// @file
+
+/// A PID controller with anti-windup and a filtered derivative.
+///
+/// Turns the difference between where something should be (the setpoint) and where it is (the measurement)
+/// into a command, for example the angle error of the gimbal into a step rate for a StepperEngine.
+/// The command is proportional to the error (kp), to the error summed over time (ki) and to how fast the
+/// measurement changes (kd). Uses float only, like the AttitudeEstimator.
+///
+/// Three details keep the controller well behaved:
+///   - The command is limited to outputLimit. While it is, the integral stops growing in the direction
+///     that keeps it limited (anti-windup), so it doesn't overshoot once the error is gone.
+///   - The derivative is taken from the measurement instead of the error, so changing the setpoint doesn't
+///     cause a kick, and it is low pass filtered, so noise in the measurement isn't amplified.
+///   - Errors smaller than the deadband give a command of 0 and leave the integral alone. A steppermotor can
+///     only reach whole steps, so without a deadband of about half a step the controller keeps hunting around
+///     a setpoint that lies between two steps.
+class PidController {
+private:
+  /// The proportional, integral and derivative gains.
+  float kp, ki, kd;
+
+  /// The largest command in either direction.
+  float outputLimit;
+
+  /// The time constant in microseconds of the derivative's low pass filter.
+  float derivativeTimeConstant;
+
+  /// The largest error that is treated as no error at all.
+  float deadband;
+
+  /// The sum of ki * error * dt so far.
+  float integral;
+
+  /// The filtered rate of change of the measurement.
+  float derivative;
+
+  /// The previous measurement.
+  float previousMeasurement;
+
+  /// Whether there is a previous measurement.
+  bool started;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a PID controller with the given gains, where time is in seconds, and commands limited to
+  /// plus or minus outputLimit. derivativeTimeConstant is the time constant in microseconds of the derivative
+  /// filter, which defaults to 10ms. deadband defaults to 0, which turns it off.
+  PidController(float kp, float ki, float kd, float outputLimit, uint32_t derivativeTimeConstant = 10000, float deadband = 0.0f);
+
+  /// Calculates the next command.
+  ///
+  /// dt is the time in microseconds since the previous call.
+  float update(float setpoint, float measurement, uint32_t dt);
+
+  /// Forgets the integral and the previous measurement.
+  void reset();
+
+  /// Changes the gains.
+  ///
+  /// The integral is kept, so changing gains while running doesn't cause a jump in the command.
+  void setGains(float newKp, float newKi, float newKd);
+};
+
+#endif
@@ -0,0 +1,106 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAMPLEBUFFER_HPP
+#define SAMPLEBUFFER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// @file
+
+/// All measurements of the MPU6050 taken at the same moment.
+///
+/// Filled by Mpu6050::readAll, which reads ACCEL_XOUT_H up to and including GYRO_ZOUT_L
+/// in one burst, and by Mpu6050::readFifo. All values are raw, in the order in which they
+/// appear in the register map.
+struct Mpu6050Sample {
+  int16_t accX;
+  int16_t accY;
+  int16_t accZ;
+  int16_t temperature;
+  int16_t gyroX;
+  int16_t gyroY;
+  int16_t gyroZ;
+};
+
+/// A ring buffer of Mpu6050Samples in memory supplied by the caller.
+///
+/// Doesn't allocate anything itself, so the caller decides how much RAM is spent on buffering,
+/// for example by passing a static array. Samples are taken out in the order in which they were put in.
+class Mpu6050SampleBuffer {
+private:
+  /// The memory the samples are stored in.
+  Mpu6050Sample *storage;
+
+  /// The amount of samples that fit in storage.
+  size_t capacity;
+
+  /// The index of the oldest sample in storage.
+  size_t head;
+
+  /// The amount of samples currently stored.
+  size_t count;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs an empty buffer that stores at most capacity samples in the given array.
+  Mpu6050SampleBuffer(Mpu6050Sample storage[], size_t capacity):
+    storage( storage ),
+    capacity( capacity ),
+    head( 0 ),
+    count( 0 )
+  {}
+
+  /// Adds a sample as the newest one.
+  ///
+  /// Returns false and leaves the buffer unchanged when it is full.
+  bool push(const Mpu6050Sample & sample){
+    if(count == capacity){
+      return false;
+    }
+    size_t tail = head + count;
+    if(tail >= capacity){
+      tail -= capacity;
+    }
+    storage[tail] = sample;
+    count++;
+    return true;
+  }
+
+  /// Takes out the oldest sample.
+  ///
+  /// Returns false and leaves sample unchanged when the buffer is empty.
+  bool pop(Mpu6050Sample & sample){
+    if(count == 0){
+      return false;
+    }
+    sample = storage[head];
+    head++;
+    if(head == capacity){
+      head = 0;
+    }
+    count--;
+    return true;
+  }
+
+  /// Returns the amount of samples stored.
+  size_t size() const { return count; }
+
+  /// Returns the amount of samples that can still be pushed.
+  size_t space() const { return capacity - count; }
+
+  /// Returns whether there are no samples stored.
+  bool empty() const { return count == 0; }
+
+  /// Removes all samples.
+  void clear(){
+    head = 0;
+    count = 0;
+  }
+};
+
+#endif
@@ -0,0 +1,201 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "sampleLog.hpp"
+
+const size_t SampleLog::BLOCK_SIZE;
+
+namespace {
+  void putWord(uint8_t *data, uint16_t value){
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+  }
+
+  uint16_t getWord(const uint8_t *data){
+    return data[0] | data[1] << 8;
+  }
+
+  /// The values of a sample in the order they are stored in.
+  void values(const Mpu6050Sample & sample, int16_t out[7]){
+    out[0] = sample.accX;
+    out[1] = sample.accY;
+    out[2] = sample.accZ;
+    out[3] = sample.temperature;
+    out[4] = sample.gyroX;
+    out[5] = sample.gyroY;
+    out[6] = sample.gyroZ;
+  }
+}
+
+SampleLog::SampleLog(uint8_t storage[], size_t size, uint16_t period):
+  storage( storage ),
+  capacity( size / BLOCK_SIZE ),
+  first( 0 ),
+  used( 0 ),
+  offset( 0 ),
+  period( period ),
+  previous{},
+  previousTime( 0 ),
+  count( 0 ),
+  enabled( true )
+{}
+
+uint8_t * SampleLog::block(size_t i) const {
+  size_t index = first + i;
+  if(index >= capacity){
+    index -= capacity;
+  }
+  return storage + index * BLOCK_SIZE;
+}
+
+void SampleLog::startBlock(uint32_t time, const Mpu6050Sample & sample){
+  if(used == capacity){
+    count -= getWord(block(0));
+    first++;
+    if(first == capacity){
+      first = 0;
+    }
+    used--;
+  }
+  used++;
+  uint8_t *b = block(used - 1);
+  putWord(b, 1);
+  putWord(b + 2, time & 0xFFFF);
+  putWord(b + 4, time >> 16);
+  putWord(b + 6, period);
+  int16_t v[7];
+  values(sample, v);
+  for(int i = 0; i < 7; i++){
+    putWord(b + 8 + 2 * i, static_cast<uint16_t>(v[i]));
+  }
+  offset = sampleLogFormat::BLOCK_HEADER_SIZE;
+}
+
+void SampleLog::record(uint32_t time, const Mpu6050Sample & sample){
+  if(!enabled || capacity == 0){
+    return;
+  }
+  count++;
+  if(used == 0){
+    startBlock(time, sample);
+    previous = sample;
+    previousTime = time;
+    return;
+  }
+
+  // encode into a scratch buffer first, the record only goes in the block when all of it fits
+  uint8_t record[sampleLogFormat::MAX_RECORD];
+  size_t n = sampleLogFormat::putVarint(record, sampleLogFormat::zigzag(static_cast<int32_t>(time - previousTime - period)));
+  int16_t now[7];
+  int16_t before[7];
+  values(sample, now);
+  values(previous, before);
+  for(int i = 0; i < 7; i++){
+    n += sampleLogFormat::putVarint(record + n, sampleLogFormat::zigzag(now[i] - before[i]));
+  }
+  previous = sample;
+  previousTime = time;
+
+  if(offset + n > BLOCK_SIZE){
+    startBlock(time, sample);
+    return;
+  }
+  uint8_t *b = block(used - 1);
+  for(size_t i = 0; i < n; i++){
+    b[offset + i] = record[i];
+  }
+  offset += n;
+  putWord(b, getWord(b) + 1);
+}
+
+void SampleLog::enable(bool on){
+  enabled = on;
+}
+
+void SampleLog::clear(){
+  first = 0;
+  used = 0;
+  offset = 0;
+  count = 0;
+}
+
+size_t SampleLog::size() const {
+  return count;
+}
+
+size_t SampleLog::blocks() const {
+  return used;
+}
+
+size_t SampleLog::bytes() const {
+  return used == 0 ? 0 : (used - 1) * BLOCK_SIZE + offset;
+}
+
+SampleLogReader::SampleLogReader():
+  count( 0 ),
+  blocksRead( 0 )
+{
+  restart();
+}
+
+void SampleLogReader::restart(){
+  current = state::magic;
+  filled = 0;
+  sum = 0;
+}
+
+SampleLogReader::result SampleLogReader::feed(uint8_t byte){
+  switch(current){
+    case state::magic:
+      if(byte == sampleLogFormat::MAGIC[filled]){
+        filled++;
+      }else{
+        filled = byte == sampleLogFormat::MAGIC[0] ? 1 : 0;
+      }
+      if(filled == sizeof(sampleLogFormat::MAGIC)){
+        current = state::header;
+        filled = 0;
+      }
+      return result::nothing;
+
+    case state::header:
+      sum += byte;
+      header[filled++] = byte;
+      if(filled == sampleLogFormat::HEADER_SIZE){
+        if(getWord(header) != sampleLogFormat::BLOCK_SIZE){
+          restart();
+          return result::error;
+        }
+        count = getWord(header + 2);
+        blocksRead = 0;
+        filled = 0;
+        current = count > 0 ? state::blocks : state::checksum;
+      }
+      return result::nothing;
+
+    case state::blocks:
+      sum += byte;
+      block[filled++] = byte;
+      if(filled == sampleLogFormat::BLOCK_SIZE){
+        filled = 0;
+        blocksRead++;
+        if(blocksRead == count){
+          current = state::checksum;
+        }
+        return result::block;
+      }
+      return result::nothing;
+
+    case state::checksum:
+      header[filled++] = byte;
+      if(filled == 2){
+        bool good = getWord(header) == sum;
+        restart();
+        return good ? result::done : result::error;
+      }
+      return result::nothing;
+  }
+  return result::nothing;
+}
@@ -0,0 +1,276 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SAMPLELOG_HPP
+#define SAMPLELOG_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sampleBuffer.hpp"
+
+/// @file
+
+/// The format of the blocks of a SampleLog and of SampleLog::dump, all numbers little endian.
+///
+/// A block holds a keyframe and the samples after it, as differences with the previous sample:
+///
+///   uint16 count                        the amount of samples in the block, the keyframe included
+///   uint32 time, uint16 period          the time of the keyframe and the expected time between samples, in microseconds
+///   7 times int16                       the keyframe, in the order of Mpu6050Sample
+///   count - 1 times:
+///     varint time difference - period   so a sample right on schedule costs a single byte
+///     7 times varint value difference
+///
+/// A varint stores 7 bits per byte, lowest first, with the high bit set on every byte but the last. Differences
+/// are zigzag encoded first (0, -1, 1, -2, ... become 0, 1, 2, 3, ...), so small negative ones stay small too.
+/// The rest of a block is unused. Every block can be decoded on its own, so losing the oldest one loses nothing else.
+///
+/// A dump is:
+///
+///   'S' 'L' 'G' '1'                     magic
+///   uint16 block size, uint16 count    header
+///   count blocks, oldest first
+///   uint16 sum of every byte after the magic
+namespace sampleLogFormat {
+  const uint8_t MAGIC[4] = {'S', 'L', 'G', '1'};
+  const size_t HEADER_SIZE = 4;
+  const size_t BLOCK_SIZE = 256;
+  const size_t BLOCK_HEADER_SIZE = 22;
+
+  /// The most bytes one sample can take after the keyframe: a 32 bit time difference and 7 differences of 17 bits.
+  const size_t MAX_RECORD = 5 + 7 * 3;
+
+  /// Returns a difference zigzag encoded.
+  inline uint32_t zigzag(int32_t value){
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+  }
+
+  /// Returns a zigzag encoded difference decoded.
+  inline int32_t unzigzag(uint32_t value){
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+  }
+
+  /// Writes value as a varint at data and returns the amount of bytes written, at most 5.
+  inline size_t putVarint(uint8_t data[], uint32_t value){
+    size_t n = 0;
+    while(value >= 0x80){
+      data[n++] = (value & 0x7F) | 0x80;
+      value >>= 7;
+    }
+    data[n++] = value;
+    return n;
+  }
+
+  /// Reads a varint from data[i] on, without going past end. Returns false when it doesn't end in time.
+  inline bool getVarint(const uint8_t data[], size_t & i, size_t end, uint32_t & value){
+    value = 0;
+    for(int shift = 0; shift < 35; shift += 7){
+      if(i >= end){
+        return false;
+      }
+      uint8_t b = data[i++];
+      value |= static_cast<uint32_t>(b & 0x7F) << shift;
+      if((b & 0x80) == 0){
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Calls f(time, sample) for every sample in a block of BLOCK_SIZE bytes, oldest first.
+  ///
+  /// Returns the amount of samples decoded. Stops early when the block is damaged, so that is less than
+  /// the count in the block then.
+  template< typename F >
+  size_t decodeBlock(const uint8_t block[], F f){
+    auto word = [&](size_t i){ return static_cast<uint16_t>(block[i] | block[i + 1] << 8); };
+    size_t count = word(0);
+    uint32_t time = word(2) | static_cast<uint32_t>(word(4)) << 16;
+    uint16_t period = word(6);
+    int16_t values[7];
+    for(int i = 0; i < 7; i++){
+      values[i] = static_cast<int16_t>(word(8 + 2 * i));
+    }
+    size_t i = BLOCK_HEADER_SIZE;
+    for(size_t n = 0; n < count; n++){
+      if(n > 0){
+        uint32_t encoded;
+        if(!getVarint(block, i, BLOCK_SIZE, encoded)){
+          return n;
+        }
+        time += period + unzigzag(encoded);
+        for(int axis = 0; axis < 7; axis++){
+          if(!getVarint(block, i, BLOCK_SIZE, encoded)){
+            return n;
+          }
+          values[axis] = static_cast<int16_t>(values[axis] + unzigzag(encoded));
+        }
+      }
+      f(time, Mpu6050Sample{values[0], values[1], values[2], values[3], values[4], values[5], values[6]});
+    }
+    return count;
+  }
+}
+
+/// A flight recorder for raw samples, in little more than half the memory they take as they are.
+///
+/// The Due's 96kB of RAM holds only a few seconds of raw samples at 1kHz, 14 bytes each plus a timestamp.
+/// Between two samples the measurements hardly change though, so SampleLog stores the differences in as few
+/// bytes as they need, in blocks of BLOCK_SIZE bytes that each start with a complete sample, see sampleLogFormat.
+/// When the memory is full the oldest block is dropped, so the log always holds the last seconds before a fault,
+/// ready to be dumped and looked at on a PC.
+///
+/// Like TraceBuffer the memory is supplied by the caller and recording can be switched off to freeze the log:
+///
+///   uint8_t storage[32768];
+///   auto log = SampleLog( storage, sizeof( storage ) );
+///   log.record( hwlib::now_us(), mpu.readAll() );
+///   ...
+///   log.enable( false );
+///   log.dump( [](uint8_t b){ hwlib::uart_putc( b ); } );
+///
+/// Only record from one context, the main loop or a single interrupt.
+class SampleLog {
+private:
+  uint8_t *storage;
+
+  /// The amount of blocks that fit in storage.
+  size_t capacity;
+
+  /// The index of the oldest block and the amount of blocks in use, the last of which is being filled.
+  size_t first;
+  size_t used;
+
+  /// The first free byte in the block being filled.
+  size_t offset;
+
+  /// The expected time between samples, in microseconds.
+  uint16_t period;
+
+  /// The last sample recorded and its time, which the next one is stored relative to.
+  Mpu6050Sample previous;
+  uint32_t previousTime;
+
+  /// The amount of samples in the log.
+  size_t count;
+
+  /// Whether recording is on.
+  bool enabled;
+
+  /// Returns the block with the given index, counting from the oldest one.
+  uint8_t * block(size_t i) const;
+
+  /// Starts a new block with the given sample as its keyframe, dropping the oldest block when the memory is full.
+  void startBlock(uint32_t time, const Mpu6050Sample & sample);
+
+public:
+  /// The amount of bytes in a block.
+  static const size_t BLOCK_SIZE = sampleLogFormat::BLOCK_SIZE;
+
+  /// Constructor
+  ///
+  /// Constructs an empty SampleLog that keeps as many blocks as fit in size bytes of storage, for samples expected
+  /// period microseconds apart. Samples that aren't are stored too, only they take a few bytes more.
+  SampleLog(uint8_t storage[], size_t size, uint16_t period = 1000);
+
+  /// Adds a sample taken at time, in microseconds.
+  void record(uint32_t time, const Mpu6050Sample & sample);
+
+  /// Turns recording on or off, for example to freeze the log after something went wrong.
+  void enable(bool on);
+
+  /// Forgets all samples.
+  void clear();
+
+  /// Returns the amount of samples in the log.
+  size_t size() const;
+
+  /// Returns the amount of blocks in use.
+  size_t blocks() const;
+
+  /// Returns the amount of bytes the samples take, not counting the unused rest of each block.
+  size_t bytes() const;
+
+  /// Calls f(time, sample) for every sample in the log, oldest first.
+  template< typename F >
+  void forEach(F f) const {
+    for(size_t i = 0; i < used; i++){
+      sampleLogFormat::decodeBlock(block(i), f);
+    }
+  }
+
+  /// Writes every block in the log, oldest first, in the format of sampleLogFormat, one byte at a time to put.
+  ///
+  /// put is anything that can be called with a uint8_t, like a function writing to the UART.
+  /// Recording is paused during the dump so the blocks don't change underneath it.
+  template< typename Sink >
+  void dump(Sink put){
+    bool wasEnabled = enabled;
+    enabled = false;
+    uint16_t sum = 0;
+    auto byte = [&](uint8_t b){
+      put(b);
+      sum += b;
+    };
+    for(uint8_t b : sampleLogFormat::MAGIC){
+      put(b);
+    }
+    byte(BLOCK_SIZE & 0xFF);
+    byte(BLOCK_SIZE >> 8);
+    byte(used & 0xFF);
+    byte(used >> 8);
+    for(size_t i = 0; i < used; i++){
+      const uint8_t *b = block(i);
+      for(size_t j = 0; j < BLOCK_SIZE; j++){
+        byte(b[j]);
+      }
+    }
+    put(sum & 0xFF);
+    put(sum >> 8);
+    enabled = wasEnabled;
+  }
+};
+
+/// Turns the bytes written by SampleLog::dump back into blocks, one byte at a time.
+///
+/// Skips everything before the magic, so it can read straight from a serial port that also carries text.
+/// Every complete block can be decoded with sampleLogFormat::decodeBlock.
+class SampleLogReader {
+public:
+  /// What the last byte completed.
+  enum class result { nothing, block, done, error };
+
+private:
+  enum class state { magic, header, blocks, checksum };
+  state current;
+  size_t filled;
+  uint16_t sum;
+  uint8_t header[sampleLogFormat::HEADER_SIZE];
+
+  void restart();
+
+public:
+  /// The block read last, complete when feed returned block.
+  uint8_t block[sampleLogFormat::BLOCK_SIZE];
+
+  /// The amount of blocks in the dump, known once the header has been read.
+  uint16_t count;
+
+  /// The amount of blocks read so far.
+  uint16_t blocksRead;
+
+  /// Constructor
+  ///
+  /// Constructs a SampleLogReader that waits for the magic.
+  SampleLogReader();
+
+  /// Reads one byte.
+  ///
+  /// Returns block when a block is complete, done when the dump is complete and its checksum is right, and error
+  /// when the checksum is wrong or the dump has another block size. After done or error it waits for the next magic.
+  result feed(uint8_t byte);
+};
+
+#endif
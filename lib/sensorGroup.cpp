@@ -0,0 +1,85 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "sensorGroup.hpp"
+
+const uint8_t SensorGroup::MAX_SENSORS;
+
+SensorGroup::SensorGroup(uint32_t busFrequency, uint8_t maxLoad):
+  sensorCount( 0 ),
+  busFrequency( busFrequency ),
+  maxLoad( maxLoad )
+{}
+
+uint8_t SensorGroup::addSensor(Mpu6050 & mpu, DataReadyMonitor & dataReady){
+  if(sensorCount == MAX_SENSORS){
+    return MAX_SENSORS;
+  }
+  sensors[sensorCount] = member{&mpu, &dataReady, Mpu6050Sample{}, 0, false};
+  return sensorCount++;
+}
+
+uint8_t SensorGroup::size() const {
+  return sensorCount;
+}
+
+Mpu6050Config SensorGroup::configure(const Mpu6050Config & config){
+  Mpu6050Config slowed = config;
+  uint32_t busy = sensorCount * transferTime(busFrequency) * 100;
+  while(busy > maxLoad * mpu6050Config::samplePeriod(slowed) && slowed.rateDivider < 255){
+    slowed.rateDivider++;
+  }
+  for(uint8_t i = 0; i < sensorCount; i++){
+    sensors[i].mpu->configure(slowed);
+  }
+  return slowed;
+}
+
+uint32_t SensorGroup::busLoad(){
+  uint32_t load = 0;
+  for(uint8_t i = 0; i < sensorCount; i++){
+    load += transferTime(busFrequency) * 100 / sensors[i].mpu->samplePeriod();
+  }
+  return load;
+}
+
+uint8_t SensorGroup::poll(){
+  // take every ready sample first, so they can be read oldest first
+  uint8_t ready[MAX_SENSORS];
+  uint8_t readyCount = 0;
+  for(uint8_t i = 0; i < sensorCount; i++){
+    uint_fast64_t timestamp;
+    if(!sensors[i].dataReady->takeSample(timestamp)){
+      continue;
+    }
+    sensors[i].timestamp = timestamp;
+    uint8_t position = readyCount++;
+    while(position > 0 && sensors[ready[position - 1]].timestamp > timestamp){
+      ready[position] = ready[position - 1];
+      position--;
+    }
+    ready[position] = i;
+  }
+  for(uint8_t i = 0; i < readyCount; i++){
+    member & sensor = sensors[ready[i]];
+    sensor.sample = sensor.mpu->readAll();
+    sensor.fresh = true;
+  }
+  return readyCount;
+}
+
+bool SensorGroup::takeSample(uint8_t sensor, Mpu6050Sample & sample, uint_fast64_t & timestamp){
+  if(sensor >= sensorCount || !sensors[sensor].fresh){
+    return false;
+  }
+  sample = sensors[sensor].sample;
+  timestamp = sensors[sensor].timestamp;
+  sensors[sensor].fresh = false;
+  return true;
+}
+
+uint32_t SensorGroup::readMissed(uint8_t sensor) const {
+  return sensor < sensorCount ? sensors[sensor].dataReady->readMissed() : 0;
+}
@@ -0,0 +1,112 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SENSORGROUP_HPP
+#define SENSORGROUP_HPP
+
+#include "MPU6050.hpp"
+#include "dataReadyMonitor.hpp"
+
+/// @file
+
+/// Reads several Mpu6050s that share one i2c bus, for example one at 0x68 on the handle and one at 0x69 on the platform.
+///
+/// Every sensor has its own INT pin and DataReadyMonitor, so every sample is timestamped by the edge of its own pin,
+/// in the same timebase for all sensors. poll reads every sensor with a new sample in one burst each, the oldest
+/// sample first, so the sensor that has been waiting longest is read first.
+///
+/// All reads of one round have to be done before the next sample of any sensor, or the bus falls behind and samples
+/// get lost. transferTime estimates how long a burst takes on the bus, and configure slows all sensors down just
+/// enough to keep the share of the bus spent reading below a limit:
+///
+///   auto group = SensorGroup( 400000 );
+///   group.addSensor( handleMpu, handleReady );
+///   group.addSensor( platformMpu, platformReady );
+///   group.configure( mpu6050Config::forRate( 1000, dlpfBandwidth::hz184 ) );
+///   for(;;){
+///     group.poll();
+///     if(group.takeSample( 1, sample, timestamp )){
+///       ...
+///     }
+///   }
+class SensorGroup {
+public:
+  /// The maximum amount of sensors in a group.
+  static const uint8_t MAX_SENSORS = 4;
+
+  /// Returns the time in microseconds a burst read of bytes registers takes on a bus running at busFrequency Hz, rounded up.
+  ///
+  /// Counts 9 bits per byte (8 data bits and an acknowledge) for the address byte of the write, the register address,
+  /// the address byte of the read and the data, plus the start, repeated start and stop conditions.
+  static constexpr uint32_t transferTime(uint32_t busFrequency, size_t bytes = 14){
+    return (((3 + bytes) * 9 + 4) * 1000000 + busFrequency - 1) / busFrequency;
+  }
+
+private:
+  /// What the group knows about one sensor.
+  struct member {
+    Mpu6050 *mpu;
+    DataReadyMonitor *dataReady;
+
+    /// The last sample read and the time it was ready.
+    Mpu6050Sample sample;
+    uint_fast64_t timestamp;
+
+    /// Whether sample hasn't been taken yet.
+    bool fresh;
+  };
+
+  /// The sensors, of which the first sensorCount are in use.
+  member sensors[MAX_SENSORS];
+
+  /// The amount of sensors added.
+  uint8_t sensorCount;
+
+  /// The frequency of the bus in Hz.
+  uint32_t busFrequency;
+
+  /// The largest part of the bus time configure lets the reads take, in percent.
+  uint8_t maxLoad;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a SensorGroup without sensors, on a bus running at busFrequency Hz of which configure lets
+  /// the reads take at most maxLoad percent. The rest is left for other traffic and for the loop to react.
+  SensorGroup(uint32_t busFrequency = 400000, uint8_t maxLoad = 80);
+
+  /// Adds a sensor and the DataReadyMonitor on its INT pin to the group, and returns its number.
+  ///
+  /// Returns MAX_SENSORS when the group is full. The sensors have to be on the same bus at different addresses.
+  uint8_t addSensor(Mpu6050 & mpu, DataReadyMonitor & dataReady);
+
+  /// Returns the amount of sensors in the group.
+  uint8_t size() const;
+
+  /// Configures every sensor with the same output rate, filter and full scale ranges.
+  ///
+  /// Raises the rate divider of config until reading all sensors at that rate takes at most maxLoad percent
+  /// of the bus, or until it can't be raised any further. Returns the configuration that was written.
+  Mpu6050Config configure(const Mpu6050Config & config);
+
+  /// Returns the part of the bus time, in percent, it takes to read every sample of every sensor at their configured rates.
+  uint32_t busLoad();
+
+  /// Reads every sensor that has a new sample, in the order the samples became ready.
+  ///
+  /// Returns the amount of sensors read. A sample that wasn't taken yet is replaced by the new one.
+  uint8_t poll();
+
+  /// Takes the last sample read from a sensor, if it hasn't been taken yet.
+  ///
+  /// Returns false when there is no new sample. Otherwise sets sample and sets timestamp to the time the sample
+  /// was ready, in the timebase of the pins.
+  bool takeSample(uint8_t sensor, Mpu6050Sample & sample, uint_fast64_t & timestamp);
+
+  /// Returns the amount of samples of a sensor that were lost because the previous one wasn't read in time.
+  uint32_t readMissed(uint8_t sensor) const;
+};
+
+#endif
@@ -0,0 +1,134 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SENSORUNITS_HPP
+#define SENSORUNITS_HPP
+
+#include <stdint.h>
+#include "sampleBuffer.hpp"
+
+/// @file
+
+/// All measurements of the MPU6050 taken at the same moment, in integer units.
+///
+/// Accelerations are in mm/s^2, angular velocities in millidegrees per second and the temperature in
+/// millidegrees Celsius. That is a thousand times finer than one LSB at the most sensitive ranges,
+/// so nothing the chip measures is lost, and none of it needs a float.
+struct Mpu6050ScaledSample {
+  int32_t accX;
+  int32_t accY;
+  int32_t accZ;
+  int32_t temperature;
+  int32_t gyroX;
+  int32_t gyroY;
+  int32_t gyroZ;
+};
+
+/// Conversions from raw MPU6050 values to the units of Mpu6050ScaledSample.
+///
+/// The Cortex-M3 of the Arduino Due has no FPU, so every float operation is a call to a software routine.
+/// The fixed point functions multiply the raw value by a factor in Q16.16 format (16 integer bits and 16 fraction
+/// bits), precomputed for every full scale range, and round the result: one 32x32 to 64 bit multiplication, an
+/// addition and a shift. The float functions calculate the same thing in float, as a reference.
+///
+/// accelero, gyro and temperature use the fixed point functions, unless MPU6050_FLOAT_UNITS is defined, for
+/// example in the Makefile with PROJECT_CPP_FLAGS += -DMPU6050_FLOAT_UNITS.
+namespace sensorUnits {
+  /// The amount of fraction bits of the factors.
+  constexpr int FRACTION_BITS = 16;
+
+  /// Returns x in Q16.16, rounded. Only meant for constants, it uses double.
+  constexpr int32_t toQ16(double x){
+    return static_cast<int32_t>(x * (1 << FRACTION_BITS) + 0.5);
+  }
+
+  /// The acceleration of gravity in mm/s^2, the same value Mpu6050::convertAccelero uses.
+  constexpr int32_t GRAVITY = 9810;
+
+  /// mm/s^2 per LSB for afs_sel 0 to 3.
+  constexpr int32_t ACCELERO_FACTORS[4] = {
+    toQ16(GRAVITY / 16384.0), toQ16(GRAVITY / 8192.0), toQ16(GRAVITY / 4096.0), toQ16(GRAVITY / 2048.0)
+  };
+
+  /// LSB per degree per second for fs_sel 0 to 3.
+  constexpr float GYRO_SENSITIVITIES[4] = {131.0f, 65.5f, 32.8f, 16.4f};
+
+  /// Millidegrees per second per LSB for fs_sel 0 to 3.
+  constexpr int32_t GYRO_FACTORS[4] = {
+    toQ16(1000 / 131.0), toQ16(1000 / 65.5), toQ16(1000 / 32.8), toQ16(1000 / 16.4)
+  };
+
+  /// Millidegrees Celsius per LSB.
+  constexpr int32_t TEMPERATURE_FACTOR = toQ16(1000 / 340.0);
+
+  /// Millidegrees Celsius at a raw value of 0, the same offset Mpu6050::readTemperature uses.
+  constexpr int32_t TEMPERATURE_OFFSET = 31530;
+
+  /// Multiplies a raw value by a Q16.16 factor and rounds to the nearest integer.
+  constexpr int32_t multiplyQ16(int16_t raw, int32_t factor){
+    return static_cast<int32_t>((static_cast<int64_t>(raw) * factor + (1 << (FRACTION_BITS - 1))) >> FRACTION_BITS);
+  }
+
+  /// Rounds a float to the nearest integer.
+  constexpr int32_t roundFloat(float x){
+    return static_cast<int32_t>(x < 0 ? x - 0.5f : x + 0.5f);
+  }
+
+  /// Converts a raw accelerometer value to mm/s^2 in fixed point.
+  constexpr int32_t fixedAccelero(int16_t raw, uint8_t afs_sel){
+    return multiplyQ16(raw, ACCELERO_FACTORS[afs_sel & 0x03]);
+  }
+
+  /// Converts a raw gyroscope value to millidegrees per second in fixed point.
+  constexpr int32_t fixedGyro(int16_t raw, uint8_t fs_sel){
+    return multiplyQ16(raw, GYRO_FACTORS[fs_sel & 0x03]);
+  }
+
+  /// Converts a raw temperature value to millidegrees Celsius in fixed point.
+  constexpr int32_t fixedTemperature(int16_t raw){
+    return multiplyQ16(raw, TEMPERATURE_FACTOR) + TEMPERATURE_OFFSET;
+  }
+
+  /// Converts a raw accelerometer value to mm/s^2 in float.
+  inline int32_t floatAccelero(int16_t raw, uint8_t afs_sel){
+    return roundFloat(raw * static_cast<float>(GRAVITY) / (16384 >> (afs_sel & 0x03)));
+  }
+
+  /// Converts a raw gyroscope value to millidegrees per second in float.
+  inline int32_t floatGyro(int16_t raw, uint8_t fs_sel){
+    return roundFloat(raw * 1000.0f / GYRO_SENSITIVITIES[fs_sel & 0x03]);
+  }
+
+  /// Converts a raw temperature value to millidegrees Celsius in float.
+  inline int32_t floatTemperature(int16_t raw){
+    return roundFloat(raw * 1000.0f / 340.0f) + TEMPERATURE_OFFSET;
+  }
+
+#ifdef MPU6050_FLOAT_UNITS
+  inline int32_t accelero(int16_t raw, uint8_t afs_sel){ return floatAccelero(raw, afs_sel); }
+  inline int32_t gyro(int16_t raw, uint8_t fs_sel){ return floatGyro(raw, fs_sel); }
+  inline int32_t temperature(int16_t raw){ return floatTemperature(raw); }
+#else
+  /// Converts a raw accelerometer value to mm/s^2.
+  constexpr int32_t accelero(int16_t raw, uint8_t afs_sel){ return fixedAccelero(raw, afs_sel); }
+
+  /// Converts a raw gyroscope value to millidegrees per second.
+  constexpr int32_t gyro(int16_t raw, uint8_t fs_sel){ return fixedGyro(raw, fs_sel); }
+
+  /// Converts a raw temperature value to millidegrees Celsius.
+  constexpr int32_t temperature(int16_t raw){ return fixedTemperature(raw); }
+#endif
+
+  /// Converts a complete sample taken at the given full scale ranges.
+  inline Mpu6050ScaledSample scale(const Mpu6050Sample & sample, uint8_t afs_sel, uint8_t fs_sel){
+    return Mpu6050ScaledSample{
+      accelero(sample.accX, afs_sel), accelero(sample.accY, afs_sel), accelero(sample.accZ, afs_sel),
+      temperature(sample.temperature),
+      gyro(sample.gyroX, fs_sel), gyro(sample.gyroY, fs_sel), gyro(sample.gyroZ, fs_sel)
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,84 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <stddef.h>
+#include <atomic>
+
+/// @file
+
+/// A lock-free queue for exactly one producer and one consumer.
+///
+/// Meant for passing data between the main loop and an interrupt: one side only calls push,
+/// the other only calls pop, and neither ever has to disable interrupts or wait. This works because
+/// head is only written by the consumer and tail only by the producer. On the Cortex-M3 the atomic loads
+/// and stores of these indices are single instructions plus a memory barrier.
+///
+/// Holds at most N - 1 items, the last slot tells a full queue from an empty one.
+template< typename T, size_t N >
+class SpscQueue {
+private:
+  /// The stored items.
+  T items[N];
+
+  /// The index of the next item to pop, only written by the consumer.
+  std::atomic<size_t> head;
+
+  /// The index of the next free slot, only written by the producer.
+  std::atomic<size_t> tail;
+
+  /// Returns the index after i.
+  static size_t next(size_t i){
+    return (i + 1 == N) ? 0 : i + 1;
+  }
+
+public:
+  /// Constructor
+  ///
+  /// Constructs an empty queue.
+  SpscQueue():
+    items{},
+    head( 0 ),
+    tail( 0 )
+  {}
+
+  /// Adds an item at the back. Only call this from the producer.
+  ///
+  /// Returns false and leaves the queue unchanged when it is full.
+  bool push(const T & item){
+    size_t t = tail.load(std::memory_order_relaxed);
+    if(next(t) == head.load(std::memory_order_acquire)){
+      return false;
+    }
+    items[t] = item;
+    tail.store(next(t), std::memory_order_release);
+    return true;
+  }
+
+  /// Takes the item at the front. Only call this from the consumer.
+  ///
+  /// Returns false and leaves item unchanged when the queue is empty.
+  bool pop(T & item){
+    size_t h = head.load(std::memory_order_relaxed);
+    if(h == tail.load(std::memory_order_acquire)){
+      return false;
+    }
+    item = items[h];
+    head.store(next(h), std::memory_order_release);
+    return true;
+  }
+
+  /// Returns whether the queue is empty.
+  ///
+  /// When called from the producer the queue may have been emptied further by the time this returns,
+  /// and the other way around.
+  bool empty() const {
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+  }
+};
+
+#endif
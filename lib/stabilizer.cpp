@@ -0,0 +1,117 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "stabilizer.hpp"
+
+Stabilizer::Stabilizer(Mpu6050 & mpu, DataReadyMonitor & dataReady, AttitudeEstimator & estimator,
+  PidController & pitchPid, PidController & rollPid,
+  StepperEngine & pitchEngine, StepperEngine & rollEngine, mounting remap):
+  mpu( mpu ),
+  dataReady( dataReady ),
+  estimator( estimator ),
+  pitchPid( pitchPid ),
+  rollPid( rollPid ),
+  pitchEngine( pitchEngine ),
+  rollEngine( rollEngine ),
+  remap( remap ),
+  lastSample( 0 ),
+  trace( nullptr ),
+  telemetry( nullptr ),
+  sampleLog( nullptr ),
+  pitchMonitor( nullptr ),
+  rollMonitor( nullptr ),
+  base( nullptr )
+{}
+
+void Stabilizer::setTrace(TraceBuffer *newTrace){
+  trace = newTrace;
+}
+
+void Stabilizer::setTelemetry(Telemetry *newTelemetry){
+  telemetry = newTelemetry;
+}
+
+void Stabilizer::setSampleLog(SampleLog *newSampleLog){
+  sampleLog = newSampleLog;
+}
+
+void Stabilizer::setStepLossMonitors(StepLossMonitor *newPitchMonitor, StepLossMonitor *newRollMonitor, Mpu6050 *newBase){
+  pitchMonitor = newPitchMonitor;
+  rollMonitor = newRollMonitor;
+  base = newBase;
+}
+
+Mpu6050Sample Stabilizer::readSample(){
+  Mpu6050Sample sample = mpu.readAll();
+  return remap != nullptr ? remap(sample) : sample;
+}
+
+void Stabilizer::checkSteps(const Mpu6050Sample & sample, uint32_t dt){
+  if(pitchMonitor == nullptr && rollMonitor == nullptr){
+    return;
+  }
+  Mpu6050Sample baseSample = {};
+  if(base != nullptr){
+    baseSample = base->readAll();
+    if(remap != nullptr){
+      baseSample = remap(baseSample);
+    }
+  }
+  if(pitchMonitor != nullptr && pitchMonitor->update(sample.gyroY, baseSample.gyroY, dt) && trace != nullptr){
+    trace->record(TRACE_PITCH_STEP_LOSS, pitchMonitor->getSpeedLimit());
+  }
+  if(rollMonitor != nullptr && rollMonitor->update(sample.gyroX, baseSample.gyroX, dt) && trace != nullptr){
+    trace->record(TRACE_ROLL_STEP_LOSS, rollMonitor->getSpeedLimit());
+  }
+}
+
+void Stabilizer::start(uint_fast64_t now){
+  uint_fast64_t ignored;
+  dataReady.takeSample(ignored);
+  estimator.reset(readSample());
+  pitchPid.reset();
+  rollPid.reset();
+  if(pitchMonitor != nullptr){
+    pitchMonitor->reset();
+  }
+  if(rollMonitor != nullptr){
+    rollMonitor->reset();
+  }
+  lastSample = now;
+}
+
+bool Stabilizer::poll(uint_fast64_t now){
+  uint_fast64_t sampleTime;
+  bool sampled = dataReady.takeSample(sampleTime);
+  if(sampled){
+    uint32_t dt = sampleTime - lastSample;
+    lastSample = sampleTime;
+    Mpu6050Sample sample = readSample();
+    if(sampleLog != nullptr){
+      sampleLog->record(sampleTime, sample);
+    }
+    checkSteps(sample, dt);
+    estimator.update(sample, dt);
+    int32_t pitchSpeed = pitchPid.update(0.0f, -estimator.getPitch(), dt);
+    int32_t rollSpeed = rollPid.update(0.0f, estimator.getRoll(), dt);
+    pitchEngine.setSpeed(pitchSpeed);
+    rollEngine.setSpeed(rollSpeed);
+    if(trace != nullptr){
+      trace->record(TRACE_LOOP_TICK, dt);
+      trace->record(TRACE_SENSOR_READ, static_cast<uint32_t>(static_cast<uint16_t>(sample.gyroX)) << 16 | static_cast<uint16_t>(sample.gyroY));
+      int16_t roll = estimator.getRoll() * 100;
+      int16_t pitch = estimator.getPitch() * 100;
+      trace->record(TRACE_ATTITUDE, static_cast<uint32_t>(static_cast<uint16_t>(roll)) << 16 | static_cast<uint16_t>(pitch));
+      trace->record(TRACE_PITCH_COMMAND, pitchSpeed);
+      trace->record(TRACE_ROLL_COMMAND, rollSpeed);
+    }
+    if(telemetry != nullptr){
+      telemetry->sendLoop(sampleTime, sample, estimator.getRoll(), estimator.getPitch(), pitchSpeed, rollSpeed);
+    }
+  }
+  pitchEngine.poll(now);
+  rollEngine.poll(now);
+  return sampled;
+}
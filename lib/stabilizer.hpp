@@ -0,0 +1,104 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STABILIZER_HPP
+#define STABILIZER_HPP
+
+#include "MPU6050.hpp"
+#include "dataReadyMonitor.hpp"
+#include "attitudeEstimator.hpp"
+#include "pidController.hpp"
+#include "stepperEngine.hpp"
+#include "traceBuffer.hpp"
+#include "telemetry.hpp"
+#include "sampleLog.hpp"
+#include "stepLossMonitor.hpp"
+
+/// @file
+
+/// The control loop of the gimbal.
+///
+/// On every new sample of the Mpu6050 it updates the AttitudeEstimator and turns the pitch and roll into
+/// step rates for the two StepperEngines with a PidController per axis, and in between it polls the engines.
+/// Everything it uses is passed in, so the same loop runs on the Arduino Due in applicatie and against
+/// simulated hardware on a virtual clock in the GimbalSimulator.
+///
+/// The pitch motor turns the platform's pitch down when it turns clockwise, the roll motor turns its roll up.
+class Stabilizer {
+public:
+  /// A function that rotates a sample from the way the MPU6050 is mounted to Z pointing up.
+  typedef Mpu6050Sample (*mounting)(const Mpu6050Sample & sample);
+
+private:
+  Mpu6050 & mpu;
+  DataReadyMonitor & dataReady;
+  AttitudeEstimator & estimator;
+  PidController & pitchPid;
+  PidController & rollPid;
+  StepperEngine & pitchEngine;
+  StepperEngine & rollEngine;
+
+  /// The rotation applied to every sample, or nullptr when Z already points up.
+  mounting remap;
+
+  /// The time of the last sample used.
+  uint_fast64_t lastSample;
+
+  /// Where the loop records what it does, or nullptr.
+  TraceBuffer *trace;
+
+  /// Where the loop streams what it does, or nullptr.
+  Telemetry *telemetry;
+
+  /// Where the loop keeps the raw samples, or nullptr.
+  SampleLog *sampleLog;
+
+  /// What watches the motors for lost steps, or nullptr, and the MPU6050 on the base they compare with, if any.
+  StepLossMonitor *pitchMonitor;
+  StepLossMonitor *rollMonitor;
+  Mpu6050 *base;
+
+  /// Returns the newest measurements, rotated to Z pointing up.
+  Mpu6050Sample readSample();
+
+  /// Gives the sample to the StepLossMonitors, if any, and traces the lost steps they find.
+  void checkSteps(const Mpu6050Sample & sample, uint32_t dt);
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a Stabilizer out of the parts of the control loop and the way the MPU6050 is mounted.
+  Stabilizer(Mpu6050 & mpu, DataReadyMonitor & dataReady, AttitudeEstimator & estimator,
+    PidController & pitchPid, PidController & rollPid,
+    StepperEngine & pitchEngine, StepperEngine & rollEngine, mounting remap = nullptr);
+
+  /// Makes the loop record every sample, attitude and motor command in the given TraceBuffer, or nothing when nullptr.
+  void setTrace(TraceBuffer *newTrace);
+
+  /// Makes the loop send a TELEMETRY_LOOP packet for every sample to the given Telemetry, or nothing when nullptr.
+  ///
+  /// The packets are only queued, draining the Telemetry is up to the caller.
+  void setTelemetry(Telemetry *newTelemetry);
+
+  /// Makes the loop record every sample it uses in the given SampleLog, or nothing when nullptr.
+  void setSampleLog(SampleLog *newSampleLog);
+
+  /// Makes the loop check every sample for lost steps of the pitch and the roll motor, or not when nullptr.
+  ///
+  /// The monitors compare the steps of the engines with the gyroscope around the Y and the X axis, relative to the
+  /// same axes of newBase, an MPU6050 on the base that is mounted and rotated like the one on the platform.
+  /// Without it the monitors assume the base stands still, see StepLossMonitor.
+  void setStepLossMonitors(StepLossMonitor *newPitchMonitor, StepLossMonitor *newRollMonitor, Mpu6050 *newBase = nullptr);
+
+  /// Starts the estimator from a fresh sample, taken at now.
+  void start(uint_fast64_t now);
+
+  /// Runs the control loop once. Call this as often as possible with the current time in microseconds.
+  ///
+  /// Returns whether a new sample was used.
+  bool poll(uint_fast64_t now);
+};
+
+#endif
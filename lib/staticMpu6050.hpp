@@ -0,0 +1,211 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STATICMPU6050_HPP
+#define STATICMPU6050_HPP
+
+#include "hwlib.hpp"
+#include "sampleBuffer.hpp"
+#include "sensorUnits.hpp"
+
+/// @file
+
+/// The register map and full scale ranges of the MPU6050, known at compile time.
+namespace mpu6050 {
+  constexpr uint8_t SMPLRT_DIV =    0x19;
+  constexpr uint8_t CONFIG =        0x1A;
+  constexpr uint8_t GYRO_CONFIG =   0x1B;
+  constexpr uint8_t ACCEL_CONFIG =  0x1C;
+  constexpr uint8_t ACCEL_XOUT_H =  0x3B;
+  constexpr uint8_t ACCEL_YOUT_H =  0x3D;
+  constexpr uint8_t ACCEL_ZOUT_H =  0x3F;
+  constexpr uint8_t TEMP_OUT_H =    0x41;
+  constexpr uint8_t GYRO_XOUT_H =   0x43;
+  constexpr uint8_t GYRO_YOUT_H =   0x45;
+  constexpr uint8_t GYRO_ZOUT_H =   0x47;
+  constexpr uint8_t PWR_MGMT_1 =    0x6B;
+  constexpr uint8_t WHO_AM_I =      0x75;
+
+  /// The accelerometer's full scale range, the value being AFS_SEL.
+  enum class accelRange : uint8_t { g2 = 0, g4 = 1, g8 = 2, g16 = 3 };
+
+  /// The gyroscope's full scale range, the value being FS_SEL.
+  enum class gyroRange : uint8_t { dps250 = 0, dps500 = 1, dps1000 = 2, dps2000 = 3 };
+
+  /// Returns the LSB per g of an accelerometer range.
+  constexpr int32_t accelSensitivity(accelRange range){
+    return 16384 >> static_cast<uint8_t>(range);
+  }
+
+  /// Returns the LSB per degree per second of a gyroscope range.
+  constexpr float gyroSensitivity(gyroRange range){
+    return range == gyroRange::dps250 ? 131.0f
+      : range == gyroRange::dps500 ? 65.5f
+      : range == gyroRange::dps1000 ? 32.8f
+      : 16.4f;
+  }
+}
+
+/// Makes any hwlib::i2c_bus usable as the Bus of a StaticMpu6050.
+///
+/// All functions are inline and not virtual, so a StaticMpu6050 on a HwlibRegisterBus
+/// only pays for the hwlib bus's own virtual primitives.
+template< typename I2cBus = hwlib::i2c_bus >
+class HwlibRegisterBus {
+private:
+  I2cBus & bus;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a HwlibRegisterBus on the given hwlib bus.
+  HwlibRegisterBus(I2cBus & bus):
+    bus( bus )
+  {}
+
+  /// Writes n bytes in one write transaction.
+  void write(uint8_t address, const uint8_t data[], size_t n){
+    hwlib::i2c_write_transaction(bus, address).write(data, n);
+  }
+
+  /// Selects a register and reads n bytes from it in one read transaction.
+  void readRegisters(uint8_t address, uint8_t registerAddress, uint8_t data[], size_t n){
+    hwlib::i2c_write_transaction(bus, address).write(registerAddress);
+    hwlib::i2c_read_transaction(bus, address).read(data, n);
+  }
+};
+
+/// An MPU6050 of which the bus type, the address and the full scale ranges are fixed at compile time.
+///
+/// Does the same as Mpu6050, but everything Mpu6050 looks up at runtime is a template parameter or a constexpr:
+/// the register addresses, the address of the chip and the conversion factors. Nothing is virtual. An object
+/// only holds a reference to its bus, where an Mpu6050 holds two bus pointers, 35 register addresses, the
+/// configuration shadows and a vtable pointer, and every read of an Mpu6050 goes through the vtable.
+/// The conversions are constexpr: the accelerometer's is a multiplication and a shift, because its divisor
+/// is a power of two, and the gyroscope's a single float multiplication by a precomputed reciprocal,
+/// where Mpu6050 does a table lookup, a multiplication and a division in float. The benchmark project compares both.
+///
+/// Bus is anything with write(address, data, n) and readRegisters(address, register, data, n), like a
+/// DueTwiBus or a HwlibRegisterBus. Use Mpu6050 when the ranges have to change at runtime.
+///
+///   auto bus = DueTwiBus();
+///   auto mpu = StaticMpu6050< DueTwiBus, 0x68, mpu6050::accelRange::g2, mpu6050::gyroRange::dps250 >( bus );
+///   mpu.init();
+template<
+  typename Bus,
+  uint8_t ADDRESS = 0x68,
+  mpu6050::accelRange ACCEL_RANGE = mpu6050::accelRange::g2,
+  mpu6050::gyroRange GYRO_RANGE = mpu6050::gyroRange::dps250
+>
+class StaticMpu6050 {
+private:
+  Bus & bus;
+
+  /// Writes one register.
+  void writeRegister(uint8_t registerAddress, uint8_t value){
+    const uint8_t data[2] = {registerAddress, value};
+    bus.write(ADDRESS, data, 2);
+  }
+
+  /// Reads two registers as a big endian int16_t.
+  int16_t readWord(uint8_t registerAddress){
+    uint8_t data[2];
+    bus.readRegisters(ADDRESS, registerAddress, data, 2);
+    return static_cast<int16_t>(data[0] << 8 | data[1]);
+  }
+
+public:
+  /// The LSB per g of the accelerometer.
+  static constexpr int32_t ACCEL_SENSITIVITY = mpu6050::accelSensitivity(ACCEL_RANGE);
+
+  /// The degrees per second per LSB of the gyroscope.
+  static constexpr float GYRO_FACTOR = 1.0f / mpu6050::gyroSensitivity(GYRO_RANGE);
+
+  /// Constructor
+  ///
+  /// Constructs a StaticMpu6050 on the given bus. Doesn't touch the chip, call init for that.
+  StaticMpu6050(Bus & bus):
+    bus( bus )
+  {}
+
+  /// Wakes the chip up and sets the full scale ranges of the template parameters.
+  void init(){
+    writeRegister(mpu6050::PWR_MGMT_1, 0);
+    writeRegister(mpu6050::GYRO_CONFIG, static_cast<uint8_t>(GYRO_RANGE) << 3);
+    writeRegister(mpu6050::ACCEL_CONFIG, static_cast<uint8_t>(ACCEL_RANGE) << 3);
+  }
+
+  /// Reads n consecutive registers in one go.
+  void readRegisters(uint8_t registerAddress, uint8_t data[], size_t n){
+    bus.readRegisters(ADDRESS, registerAddress, data, n);
+  }
+
+  /// Reads one register.
+  uint8_t readRegister(uint8_t registerAddress){
+    uint8_t value;
+    bus.readRegisters(ADDRESS, registerAddress, &value, 1);
+    return value;
+  }
+
+  /// Converts a raw accelerometer value to cm/s^2, truncated like Mpu6050::convertAccelero.
+  static constexpr int16_t convertAccelero(int16_t raw){
+    return static_cast<int16_t>(raw * 981 / ACCEL_SENSITIVITY);
+  }
+
+  /// Converts a raw gyroscope value to degrees per second, truncated like Mpu6050::convertGyro.
+  static constexpr int16_t convertGyro(int16_t raw){
+    return static_cast<int16_t>(raw * GYRO_FACTOR);
+  }
+
+  /// Converts a raw temperature value to degrees Celsius, like Mpu6050::readTemperature.
+  static constexpr int16_t convertTemperature(int16_t raw){
+    return static_cast<int16_t>(raw / 340 + 31.53f);
+  }
+
+  /// Converts a raw accelerometer value to mm/s^2 with sensorUnits.
+  static int32_t scaleAccelero(int16_t raw){
+    return sensorUnits::accelero(raw, static_cast<uint8_t>(ACCEL_RANGE));
+  }
+
+  /// Converts a raw gyroscope value to millidegrees per second with sensorUnits.
+  static int32_t scaleGyro(int16_t raw){
+    return sensorUnits::gyro(raw, static_cast<uint8_t>(GYRO_RANGE));
+  }
+
+  /// Converts a sample to mm/s^2, millidegrees per second and millidegrees Celsius with sensorUnits.
+  static Mpu6050ScaledSample scale(const Mpu6050Sample & sample){
+    return sensorUnits::scale(sample, static_cast<uint8_t>(ACCEL_RANGE), static_cast<uint8_t>(GYRO_RANGE));
+  }
+
+  int16_t readAccXRaw(){ return readWord(mpu6050::ACCEL_XOUT_H); }
+  int16_t readAccYRaw(){ return readWord(mpu6050::ACCEL_YOUT_H); }
+  int16_t readAccZRaw(){ return readWord(mpu6050::ACCEL_ZOUT_H); }
+  int16_t readGyroXRaw(){ return readWord(mpu6050::GYRO_XOUT_H); }
+  int16_t readGyroYRaw(){ return readWord(mpu6050::GYRO_YOUT_H); }
+  int16_t readGyroZRaw(){ return readWord(mpu6050::GYRO_ZOUT_H); }
+
+  /// Reads an acceleration in cm/s^2.
+  int16_t readAccX(){ return convertAccelero(readAccXRaw()); }
+  int16_t readAccY(){ return convertAccelero(readAccYRaw()); }
+  int16_t readAccZ(){ return convertAccelero(readAccZRaw()); }
+
+  /// Reads an angular velocity in degrees per second.
+  int16_t readGyroX(){ return convertGyro(readGyroXRaw()); }
+  int16_t readGyroY(){ return convertGyro(readGyroYRaw()); }
+  int16_t readGyroZ(){ return convertGyro(readGyroZRaw()); }
+
+  /// Reads the temperature in degrees Celsius.
+  int16_t readTemperature(){ return convertTemperature(readWord(mpu6050::TEMP_OUT_H)); }
+
+  /// Reads all measurements at once, raw, like Mpu6050::readAll.
+  Mpu6050Sample readAll(){
+    uint8_t data[14];
+    bus.readRegisters(ADDRESS, mpu6050::ACCEL_XOUT_H, data, 14);
+    auto word = [&](int i){ return static_cast<int16_t>(data[2 * i] << 8 | data[2 * i + 1]); };
+    return Mpu6050Sample{word(0), word(1), word(2), word(3), word(4), word(5), word(6)};
+  }
+};
+
+#endif
@@ -0,0 +1,81 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "stepLossMonitor.hpp"
+#include <math.h>
+
+const uint32_t StepLossMonitor::RECOVERY;
+
+StepLossMonitor::StepLossMonitor(StepperEngine & engine, float degreesPerStep, float gyroSensitivity, uint32_t maxSpeed,
+  uint32_t minSpeed, float tolerance, uint32_t window):
+  engine( engine ),
+  degreesPerStep( degreesPerStep ),
+  gyroSensitivity( gyroSensitivity ),
+  maxSpeed( maxSpeed ),
+  minSpeed( minSpeed < maxSpeed ? minSpeed : maxSpeed ),
+  tolerance( tolerance ),
+  window( window ),
+  limit( maxSpeed ),
+  lastPosition( engine.getPosition() ),
+  commanded( 0 ),
+  elapsed( 0 ),
+  difference( 0 ),
+  slips( 0 )
+{
+  engine.setSpeedLimit(maxSpeed);
+}
+
+bool StepLossMonitor::update(int16_t gyro, int16_t baseGyro, uint32_t dt){
+  int32_t position = engine.getPosition();
+  float stepped = (position - lastPosition) * degreesPerStep;
+  lastPosition = position;
+  commanded += stepped;
+  difference += (gyro - baseGyro) / gyroSensitivity * dt / 1e6f - stepped;
+  elapsed += dt;
+  if(elapsed < window){
+    return false;
+  }
+
+  float seconds = elapsed / 1e6f;
+  bool lost = fabsf(commanded) > tolerance && difference * (commanded > 0 ? 1 : -1) < -tolerance;
+  if(lost){
+    slips++;
+    // below the speed of this window, which was too fast, not just below the limit
+    float speed = fabsf(commanded / degreesPerStep) / seconds;
+    if(speed < limit){
+      limit = speed;
+    }
+    limit *= 0.9f;
+    if(limit < minSpeed){
+      limit = minSpeed;
+    }
+    difference = 0;
+  }else{
+    limit += RECOVERY * seconds;
+    if(limit > maxSpeed){
+      limit = maxSpeed;
+    }
+    difference *= 0.5f;
+  }
+  engine.setSpeedLimit(static_cast<uint32_t>(limit));
+  commanded = 0;
+  elapsed = 0;
+  return lost;
+}
+
+void StepLossMonitor::reset(){
+  lastPosition = engine.getPosition();
+  commanded = 0;
+  elapsed = 0;
+  difference = 0;
+}
+
+uint32_t StepLossMonitor::getSpeedLimit() const {
+  return static_cast<uint32_t>(limit);
+}
+
+uint32_t StepLossMonitor::getSlips() const {
+  return slips;
+}
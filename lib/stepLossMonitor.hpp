@@ -0,0 +1,101 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STEPLOSSMONITOR_HPP
+#define STEPLOSSMONITOR_HPP
+
+#include "stepperEngine.hpp"
+
+/// @file
+
+/// Notices a StepperEngine losing steps by comparing the steps it took with the rotation the gyroscope measured.
+///
+/// A steppermotor has no idea where its rotor is: when a 28BYJ-48 is driven faster than its load allows, the rotor
+/// falls behind and the coils pull it in a whole electrical turn (8 half steps) later, while the StepperEngine keeps
+/// counting the steps it never made. The gyroscope does see it. Over every window of a few samples a StepLossMonitor
+/// adds up the rotation the engine's steps should have given and the rotation the gyroscope measured around the
+/// motor's axis. When the motor turned more than tolerance degrees less than it was told to, it lost steps.
+/// The monitor then lowers the engine's speed limit below the speed it was going at, and raises it again slowly,
+/// by RECOVERY steps per second every second, while no more steps are lost. So the motors can be run close to
+/// their real limit, which depends on the load and the supply voltage, and settle just below it.
+///
+/// The gyroscope on the platform measures the rotation of the base as well, and the motors turn exactly against
+/// that: with the base moving, a motor that keeps up looks just like one that loses steps. So the rotation is
+/// measured relative to the base, with a second MPU6050 on the base, mounted the same way. Without one the base
+/// has to stand still for the monitor to be right, moving it looks like lost steps and only slows the motors down.
+///
+///   auto monitor = StepLossMonitor( engine, 360.0f / 4096, mpu.readGyroConfig(), 1500 );
+///   ...
+///   monitor.update( platform.gyroX, base.gyroX, dt );
+class StepLossMonitor {
+private:
+  StepperEngine &engine;
+
+  /// The rotation around the measured axis that one clockwise step gives, in degrees.
+  float degreesPerStep;
+
+  /// The raw gyroscope value of 1 degree per second.
+  float gyroSensitivity;
+
+  /// The highest and lowest speed limit in steps per second.
+  uint32_t maxSpeed;
+  uint32_t minSpeed;
+
+  /// The largest shortfall in degrees that isn't counted as lost steps.
+  float tolerance;
+
+  /// The length of a window in microseconds.
+  uint32_t window;
+
+  /// The speed limit given to the engine, in steps per second.
+  float limit;
+
+  /// The engine's position at the previous update.
+  int32_t lastPosition;
+
+  /// The rotation commanded in the current window in degrees, and how long the window has lasted.
+  float commanded;
+  uint32_t elapsed;
+
+  /// How much further the motor turned than it was told to, in degrees, halved at the end of every window
+  /// so a slip that falls across two windows still counts, while small differences are forgotten.
+  float difference;
+
+  /// The amount of windows in which steps were lost.
+  uint32_t slips;
+
+public:
+  /// The speed the limit rises by per second without lost steps, in steps per second.
+  static const uint32_t RECOVERY = 100;
+
+  /// Constructor
+  ///
+  /// Constructs a StepLossMonitor for the given engine and sets its speed limit to maxSpeed steps per second.
+  /// degreesPerStep is the rotation one clockwise step of the engine gives around the measured axis, negative when
+  /// the gyroscope sees it as a rotation the other way. gyroSensitivity is the raw value of 1 degree per second,
+  /// as Mpu6050::readGyroConfig returns. The limit never drops below minSpeed, which should be a speed the motor
+  /// always manages. tolerance defaults to 6 half steps of a 28BYJ-48, more than a rotor lags without slipping and
+  /// less than the 8 it loses when it slips. window defaults to 20ms.
+  StepLossMonitor(StepperEngine & engine, float degreesPerStep, float gyroSensitivity, uint32_t maxSpeed,
+    uint32_t minSpeed = 500, float tolerance = 0.5f, uint32_t window = 20000);
+
+  /// Compares the steps the engine took since the previous call with what the gyroscope measured.
+  ///
+  /// gyro is the raw gyroscope value around the motor's axis on the platform, baseGyro the one on the base,
+  /// or 0 without a sensor on the base. dt is the time in microseconds since the previous call.
+  /// Returns whether a window ended in which steps were lost, after lowering the speed limit.
+  bool update(int16_t gyro, int16_t baseGyro, uint32_t dt);
+
+  /// Starts a new window from the engine's current position, for example after the loop was paused.
+  void reset();
+
+  /// Returns the speed limit given to the engine in steps per second.
+  uint32_t getSpeedLimit() const;
+
+  /// Returns the amount of windows in which steps were lost since construction.
+  uint32_t getSlips() const;
+};
+
+#endif
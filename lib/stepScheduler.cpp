@@ -0,0 +1,70 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "stepScheduler.hpp"
+
+const uint8_t StepScheduler::MAX_MOTORS;
+
+StepScheduler::StepScheduler():
+  motorCount( 0 )
+{}
+
+uint8_t StepScheduler::addMotor(steppermotor & motor, uint16_t ticksPerStep){
+  if(motorCount == MAX_MOTORS){
+    return MAX_MOTORS;
+  }
+  channel & c = channels[motorCount];
+  c.motor = &motor;
+  c.position.store(0, std::memory_order_relaxed);
+  c.target = 0;
+  c.ticksPerStep = ticksPerStep > 0 ? ticksPerStep : 1;
+  c.countdown = 0;
+  return motorCount++;
+}
+
+bool StepScheduler::post(uint8_t motor, int32_t target, uint16_t ticksPerStep){
+  if(motor >= motorCount){
+    return false;
+  }
+  return commands.push(StepCommand{motor, target, ticksPerStep});
+}
+
+int32_t StepScheduler::getPosition(uint8_t motor) const {
+  return channels[motor].position.load(std::memory_order_relaxed);
+}
+
+uint8_t StepScheduler::tick(){
+  StepCommand command;
+  while(commands.pop(command)){
+    channel & c = channels[command.motor];
+    c.target = command.target;
+    if(command.ticksPerStep > 0){
+      c.ticksPerStep = command.ticksPerStep;
+    }
+  }
+
+  uint8_t stepsTaken = 0;
+  for(uint8_t i = 0; i < motorCount; i++){
+    channel & c = channels[i];
+    if(c.countdown > 0){
+      c.countdown--;
+    }
+    int32_t position = c.position.load(std::memory_order_relaxed);
+    if(c.countdown > 0 || position == c.target){
+      continue;
+    }
+    if(c.target > position){
+      c.motor->stepClockwise();
+      position++;
+    }else{
+      c.motor->stepCounterClockwise();
+      position--;
+    }
+    c.position.store(position, std::memory_order_relaxed);
+    c.countdown = c.ticksPerStep;
+    stepsTaken++;
+  }
+  return stepsTaken;
+}
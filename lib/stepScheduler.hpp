@@ -0,0 +1,87 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STEPSCHEDULER_HPP
+#define STEPSCHEDULER_HPP
+
+#include "steppermotor.hpp"
+#include "spscQueue.hpp"
+
+/// @file
+
+/// A command for a motor controlled by a StepScheduler.
+struct StepCommand {
+  /// The number addMotor returned for the motor.
+  uint8_t motor;
+
+  /// The position to move to, in steps, clockwise being positive.
+  int32_t target;
+
+  /// The amount of ticks between two steps, or 0 to keep the current amount.
+  uint16_t ticksPerStep;
+};
+
+/// Moves steppermotors from a periodic timer interrupt.
+///
+/// The main loop only posts target positions with post, which puts them in a lock-free queue.
+/// The timer interrupt calls tick at a fixed rate, which takes the new targets out of the queue and
+/// steps every motor whose step is due, writing the next phase of the steppermotor's steps table
+/// to its port. Step timing therefore depends only on the timer, not on what the main loop is doing.
+///
+/// Nothing in this class depends on the Arduino Due, so it can be tested by calling tick from a
+/// loop instead of an interrupt. DueStepTimer connects it to a timer-counter of the Due.
+class StepScheduler {
+public:
+  /// The maximum amount of motors.
+  static const uint8_t MAX_MOTORS = 4;
+
+private:
+  /// What the scheduler knows about one motor.
+  struct channel {
+    steppermotor *motor;
+    std::atomic<int32_t> position;
+    int32_t target;
+    uint16_t ticksPerStep;
+    uint16_t countdown;
+  };
+
+  /// The motors, of which the first motorCount are in use.
+  channel channels[MAX_MOTORS];
+
+  /// The amount of motors added.
+  uint8_t motorCount;
+
+  /// The commands posted by the main loop and not yet seen by tick.
+  SpscQueue<StepCommand, 16> commands;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a StepScheduler without motors.
+  StepScheduler();
+
+  /// Adds a motor, which is assumed to be at position 0.
+  ///
+  /// The motor takes a step at most once every ticksPerStep ticks. Returns the number to use for this motor
+  /// in post and getPosition, or MAX_MOTORS when there is no room. Only call this before the timer is started.
+  uint8_t addMotor(steppermotor & motor, uint16_t ticksPerStep);
+
+  /// Gives a motor a new target and, unless ticksPerStep is 0, a new speed. Only call this from the main loop.
+  ///
+  /// Returns false when the queue is full, in which case the command is dropped.
+  bool post(uint8_t motor, int32_t target, uint16_t ticksPerStep = 0);
+
+  /// Returns the position of a motor.
+  ///
+  /// Safe to call from the main loop while the timer is running.
+  int32_t getPosition(uint8_t motor) const;
+
+  /// Takes the commands out of the queue and steps every motor whose step is due. Only call this from the timer interrupt.
+  ///
+  /// Returns the amount of steps taken.
+  uint8_t tick();
+};
+
+#endif
@@ -5,19 +5,19 @@
 
 #include "stepper28BYJ48.hpp"
 
-stepper28BYJ48::stepper28BYJ48(hwlib::port_out & port, uint16_t stepsPerRotation):
-  steppermotor( port ),
+stepper28BYJ48::stepper28BYJ48(hwlib::port_out & port, uint16_t stepsPerRotation, Clock & clock):
+  steppermotor( port, clock ),
   stepsPerRotation( stepsPerRotation )
 {}
 
 void stepper28BYJ48::turnClockwiseDegrees(uint16_t degrees){
-  float steps = degrees / 360.0 * stepsPerRotation;
+  float steps = degrees / 360.0f * stepsPerRotation / halfStepsPerStep();
   uint16_t times = steps;
   turnClockwise(times);
 }
 
 void stepper28BYJ48::turnCounterClockwiseDegrees(uint16_t degrees){
-  float steps = degrees / 360.0 * stepsPerRotation;
+  float steps = degrees / 360.0f * stepsPerRotation / halfStepsPerStep();
   uint16_t times = steps;
   turnCounterClockwise(times);
 }
@@ -16,24 +16,24 @@
 ///  to turn a given amount of degrees on top of the general steppermotor functions.
 class stepper28BYJ48 : public steppermotor {
 private:
-  /// The amount of steps the motor has to take to complete one revolution of the output shaft.
+  /// The amount of half steps the motor has to take to complete one revolution of the output shaft.
   uint16_t stepsPerRotation;
 
 public:
   /// Constructor
   ///
-  /// Constructs a stepper28BYJ48 object out of the given hwlib::port_out and an
-  /// amount of steps per rotation, which defaults to 4096.
-  stepper28BYJ48(hwlib::port_out & port, uint16_t stepsPerRotation = 4096);
+  /// Constructs a stepper28BYJ48 object out of the given hwlib::port_out, an
+  /// amount of half steps per rotation, which defaults to 4096, and the Clock to wait on, which defaults to the real time of hwlib.
+  stepper28BYJ48(hwlib::port_out & port, uint16_t stepsPerRotation = 4096, Clock & clock = hwlibClock());
 
   /// Turns the motor a given amount of degrees in clockwise direction.
   ///
-  /// Calculates the amount of steps needed to turn and rotates the motor that amount of steps.
+  /// Calculates the amount of steps of the drive mode needed to turn and rotates the motor that amount of steps.
   void turnClockwiseDegrees(uint16_t degrees);
 
   /// Turns the motor a given amount of degrees in counterclockwise direction.
   ///
-  /// Calculates the amount of steps needed to turn and rotates the motor that amount of steps.
+  /// Calculates the amount of steps of the drive mode needed to turn and rotates the motor that amount of steps.
   void turnCounterClockwiseDegrees(uint16_t degrees);
 
 };
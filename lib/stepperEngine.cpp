@@ -0,0 +1,188 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "stepperEngine.hpp"
+
+StepperEngine::StepperEngine(steppermotor & motor, uint32_t stepInterval):
+  motor( motor ),
+  position( 0 ),
+  target( 0 ),
+  stepInterval( stepInterval ),
+  lastStep( 0 ),
+  profile( nullptr ),
+  rampStep( 0 ),
+  direction( 1 ),
+  speedMode( false ),
+  speed( 0 ),
+  speedInterval( 0 ),
+  speedLimit( 0 ),
+  limitInterval( 0 )
+{}
+
+void StepperEngine::setTarget(int32_t newTarget){
+  speedMode = false;
+  target = newTarget;
+}
+
+void StepperEngine::move(int32_t steps){
+  if(speedMode){
+    target = position;
+    speedMode = false;
+  }
+  target += steps;
+}
+
+void StepperEngine::stop(){
+  speedMode = false;
+  // braking down the ramp takes one step for every step up it
+  target = position + static_cast<int32_t>(rampStep) * direction;
+}
+
+void StepperEngine::setSpeed(int32_t stepsPerSecond){
+  speedMode = true;
+  speed = stepsPerSecond;
+  if(speed == 0){
+    speedInterval = 0;
+  }else{
+    speedInterval = 1000000 / (speed > 0 ? speed : -speed);
+  }
+}
+
+int32_t StepperEngine::getSpeed() const {
+  return speedMode ? speed : 0;
+}
+
+int32_t StepperEngine::getPosition() const {
+  return position;
+}
+
+int32_t StepperEngine::getTarget() const {
+  return target;
+}
+
+bool StepperEngine::isMoving() const {
+  if(speedMode){
+    return speed != 0 || rampStep > 0;
+  }
+  return position != target || rampStep > 0;
+}
+
+void StepperEngine::setStepInterval(uint32_t interval){
+  stepInterval = interval;
+}
+
+uint32_t StepperEngine::getStepInterval() const {
+  return stepInterval;
+}
+
+void StepperEngine::setSpeedLimit(uint32_t stepsPerSecond){
+  speedLimit = stepsPerSecond;
+  limitInterval = stepsPerSecond > 0 ? 1000000 / stepsPerSecond : 0;
+}
+
+uint32_t StepperEngine::getSpeedLimit() const {
+  return speedLimit;
+}
+
+uint32_t StepperEngine::limited(uint32_t interval) const {
+  return interval < limitInterval ? limitInterval : interval;
+}
+
+void StepperEngine::setProfile(const MotionProfile & newProfile){
+  profile = &newProfile;
+  rampStep = 0;
+}
+
+void StepperEngine::clearProfile(){
+  profile = nullptr;
+  rampStep = 0;
+}
+
+void StepperEngine::step(){
+  if(direction > 0){
+    motor.stepClockwise();
+  }else{
+    motor.stepCounterClockwise();
+  }
+  position += direction;
+}
+
+bool StepperEngine::pollSpeed(uint_fast64_t now){
+  if(speed == 0 && rampStep == 0){
+    return false;
+  }
+  int8_t wanted = (speed > 0) ? 1 : -1;
+  if(rampStep == 0){
+    direction = wanted; // only turn around when standing still
+  }
+  bool braking = speed == 0 || wanted != direction;
+  uint32_t wantedInterval = limited(speedInterval);
+
+  uint32_t interval = wantedInterval;
+  if(profile != nullptr){
+    interval = profile->getInterval(rampStep);
+    if(rampStep == 0 && wantedInterval > interval){
+      interval = wantedInterval;
+    }
+  }
+  if(now - lastStep < interval){
+    return false;
+  }
+  step();
+  lastStep = now;
+
+  if(profile != nullptr){
+    if(braking || profile->getInterval(rampStep) < wantedInterval){
+      if(rampStep > 0){
+        rampStep--;
+      }
+    }else if(rampStep < profile->getRampSteps() - 1 && profile->getInterval(rampStep + 1) >= wantedInterval){
+      rampStep++;
+    }
+  }
+  return true;
+}
+
+bool StepperEngine::poll(uint_fast64_t now){
+  bool stepped = speedMode ? pollSpeed(now) : pollTarget(now);
+  motor.update(now);
+  return stepped;
+}
+
+bool StepperEngine::pollTarget(uint_fast64_t now){
+  if(profile == nullptr){
+    if(position == target || now - lastStep < limited(stepInterval)){
+      return false;
+    }
+    direction = (target > position) ? 1 : -1;
+    step();
+    lastStep = now;
+    return true;
+  }
+
+  if(rampStep == 0){
+    if(position == target){
+      return false;
+    }
+    direction = (target > position) ? 1 : -1; // only turn around when standing still
+  }
+  uint32_t rampInterval = profile->getInterval(rampStep);
+  if(now - lastStep < (rampStep == 0 ? limited(rampInterval) : rampInterval)){
+    return false;
+  }
+  step();
+  lastStep = now;
+
+  // steps still to go in the current direction, negative when the target is behind the motor
+  int32_t ahead = (target - position) * direction;
+  if(ahead > rampStep && rampInterval >= limitInterval){
+    if(rampStep < profile->getRampSteps() - 1 && profile->getInterval(rampStep + 1) >= limitInterval){
+      rampStep++;
+    }
+  }else if(rampStep > 0){
+    rampStep--;
+  }
+  return true;
+}
@@ -0,0 +1,166 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef STEPPERENGINE_HPP
+#define STEPPERENGINE_HPP
+
+#include "steppermotor.hpp"
+#include "motionProfile.hpp"
+
+/// @file
+
+/// Non-blocking position control of a steppermotor.
+///
+/// Instead of turning the motor and waiting until it's done, a StepperEngine is given a target position
+/// and takes at most one step towards it every time poll is called with the current time.
+/// It never waits, so any number of engines (and the sensor reading) can share one loop:
+///
+///   engine0.setTarget(100);
+///   engine1.setTarget(-50);
+///   for(;;){
+///     auto now = hwlib::now_us();
+///     engine0.poll(now);
+///     engine1.poll(now);
+///     // read sensors, change targets...
+///   }
+///
+/// Positions are counted in steps of the steppermotor::stepClockwise function, clockwise being positive.
+///
+/// By default every step is taken stepInterval microseconds after the previous one. After setProfile
+/// the engine accelerates and brakes along the given MotionProfile instead. It then never
+/// reverses without braking first, so a target that changes to the other side of the motor overshoots
+/// a little rather than losing steps.
+///
+/// Instead of a target position the engine can also be given a speed with setSpeed, which is what a
+/// PidController produces. It then keeps stepping at that speed until it gets a new speed or target.
+class StepperEngine {
+private:
+  /// The motor being controlled.
+  steppermotor &motor;
+
+  /// The position the motor is at.
+  int32_t position;
+
+  /// The position the motor should move to.
+  int32_t target;
+
+  /// The minimal time in microseconds between two steps.
+  uint32_t stepInterval;
+
+  /// The time of the last step in microseconds.
+  uint_fast64_t lastStep;
+
+  /// The acceleration ramp used, or nullptr to step at stepInterval.
+  const MotionProfile *profile;
+
+  /// The step of the ramp the motor is at, which stands for its current speed.
+  uint16_t rampStep;
+
+  /// The direction the motor is turning in, 1 for clockwise and -1 for counterclockwise.
+  int8_t direction;
+
+  /// Whether the engine follows a speed instead of a target position.
+  bool speedMode;
+
+  /// The speed to turn at in speed mode, in steps per second, clockwise being positive.
+  int32_t speed;
+
+  /// The time in microseconds between steps at speed.
+  uint32_t speedInterval;
+
+  /// The speed limit in steps per second and the shortest time in microseconds between steps it allows, 0 without one.
+  uint32_t speedLimit;
+  uint32_t limitInterval;
+
+  /// Returns interval, or the interval of the speed limit when that is longer.
+  uint32_t limited(uint32_t interval) const;
+
+  /// Takes one step in direction.
+  void step();
+
+  /// Does the work of poll in speed mode.
+  bool pollSpeed(uint_fast64_t now);
+
+  /// Does the work of poll when moving to a target.
+  bool pollTarget(uint_fast64_t now);
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a StepperEngine for the given steppermotor, which is assumed to be at position 0.
+  /// The motor takes a step at most once every stepInterval microseconds, which defaults to 1000.
+  StepperEngine(steppermotor & motor, uint32_t stepInterval = 1000);
+
+  /// Sets the position to move to.
+  ///
+  /// Takes effect on the next call to poll, even when the motor is halfway a previous move.
+  /// Ends speed mode.
+  void setTarget(int32_t newTarget);
+
+  /// Moves the target a given amount of steps, clockwise being positive.
+  ///
+  /// Ends speed mode.
+  void move(int32_t steps);
+
+  /// Stops as soon as possible, without turning back.
+  ///
+  /// Ends speed mode. Without a MotionProfile the motor stops at the current position. With one it brakes down
+  /// the ramp it climbed, so it stops as many steps further as the ramp step it was at, and the target is set there.
+  void stop();
+
+  /// Makes the motor turn at the given speed in steps per second, clockwise being positive.
+  ///
+  /// Without a profile the new speed is used from the next step on. With a profile the engine walks the ramp
+  /// towards the new speed, one ramp step per motor step, and brakes to a stop before changing direction.
+  /// Speeds below the profile's start speed are used directly.
+  void setSpeed(int32_t stepsPerSecond);
+
+  /// Returns the speed set by setSpeed, or 0 when not in speed mode.
+  int32_t getSpeed() const;
+
+  /// Returns the position the motor is at.
+  int32_t getPosition() const;
+
+  /// Returns the position the motor is moving to.
+  int32_t getTarget() const;
+
+  /// Returns whether the motor still has steps to take, or is turning in speed mode.
+  bool isMoving() const;
+
+  /// Sets the minimal time in microseconds between two steps.
+  void setStepInterval(uint32_t interval);
+
+  /// Returns the minimal time in microseconds between two steps.
+  uint32_t getStepInterval() const;
+
+  /// Limits the speed to the given amount of steps per second, or lifts the limit when 0.
+  ///
+  /// Holds in every mode, on top of stepInterval, the profile and setSpeed. Meant to be lowered while running,
+  /// by a StepLossMonitor that saw the motor lose steps: a faster motor walks down the ramp of its profile,
+  /// one ramp step per motor step, without it a slower interval is used from the next step on.
+  void setSpeedLimit(uint32_t stepsPerSecond);
+
+  /// Returns the speed limit in steps per second, 0 when there is none.
+  uint32_t getSpeedLimit() const;
+
+  /// Makes the motor accelerate and brake along the given profile.
+  ///
+  /// The profile has to stay alive as long as it's used. Only change the profile while the motor stands still.
+  void setProfile(const MotionProfile & newProfile);
+
+  /// Makes the motor step at stepInterval again, without acceleration.
+  void clearProfile();
+
+  /// Takes a step towards the target if one is due.
+  ///
+  /// Takes one step when the target hasn't been reached and at least stepInterval microseconds have
+  /// passed since the previous step, or the interval of the current ramp step when a profile is used.
+  /// now is the current time in microseconds, normally hwlib::now_us().
+  /// Also lets the motor apply its idle policy with steppermotor::update.
+  /// Returns whether a step was taken. Never waits.
+  bool poll(uint_fast64_t now);
+};
+
+#endif
@@ -4,69 +4,180 @@
 //          https://www.boost.org/LICENSE_1_0.txt)
 
 #include "steppermotor.hpp"
+#include "interruptLock.hpp"
 
-steppermotor::steppermotor(hwlib::port_out & port):
+steppermotor::steppermotor(hwlib::port_out & port, Clock & clock):
   port( port ),
+  clock( clock ),
   index( 0 ),
   value( 1 ),
-  steps{1, 3, 2, 6, 4, 12, 8, 9}
+  mode( driveMode::halfStep ),
+  modeInfo( &driveModes::info(driveMode::halfStep) ),
+  policy( idlePolicy::hold ),
+  idleTime( 0 ),
+  pulseOn( 0 ),
+  pulsePeriod( 0 ),
+  stepped( false ),
+  written( false ),
+  coilsOn( false ),
+  pulsing( false ),
+  updated( false ),
+  lastStep( 0 ),
+  pulseStart( 0 ),
+  lastUpdate( 0 ),
+  energizedTime( 0 ),
+  measuredTime( 0 )
 {}
 
 void steppermotor::writeValue(){
   port.write( value );
   port.flush();
+  coilsOn = true;
+  stepped = true;
+  written = true;
 }
 
+void steppermotor::writeCoils(uint8_t coils){
+  port.write( coils );
+  port.flush();
+  coilsOn = coils != 0;
+}
 
-void steppermotor::turnClockwise(){
-  index += 3;
-  if(index > 7){
-    index -= 8;
+void steppermotor::stepClockwise(){
+  index++;
+  if(index >= modeInfo->length){
+    index -= modeInfo->length;
   }
-  value = steps[index];
+  value = modeInfo->sequence[index];
   writeValue();
-  hwlib::wait_ms(2);
 }
 
-void steppermotor::turnCounterClockwise(){
-  index -= 3;
+void steppermotor::stepCounterClockwise(){
+  index--;
   if(index < 0){
-    index += 8;
+    index += modeInfo->length;
   }
-  value = steps[index];
+  value = modeInfo->sequence[index];
   writeValue();
-  hwlib::wait_ms(2);
+}
+
+void steppermotor::turnClockwise(){
+  stepClockwise();
+  clock.wait_us(modeInfo->minStepInterval);
+}
+
+void steppermotor::turnCounterClockwise(){
+  stepCounterClockwise();
+  clock.wait_us(modeInfo->minStepInterval);
 }
 
 void steppermotor::turnClockwise(uint16_t times){
-  while(times >= 3){
+  for(; times > 0; times--){
     turnClockwise();
-    times -= 3;
-    hwlib::wait_ms(2);
-  }
-  if(times > 0){
-    index += times;
-    if(index > 7){
-      index -= 8;
-    }
-    value = steps[index];
-    writeValue();
-    hwlib::wait_ms(2);
   }
 }
 
 void steppermotor::turnCounterClockwise(uint16_t times){
-  while(times >= 3){
+  for(; times > 0; times--){
     turnCounterClockwise();
-    times -= 3;
   }
-  if( times > 0){
-    index -= times;
-    if(index < 0){
-      index += 8;
-    }
-    value = steps[index];
+}
+
+void steppermotor::setDriveMode(driveMode newMode){
+  // the phase the coils are at, as an index in the half step sequence
+  int8_t phase = (index * modeInfo->halfSteps + modeInfo->halfStepOffset) % 8;
+  mode = newMode;
+  modeInfo = &driveModes::info(newMode);
+  index = ((phase - modeInfo->halfStepOffset + 8) % 8) / modeInfo->halfSteps;
+  if(modeInfo->sequence[index] != value){
+    value = modeInfo->sequence[index];
     writeValue();
-    hwlib::wait_ms(2);
+    clock.wait_us(modeInfo->minStepInterval);
+  }
+}
+
+driveMode steppermotor::getDriveMode() const {
+  return mode;
+}
+
+uint8_t steppermotor::halfStepsPerStep() const {
+  return modeInfo->halfSteps;
+}
+
+uint16_t steppermotor::getMinStepInterval() const {
+  return modeInfo->minStepInterval;
+}
+
+void steppermotor::setIdlePolicy(idlePolicy newPolicy, uint32_t newIdleTime, uint8_t dutyPercent, uint32_t newPulsePeriod){
+  policy = newPolicy;
+  idleTime = newIdleTime;
+  pulsePeriod = newPulsePeriod;
+  pulseOn = newPulsePeriod * (dutyPercent > 100 ? 100 : dutyPercent) / 100;
+  pulsing = false;
+}
+
+idlePolicy steppermotor::getIdlePolicy() const {
+  return policy;
+}
+
+void steppermotor::update(uint_fast64_t now){
+  if(updated){
+    if(coilsOn){
+      energizedTime += now - lastUpdate;
+    }
+    measuredTime += now - lastUpdate;
+  }
+  updated = true;
+  lastUpdate = now;
+
+  // a step from an interrupt between checking stepped and writing the coils would be overwritten
+  InterruptLock lock;
+  if(stepped){
+    stepped = false;
+    pulsing = false;
+    lastStep = now;
+    return;
+  }
+  if(!written){
+    return;
+  }
+  if(policy == idlePolicy::hold || now - lastStep < idleTime){
+    if(!coilsOn){
+      writeCoils(value);
+    }
+    return;
+  }
+  if(policy == idlePolicy::release){
+    if(coilsOn){
+      writeCoils(0);
+    }
+    return;
+  }
+
+  // every pulse period starts with the coils off
+  if(!pulsing || now - pulseStart >= pulsePeriod){
+    pulsing = true;
+    pulseStart = now;
   }
+  bool on = now - pulseStart >= pulsePeriod - pulseOn;
+  if(on != coilsOn){
+    writeCoils(on ? value : 0);
+  }
+}
+
+bool steppermotor::isEnergized() const {
+  return coilsOn;
+}
+
+uint_fast64_t steppermotor::getEnergizedTime() const {
+  return energizedTime;
+}
+
+uint_fast64_t steppermotor::getMeasuredTime() const {
+  return measuredTime;
+}
+
+void steppermotor::resetEnergizedTime(){
+  energizedTime = 0;
+  measuredTime = 0;
 }
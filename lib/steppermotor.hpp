@@ -7,57 +7,164 @@
 #define STEPPERMOTOR_HPP
 
 #include "hwlib.hpp"
+#include "clock.hpp"
 
 /// @file
 
-/// Library for implementing a steppermotor with 4 input pins and 8 steps through a hwlib::port_out.
+/// The ways the 4 coils of a steppermotor can be driven.
+enum class driveMode : uint8_t {
+  /// One coil at a time. Uses the least current, but also gives the least torque.
+  wave,
+
+  /// Two neighbouring coils at a time. Steps as large as wave, with about 40% more torque, so the motor can go faster.
+  fullStep,
+
+  /// Alternately one and two coils. Steps half as large as the other modes, for fine positioning and holding.
+  halfStep
+};
+
+/// What a steppermotor does with its coils while it isn't stepping.
+enum class idlePolicy : uint8_t {
+  /// Keeps the coils of the last step energized, so the motor holds its position with full torque. Uses the most power.
+  hold,
+
+  /// Switches the coils off. Uses no power and keeps the motor cool, but nothing holds it, so a load can turn it.
+  release,
+
+  /// Energizes the coils of the last step during part of every period. Holds with less torque than hold, for less power.
+  pulse
+};
+
+/// The step sequences of the drive modes and the speeds the 28BYJ-48 follows in them, known at compile time.
+namespace driveModes {
+  /// The coils energized by every step of a drive mode, as written to the port.
+  constexpr uint8_t WAVE[4] =      {1, 2, 4, 8};
+  constexpr uint8_t FULL_STEP[4] = {3, 6, 12, 9};
+  constexpr uint8_t HALF_STEP[8] = {1, 3, 2, 6, 4, 12, 8, 9};
+
+  /// Everything steppermotor needs to know about a drive mode.
+  struct modeInfo {
+    /// The step sequence, clockwise.
+    const uint8_t *sequence;
+
+    /// The amount of steps in the sequence.
+    uint8_t length;
+
+    /// The amount of half steps every step of the sequence moves.
+    uint8_t halfSteps;
+
+    /// The index in HALF_STEP of the first step of the sequence.
+    uint8_t halfStepOffset;
+
+    /// The shortest time in microseconds between two steps the motor follows without losing any, at 5V.
+    uint16_t minStepInterval;
+  };
+
+  /// The modes, in the order of driveMode.
+  constexpr modeInfo MODES[3] = {
+    {WAVE,      4, 2, 0, 1400},
+    {FULL_STEP, 4, 2, 1, 1000},
+    {HALF_STEP, 8, 1, 0, 650}
+  };
+
+  /// Returns the description of a drive mode.
+  constexpr const modeInfo & info(driveMode mode){
+    return MODES[static_cast<uint8_t>(mode)];
+  }
+}
+
+/// Library for implementing a steppermotor with 4 input pins through a hwlib::port_out.
 ///
 /// This library contains functions to write values to the hwlib::port_out and turn the steppermotor
 /// in either clockwise or counterclockwise direction. The rotations can be done in any given increment in steps.
-/// The default is three if no amount of steps is given, because this is the biggest single step a 4 input, 8 step steppermotor can make.
+/// The coils are driven in one of the modes of driveMode, half steps unless setDriveMode says otherwise.
+/// A step is one step of the sequence of that mode, so a full step is two half steps.
 /// There are two other rotation functions which turn the motors a given number of degrees.
 class steppermotor {
 private:
   /// A port consisting of 4 output pins.
   hwlib::port_out &port;
 
-  /// An index variable used to select a step from the steps array.
+  /// The clock used to wait between steps.
+  Clock &clock;
+
+  /// An index variable used to select a step from the sequence of the drive mode.
   int8_t index;
 
   /// An unsigned integer value to which a step can be assigned to a step and to be written to the hwlib::port_out.
-  uint8_t value;
+  /// Volatile like the flags below, because a step interrupt writes it while update reads it.
+  volatile uint8_t value;
 
-  /// An array containing the 4 bit values of all 8 possible steps of a 4pin/4coil steppermotor.
-  uint8_t steps[8];
+  /// The drive mode and its description.
+  driveMode mode;
+  const driveModes::modeInfo *modeInfo;
 
+  /// The idle policy and its timing in microseconds.
+  idlePolicy policy;
+  uint32_t idleTime;
+  uint32_t pulseOn;
+  uint32_t pulsePeriod;
+
+  /// Whether a step has been written since the last update, and whether one has ever been written.
+  volatile bool stepped;
+  volatile bool written;
+
+  /// Whether the coils are energized, and whether they're being pulsed.
+  volatile bool coilsOn;
+  bool pulsing;
+
+  /// Whether update has been called before.
+  bool updated;
+
+  /// The time of the last step and the start of the current pulse period, as seen by update.
+  uint_fast64_t lastStep;
+  uint_fast64_t pulseStart;
+
+  /// The time of the last update, the time the coils were on since the measurement started and the length of the measurement.
+  uint_fast64_t lastUpdate;
+  uint_fast64_t energizedTime;
+  uint_fast64_t measuredTime;
+
+  /// Writes to the coils without it counting as a step.
+  void writeCoils(uint8_t coils);
 
 public:
   /// Constructor
   ///
-  /// Constructs a steppermotor object out of the given hwlib::port_out.
-  steppermotor(hwlib::port_out & port);
+  /// Constructs a steppermotor object out of the given hwlib::port_out and the Clock to wait on,
+  /// which defaults to the real time of hwlib.
+  steppermotor(hwlib::port_out & port, Clock & clock = hwlibClock());
 
   /// Writes a value to the hwlib::port_out.
   ///
   /// Writes the value-variable to the hwlib::port_out buffer and flushes the port with the buffer.
+  /// Energizes the coils when the idle policy had switched them off.
   virtual void writeValue();
 
-  /// Turns the motor 3 steps in clockwise direction.
+  /// Turns the motor 1 step in clockwise direction without waiting.
+  ///
+  /// Changes the value-variable to the next step in clockwise direction and applies this to the motor
+  /// using the writeValue function. Returns immediately, so the caller is responsible for not calling
+  /// this function faster than the motor can follow. Used by StepperEngine, which takes care of the timing.
+  virtual void stepClockwise();
+
+  /// Turns the motor 1 step in counterclockwise direction without waiting.
   ///
-  /// Changes the value-variable to the third step in clockwise direction from the current step and applies this to the
-  /// motor using the writeValue function.
-  /// It is advised to not use this function in an otherwise (nearly) empty loop without additional waiting.
-  /// This will cause the steppermotor to not turn at all due to a too high input speed.
-  /// Use the version with built in loop instead.
+  /// Changes the value-variable to the next step in counterclockwise direction and applies this to the motor
+  /// using the writeValue function. Returns immediately, so the caller is responsible for not calling
+  /// this function faster than the motor can follow. Used by StepperEngine, which takes care of the timing.
+  virtual void stepCounterClockwise();
+
+  /// Turns the motor 1 step in clockwise direction and waits until it has followed.
+  ///
+  /// Takes a step like stepClockwise and waits the shortest step interval of the drive mode,
+  /// so calling it in a loop turns the motor as fast as it can in that mode.
   virtual void turnClockwise();
 
-  /// Turns the motor 3 steps in counterclockwise direction.
+  /// Turns the motor 1 step in counterclockwise direction and waits until it has followed.
   ///
-  /// Changes the value-variable to the third step in counterclockwise direction from the current step in the array and applies this to the
-  /// motor using the writeValue function.
-  /// It is advised to not use this function in an otherwise (nearly) empty loop without additional waiting.
-  /// This will cause the steppermotor to not turn at all due to a too high input speed.
-  /// Use the version with built in loop instead.
+  /// Takes a step like stepCounterClockwise and waits the shortest step interval of the drive mode,
+  /// so calling it in a loop turns the motor as fast as it can in that mode.
   virtual void turnCounterClockwise();
 
   /// Turns the motor 'times' steps in clockwise direction.
@@ -70,6 +177,59 @@ public:
   /// Takes a given amount of steps in counterclockwise direction using the same methods as the other turnClockwise function.
   virtual void turnCounterClockwise(uint16_t times);
 
+  /// Changes the way the coils are driven.
+  ///
+  /// wave and fullStep only use every other phase of halfStep. When the coils are at a phase the new mode doesn't
+  /// use, the motor moves half a step counterclockwise to the nearest one it does use, and the function waits until
+  /// it has followed.
+  /// Changes the size of a step, so positions counted in steps, like those of a StepperEngine, change meaning too.
+  void setDriveMode(driveMode newMode);
+
+  /// Returns the way the coils are driven.
+  driveMode getDriveMode() const;
+
+  /// Returns the amount of half steps one step moves in the current drive mode.
+  uint8_t halfStepsPerStep() const;
+
+  /// Returns the shortest time in microseconds between two steps in the current drive mode.
+  ///
+  /// This is the interval the blocking turn functions wait, and a sensible lower bound for the step interval
+  /// of a StepperEngine or StepScheduler.
+  uint16_t getMinStepInterval() const;
+
+  /// Sets what happens to the coils when the motor hasn't stepped for idleTime microseconds.
+  ///
+  /// With idlePolicy::pulse the coils are energized dutyPercent of every pulsePeriod microseconds.
+  /// The next step energizes the coils again, at the phase after the one the motor stopped at.
+  /// The policy is applied by update, so it only works when something calls update regularly.
+  void setIdlePolicy(idlePolicy newPolicy, uint32_t idleTime = 100000, uint8_t dutyPercent = 25, uint32_t pulsePeriod = 2000);
+
+  /// Returns the idle policy.
+  idlePolicy getIdlePolicy() const;
+
+  /// Applies the idle policy and measures how long the coils are energized.
+  ///
+  /// now is the current time in microseconds, normally hwlib::now_us(). StepperEngine and MotionGroup call this
+  /// every time they're polled. When the motor is stepped from an interrupt, like by a StepScheduler, call it from
+  /// the main loop: it masks interrupts while it decides what to write to the coils, so it never overwrites a step.
+  /// Steps are timed by the first update after them, so the idle time and the energized time are only as accurate
+  /// as the interval between calls.
+  void update(uint_fast64_t now);
+
+  /// Returns whether the coils are energized.
+  bool isEnergized() const;
+
+  /// Returns how many microseconds the coils were energized since the first update or resetEnergizedTime.
+  uint_fast64_t getEnergizedTime() const;
+
+  /// Returns how many microseconds passed since the first update or resetEnergizedTime.
+  ///
+  /// getEnergizedTime divided by this is the fraction of the time the motor draws current.
+  uint_fast64_t getMeasuredTime() const;
+
+  /// Starts measuring the energized time over.
+  void resetEnergizedTime();
+
 };
 
 #endif
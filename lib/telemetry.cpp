@@ -0,0 +1,242 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "telemetry.hpp"
+
+namespace {
+  void putWord(uint8_t *data, uint16_t value){
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+  }
+
+  uint16_t getWord(const uint8_t *data){
+    return data[0] | data[1] << 8;
+  }
+
+  int16_t clip(float value){
+    if(value > 32767){ return 32767; }
+    if(value < -32768){ return -32768; }
+    return static_cast<int16_t>(value);
+  }
+}
+
+uint16_t telemetryFormat::crc16(const uint8_t data[], size_t n){
+  // a table for 4 bits at a time, small enough for flash and about twice as fast as going bit by bit
+  static const uint16_t table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+  };
+  uint16_t crc = 0xFFFF;
+  for(size_t i = 0; i < n; i++){
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+    crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+  }
+  return crc;
+}
+
+size_t telemetryFormat::encode(const uint8_t data[], size_t n, uint8_t out[]){
+  // every block starts with a code: one more than the amount of non-zero bytes that follow it
+  size_t codeIndex = 0;
+  size_t written = 1;
+  uint8_t code = 1;
+  for(size_t i = 0; i < n; i++){
+    if(data[i] != 0){
+      out[written++] = data[i];
+      code++;
+    }
+    if(data[i] == 0 || code == 0xFF){
+      out[codeIndex] = code;
+      codeIndex = written++;
+      code = 1;
+    }
+  }
+  out[codeIndex] = code;
+  out[written++] = 0;
+  return written;
+}
+
+size_t telemetryFormat::decode(const uint8_t frame[], size_t n, uint8_t out[]){
+  size_t i = 0;
+  size_t decoded = 0;
+  while(i < n){
+    uint8_t code = frame[i++];
+    if(code == 0){
+      return 0;
+    }
+    for(uint8_t j = 1; j < code; j++){
+      if(i >= n || frame[i] == 0){
+        return 0;
+      }
+      out[decoded++] = frame[i++];
+    }
+    // a block shorter than the maximum was ended by a zero, except the last one
+    if(code != 0xFF && i < n){
+      out[decoded++] = 0;
+    }
+  }
+  return decoded;
+}
+
+bool TelemetryMessage::decodeLoop(TelemetryLoop & loop) const {
+  if(type != TELEMETRY_LOOP || length != telemetryFormat::LOOP_PAYLOAD){
+    return false;
+  }
+  int16_t *fields[10] = {
+    &loop.accX, &loop.accY, &loop.accZ, &loop.gyroX, &loop.gyroY, &loop.gyroZ,
+    &loop.roll, &loop.pitch, &loop.pitchSpeed, &loop.rollSpeed
+  };
+  for(int i = 0; i < 10; i++){
+    *fields[i] = static_cast<int16_t>(getWord(payload + 2 * i));
+  }
+  return true;
+}
+
+Telemetry::Telemetry(uint8_t storage[], size_t capacity):
+  storage( storage ),
+  capacity( capacity ),
+  head( 0 ),
+  count( 0 ),
+  sending( 0 ),
+  sequence( 0 ),
+  sentPackets( 0 ),
+  droppedPackets( 0 )
+{
+  // a zero ends whatever the receiver had before, so it doesn't miss the first packet
+  if(capacity > 0){
+    storage[0] = 0;
+    count = 1;
+  }
+}
+
+void Telemetry::enqueue(const uint8_t data[], size_t n){
+  size_t tail = head + count;
+  if(tail >= capacity){
+    tail -= capacity;
+  }
+  for(size_t i = 0; i < n; i++){
+    storage[tail] = data[i];
+    tail++;
+    if(tail == capacity){
+      tail = 0;
+    }
+  }
+  count += n;
+}
+
+size_t Telemetry::contiguous(const uint8_t *& data) const {
+  if(count == 0){
+    return 0;
+  }
+  data = storage + head;
+  return capacity - head < count ? capacity - head : count;
+}
+
+bool Telemetry::send(uint8_t type, uint32_t time, const uint8_t payload[], size_t n){
+  if(n > telemetryFormat::MAX_PAYLOAD){
+    n = telemetryFormat::MAX_PAYLOAD;
+  }
+  uint8_t packet[telemetryFormat::MAX_PACKET];
+  packet[0] = type;
+  putWord(packet + 1, sequence);
+  putWord(packet + 3, time & 0xFFFF);
+  putWord(packet + 5, time >> 16);
+  for(size_t i = 0; i < n; i++){
+    packet[telemetryFormat::HEADER_SIZE + i] = payload[i];
+  }
+  size_t length = telemetryFormat::HEADER_SIZE + n;
+  putWord(packet + length, telemetryFormat::crc16(packet, length));
+  length += telemetryFormat::CRC_SIZE;
+  // the sequence number counts dropped packets too, so the receiver sees the gap
+  sequence++;
+
+  uint8_t frame[telemetryFormat::MAX_FRAME];
+  size_t frameLength = telemetryFormat::encode(packet, length, frame);
+  if(capacity - count < frameLength){
+    droppedPackets++;
+    return false;
+  }
+  enqueue(frame, frameLength);
+  sentPackets++;
+  return true;
+}
+
+bool Telemetry::sendLoop(uint32_t time, const Mpu6050Sample & sample, float roll, float pitch, int32_t pitchSpeed, int32_t rollSpeed){
+  const int16_t fields[10] = {
+    sample.accX, sample.accY, sample.accZ, sample.gyroX, sample.gyroY, sample.gyroZ,
+    clip(roll * 100), clip(pitch * 100), clip(pitchSpeed), clip(rollSpeed)
+  };
+  uint8_t payload[telemetryFormat::LOOP_PAYLOAD];
+  for(int i = 0; i < 10; i++){
+    putWord(payload + 2 * i, static_cast<uint16_t>(fields[i]));
+  }
+  return send(TELEMETRY_LOOP, time, payload, telemetryFormat::LOOP_PAYLOAD);
+}
+
+size_t Telemetry::size() const {
+  return count;
+}
+
+uint32_t Telemetry::sent() const {
+  return sentPackets;
+}
+
+uint32_t Telemetry::dropped() const {
+  return droppedPackets;
+}
+
+TelemetryReader::TelemetryReader():
+  filled( 0 ),
+  synced( false ),
+  overflow( false ),
+  expected( 0 ),
+  started( false ),
+  received( 0 ),
+  lost( 0 ),
+  corrupted( 0 )
+{}
+
+TelemetryReader::result TelemetryReader::feed(uint8_t byte, TelemetryMessage & message){
+  if(byte != 0){
+    if(filled < sizeof(frame)){
+      frame[filled++] = byte;
+    }else{
+      overflow = true;
+    }
+    return result::nothing;
+  }
+  size_t n = filled;
+  bool wasSynced = synced;
+  bool tooLong = overflow;
+  filled = 0;
+  synced = true;
+  overflow = false;
+  if(!wasSynced || n == 0){
+    return result::nothing;
+  }
+
+  uint8_t packet[telemetryFormat::MAX_FRAME];
+  size_t length = tooLong ? 0 : telemetryFormat::decode(frame, n, packet);
+  if(length < telemetryFormat::HEADER_SIZE + telemetryFormat::CRC_SIZE
+    || length > telemetryFormat::MAX_PACKET
+    || telemetryFormat::crc16(packet, length - telemetryFormat::CRC_SIZE) != getWord(packet + length - telemetryFormat::CRC_SIZE))
+  {
+    corrupted++;
+    return result::error;
+  }
+  message.type = packet[0];
+  message.sequence = getWord(packet + 1);
+  message.time = getWord(packet + 3) | static_cast<uint32_t>(getWord(packet + 5)) << 16;
+  message.length = length - telemetryFormat::HEADER_SIZE - telemetryFormat::CRC_SIZE;
+  for(size_t i = 0; i < message.length; i++){
+    message.payload[i] = packet[telemetryFormat::HEADER_SIZE + i];
+  }
+  if(started){
+    lost += static_cast<uint16_t>(message.sequence - expected);
+  }
+  expected = message.sequence + 1;
+  started = true;
+  received++;
+  return result::packet;
+}
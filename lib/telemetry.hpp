@@ -0,0 +1,236 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sampleBuffer.hpp"
+
+/// @file
+
+/// The kinds of packets the lib sends with Telemetry. Applications can use USER and up for their own.
+enum telemetryPacket : uint8_t {
+  /// One pass of the control loop: the sample, the estimated attitude and the step rates, see TelemetryLoop.
+  TELEMETRY_LOOP = 1,
+  /// The first type free for applications.
+  TELEMETRY_USER = 128
+};
+
+/// The binary format of a telemetry packet, all numbers little endian:
+///
+///   uint8 type, uint16 sequence, uint32 time in microseconds    header
+///   up to MAX_PAYLOAD bytes                                      payload, depending on the type
+///   uint16 CRC-16/CCITT of the header and the payload
+///
+/// Every packet is COBS encoded, so it contains no zero bytes, and followed by a zero byte, which marks its end.
+/// A receiver that starts listening halfway, or loses bytes, finds the start of the next packet at the next zero.
+/// The sequence number counts every packet, sent or dropped, so gaps show how many were lost.
+namespace telemetryFormat {
+  const size_t HEADER_SIZE = 7;
+  const size_t CRC_SIZE = 2;
+  const size_t MAX_PAYLOAD = 32;
+  const size_t MAX_PACKET = HEADER_SIZE + MAX_PAYLOAD + CRC_SIZE;
+
+  /// The size of a COBS encoded packet of n bytes, including the zero at its end.
+  constexpr size_t frameSize(size_t n){
+    return n + n / 254 + 2;
+  }
+
+  const size_t MAX_FRAME = frameSize(MAX_PACKET);
+
+  /// The payload of a TELEMETRY_LOOP packet: 6 int16 raw sample values, 2 int16 angles, 2 int16 step rates.
+  const size_t LOOP_PAYLOAD = 20;
+
+  /// Returns the CRC-16/CCITT (polynomial 0x1021, starting at 0xFFFF) of n bytes.
+  uint16_t crc16(const uint8_t data[], size_t n);
+
+  /// COBS encodes n bytes into out, which has room for frameSize(n) bytes, and adds the zero that ends the frame.
+  ///
+  /// Returns the amount of bytes written.
+  size_t encode(const uint8_t data[], size_t n, uint8_t out[]);
+
+  /// Decodes a COBS encoded frame of n bytes, without its ending zero, into out.
+  ///
+  /// Returns the amount of bytes decoded, or 0 when the frame isn't valid COBS.
+  size_t decode(const uint8_t frame[], size_t n, uint8_t out[]);
+}
+
+/// What a TELEMETRY_LOOP packet holds.
+struct TelemetryLoop {
+  /// The sample the loop used, without the temperature.
+  int16_t accX;
+  int16_t accY;
+  int16_t accZ;
+  int16_t gyroX;
+  int16_t gyroY;
+  int16_t gyroZ;
+
+  /// The estimated attitude in hundredths of degrees.
+  int16_t roll;
+  int16_t pitch;
+
+  /// The step rates given to the motors in steps per second.
+  int16_t pitchSpeed;
+  int16_t rollSpeed;
+};
+
+/// A received packet.
+struct TelemetryMessage {
+  uint8_t type;
+  uint16_t sequence;
+
+  /// The time the packet was sent, in microseconds, wrapping around every 71 minutes.
+  uint32_t time;
+
+  uint8_t payload[telemetryFormat::MAX_PAYLOAD];
+  size_t length;
+
+  /// Fills loop from the payload, returns false when this isn't a TELEMETRY_LOOP packet.
+  bool decodeLoop(TelemetryLoop & loop) const;
+};
+
+/// Streams packets out of the control loop without ever waiting for the serial port.
+///
+/// send encodes a packet and queues it in a ring buffer, in memory supplied by the caller like TraceBuffer does.
+/// drain hands the queued bytes to a port that sends them in the background, like DueUartTx does with the PDC,
+/// and returns right away. Neither waits, so streaming doesn't change the timing of the loop: when the port
+/// can't keep up the ring fills, and packets that don't fit are dropped whole and counted, instead of stalling.
+///
+///   uint8_t storage[4096];
+///   auto telemetry = Telemetry( storage, sizeof( storage ) );
+///   auto uart = DueUartTx( 400000 );
+///   for(;;){
+///     ...
+///     telemetry.send( TELEMETRY_USER, now, payload, n );
+///     telemetry.drain( uart );
+///   }
+///
+/// The telemetryrecorder project records the packets on a PC and reports the lost ones.
+/// Only send from one context, the main loop or a single interrupt, and drain from the same one.
+class Telemetry {
+private:
+  uint8_t *storage;
+  size_t capacity;
+
+  /// The index of the oldest queued byte.
+  size_t head;
+
+  /// The amount of queued bytes, including the ones the port is sending.
+  size_t count;
+
+  /// The amount of bytes at head the port is sending.
+  size_t sending;
+
+  /// The sequence number of the next packet.
+  uint16_t sequence;
+
+  /// The amount of packets sent and dropped since construction.
+  uint32_t sentPackets;
+  uint32_t droppedPackets;
+
+  /// Copies n bytes to the back of the ring, which has room for them.
+  void enqueue(const uint8_t data[], size_t n);
+
+  /// Returns the length of the run of queued bytes at head that doesn't wrap around, and sets data to its start.
+  size_t contiguous(const uint8_t *& data) const;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a Telemetry that queues at most capacity bytes in storage, starting with a zero.
+  Telemetry(uint8_t storage[], size_t capacity);
+
+  /// Queues a packet of the given type with a payload of n bytes, at most MAX_PAYLOAD.
+  ///
+  /// time is the moment the payload belongs to in microseconds. Returns false when the packet didn't fit and was dropped.
+  bool send(uint8_t type, uint32_t time, const uint8_t payload[], size_t n);
+
+  /// Queues a TELEMETRY_LOOP packet. roll and pitch are in degrees, the step rates are limited to what fits in an int16.
+  bool sendLoop(uint32_t time, const Mpu6050Sample & sample, float roll, float pitch, int32_t pitchSpeed, int32_t rollSpeed);
+
+  /// Gives the port the next queued bytes when it's done with the previous ones.
+  ///
+  /// port is anything with a bool busy() that tells whether it's still sending, and a send(data, n) that starts
+  /// sending n bytes in the background. The bytes stay in the ring, untouched, until the port is done with them.
+  /// Call this as often as possible, it returns right away.
+  template< typename Port >
+  void drain(Port & port){
+    if(sending > 0){
+      if(port.busy()){
+        return;
+      }
+      head += sending;
+      if(head >= capacity){
+        head -= capacity;
+      }
+      count -= sending;
+      sending = 0;
+    }
+    const uint8_t *data;
+    size_t n = contiguous(data);
+    if(n > 0){
+      sending = n;
+      port.send(data, n);
+    }
+  }
+
+  /// Returns the amount of bytes queued, including the ones the port is sending.
+  size_t size() const;
+
+  /// Returns the amount of packets queued since construction.
+  uint32_t sent() const;
+
+  /// Returns the amount of packets dropped since construction because the ring was full.
+  uint32_t dropped() const;
+};
+
+/// Turns a stream of telemetry bytes back into packets, one byte at a time.
+///
+/// Skips everything before the first zero, like text printed with hwlib::cout, and counts what goes wrong after it.
+class TelemetryReader {
+public:
+  /// What the last byte completed.
+  enum class result { nothing, packet, error };
+
+private:
+  /// The bytes of the frame coming in.
+  uint8_t frame[telemetryFormat::MAX_FRAME];
+  size_t filled;
+
+  /// Whether a zero has been seen, so the next byte starts a frame.
+  bool synced;
+
+  /// Whether the frame coming in is already too long.
+  bool overflow;
+
+  /// The sequence number expected next, once a packet has been received.
+  uint16_t expected;
+  bool started;
+
+public:
+  /// The amount of good packets received.
+  uint32_t received;
+
+  /// The amount of packets missing between the good ones, according to their sequence numbers.
+  uint32_t lost;
+
+  /// The amount of frames that weren't valid packets, because of a wrong CRC, length or encoding.
+  uint32_t corrupted;
+
+  /// Constructor
+  ///
+  /// Constructs a TelemetryReader that waits for the first zero.
+  TelemetryReader();
+
+  /// Reads one byte.
+  ///
+  /// Returns packet when a good packet is complete, which is then stored in message, and error when a frame ended
+  /// that wasn't a good packet.
+  result feed(uint8_t byte, TelemetryMessage & message);
+};
+
+#endif
@@ -0,0 +1,120 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "traceBuffer.hpp"
+
+const char * traceEventName(uint8_t id){
+  switch(id){
+    case TRACE_LOOP_TICK:       return "loopTick";
+    case TRACE_SENSOR_READ:     return "sensorRead";
+    case TRACE_ATTITUDE:        return "attitude";
+    case TRACE_PITCH_COMMAND:   return "pitchCommand";
+    case TRACE_ROLL_COMMAND:    return "rollCommand";
+    case TRACE_PITCH_STEP_LOSS: return "pitchStepLoss";
+    case TRACE_ROLL_STEP_LOSS:  return "rollStepLoss";
+    default:                    return nullptr;
+  }
+}
+
+TraceBuffer::TraceBuffer(TraceEvent storage[], size_t capacity, timeSource timestamp, uint32_t clockHz):
+  storage( storage ),
+  mask( 0 ),
+  timestamp( timestamp ),
+  clockHz( clockHz ),
+  recorded( 0 ),
+  enabled( true )
+{
+  size_t size = 1;
+  while(size * 2 <= capacity){
+    size *= 2;
+  }
+  mask = size - 1;
+}
+
+void TraceBuffer::enable(bool on){
+  enabled = on;
+}
+
+void TraceBuffer::clear(){
+  recorded = 0;
+}
+
+size_t TraceBuffer::size() const {
+  return recorded > mask ? mask + 1 : recorded;
+}
+
+uint32_t TraceBuffer::lost() const {
+  return recorded - size();
+}
+
+const TraceEvent & TraceBuffer::operator[](size_t i) const {
+  return storage[(recorded - size() + i) & mask];
+}
+
+TraceReader::TraceReader():
+  clockHz( 0 ),
+  count( 0 )
+{
+  restart();
+}
+
+void TraceReader::restart(){
+  current = state::magic;
+  filled = 0;
+  remaining = 0;
+  sum = 0;
+}
+
+TraceReader::result TraceReader::feed(uint8_t byte, TraceEvent & e){
+  switch(current){
+    case state::magic:
+      if(byte == traceFormat::MAGIC[filled]){
+        filled++;
+      }else{
+        filled = byte == traceFormat::MAGIC[0] ? 1 : 0;
+      }
+      if(filled == sizeof(traceFormat::MAGIC)){
+        current = state::header;
+        filled = 0;
+      }
+      return result::nothing;
+
+    case state::header:
+      sum += byte;
+      buffer[filled++] = byte;
+      if(filled == traceFormat::HEADER_SIZE){
+        count = buffer[0] | buffer[1] << 8 | buffer[2] << 16 | static_cast<uint32_t>(buffer[3]) << 24;
+        clockHz = buffer[4] | buffer[5] << 8 | buffer[6] << 16 | static_cast<uint32_t>(buffer[7]) << 24;
+        remaining = count;
+        current = remaining > 0 ? state::events : state::checksum;
+        filled = 0;
+      }
+      return result::nothing;
+
+    case state::events:
+      sum += byte;
+      buffer[filled++] = byte;
+      if(filled < traceFormat::EVENT_SIZE){
+        return result::nothing;
+      }
+      e.timestamp = buffer[0] | buffer[1] << 8 | buffer[2] << 16 | static_cast<uint32_t>(buffer[3]) << 24;
+      e.id = buffer[4];
+      e.payload = buffer[5] | buffer[6] << 8 | buffer[7] << 16 | static_cast<uint32_t>(buffer[8]) << 24;
+      filled = 0;
+      if(--remaining == 0){
+        current = state::checksum;
+      }
+      return result::event;
+
+    default:
+      buffer[filled++] = byte;
+      if(filled < 2){
+        return result::nothing;
+      }
+      bool right = (buffer[0] | buffer[1] << 8) == sum;
+      restart();
+      return right ? result::done : result::error;
+  }
+}
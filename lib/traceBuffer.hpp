@@ -0,0 +1,198 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef TRACEBUFFER_HPP
+#define TRACEBUFFER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cycleCounter.hpp"
+
+/// @file
+
+/// The kinds of events the lib records in a TraceBuffer. Applications can use USER and up for their own.
+enum traceEvent : uint8_t {
+  /// The control loop used a sample. Payload: the time since the previous sample in microseconds.
+  TRACE_LOOP_TICK =       1,
+  /// A sample was read. Payload: gyroX in the high and gyroY in the low 16 bits, raw.
+  TRACE_SENSOR_READ =     2,
+  /// The attitude was estimated. Payload: roll in the high and pitch in the low 16 bits, in hundredths of degrees.
+  TRACE_ATTITUDE =        3,
+  /// The pitch motor was given a speed. Payload: the speed in steps per second, signed.
+  TRACE_PITCH_COMMAND =   4,
+  /// The roll motor was given a speed. Payload: the speed in steps per second, signed.
+  TRACE_ROLL_COMMAND =    5,
+  /// The pitch motor lost steps. Payload: the speed limit it got instead, in steps per second.
+  TRACE_PITCH_STEP_LOSS = 6,
+  /// The roll motor lost steps. Payload: the speed limit it got instead, in steps per second.
+  TRACE_ROLL_STEP_LOSS =  7,
+  /// The first id free for applications.
+  TRACE_USER =            128
+};
+
+/// Returns the name of an event id, or nullptr for ids the lib doesn't use.
+const char * traceEventName(uint8_t id);
+
+/// One recorded event.
+struct TraceEvent {
+  /// The time of the event, in cycles of the clock given to the TraceBuffer.
+  uint32_t timestamp;
+
+  /// What the payload means depends on the id.
+  uint32_t payload;
+
+  /// What happened, one of traceEvent.
+  uint8_t id;
+};
+
+/// The binary format TraceBuffer::dump writes and TraceReader reads, all numbers little endian:
+///
+///   'T' 'R' 'C' '1'                       magic
+///   uint32 count, uint32 clock in Hz      header
+///   count times: uint32 timestamp, uint8 id, uint32 payload
+///   uint16 sum of every byte after the magic
+namespace traceFormat {
+  const uint8_t MAGIC[4] = {'T', 'R', 'C', '1'};
+  const size_t HEADER_SIZE = 8;
+  const size_t EVENT_SIZE = 9;
+}
+
+/// A flight recorder for the hot path: a ring buffer of the most recent TraceEvents.
+///
+/// record is inline and only stores three words, so it costs a handful of cycles and can stay in
+/// production code, unlike printing with hwlib::cout. When the buffer is full the oldest events are overwritten,
+/// so it always holds what happened just before something went wrong. dump sends it out in a compact
+/// binary format, which the tracedecoder project turns back into text on a PC.
+///
+/// Like Mpu6050SampleBuffer the memory is supplied by the caller. The capacity has to be a power of two.
+/// Timestamps come from the cycle counter by default, which has to be enabled with cycleCounter::enable.
+/// Only record from one context, the main loop or a single interrupt.
+class TraceBuffer {
+public:
+  /// The type of the function that supplies timestamps.
+  typedef uint32_t (*timeSource)();
+
+private:
+  TraceEvent *storage;
+  uint32_t mask;
+  timeSource timestamp;
+  uint32_t clockHz;
+
+  /// The amount of events recorded since construction or the last clear, of which the last capacity are kept.
+  uint32_t recorded;
+
+  /// Whether recording is on.
+  bool enabled;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs an empty TraceBuffer that keeps the last capacity events in storage, with timestamps from the
+  /// given function, which counts at clockHz. capacity is rounded down to a power of two.
+  TraceBuffer(TraceEvent storage[], size_t capacity, timeSource timestamp = cycleCounter::now, uint32_t clockHz = 84000000);
+
+  /// Records an event with the current time.
+  void record(uint8_t id, uint32_t payload = 0){
+    if(!enabled){
+      return;
+    }
+    TraceEvent & e = storage[recorded & mask];
+    e.timestamp = timestamp();
+    e.payload = payload;
+    e.id = id;
+    recorded++;
+  }
+
+  /// Turns recording on or off, for example to freeze the buffer after something went wrong.
+  void enable(bool on);
+
+  /// Forgets all events.
+  void clear();
+
+  /// Returns the amount of events in the buffer.
+  size_t size() const;
+
+  /// Returns the amount of events that were overwritten before they were dumped.
+  uint32_t lost() const;
+
+  /// Returns the i'th event in the buffer, 0 being the oldest.
+  const TraceEvent & operator[](size_t i) const;
+
+  /// Writes every event in the buffer, oldest first, in the traceFormat, one byte at a time to put.
+  ///
+  /// put is anything that can be called with a uint8_t, like a function writing to the UART.
+  /// Recording is paused during the dump so the events don't change underneath it.
+  template< typename Sink >
+  void dump(Sink put){
+    bool wasEnabled = enabled;
+    enabled = false;
+    uint16_t sum = 0;
+    auto byte = [&](uint8_t b){
+      put(b);
+      sum += b;
+    };
+    auto word = [&](uint32_t w){
+      for(int i = 0; i < 4; i++){
+        byte(w >> (8 * i));
+      }
+    };
+    for(uint8_t b : traceFormat::MAGIC){
+      put(b);
+    }
+    word(size());
+    word(clockHz);
+    for(size_t i = 0; i < size(); i++){
+      const TraceEvent & e = (*this)[i];
+      word(e.timestamp);
+      byte(e.id);
+      word(e.payload);
+    }
+    put(sum & 0xFF);
+    put(sum >> 8);
+    enabled = wasEnabled;
+  }
+};
+
+/// Turns the bytes written by TraceBuffer::dump back into TraceEvents, one byte at a time.
+///
+/// Skips everything before the magic, so it can read straight from a serial port that also carries text.
+class TraceReader {
+public:
+  /// What the last byte completed.
+  enum class result { nothing, event, done, error };
+
+private:
+  enum class state { magic, header, events, checksum };
+  state current;
+  /// Holds the header or an event until all its bytes are in, so it fits the larger of both.
+  uint8_t buffer[traceFormat::EVENT_SIZE > traceFormat::HEADER_SIZE ? traceFormat::EVENT_SIZE : traceFormat::HEADER_SIZE];
+  static_assert(sizeof(buffer) >= traceFormat::EVENT_SIZE && sizeof(buffer) >= traceFormat::HEADER_SIZE,
+    "TraceReader::buffer must hold a whole header and a whole event");
+  size_t filled;
+  uint32_t remaining;
+  uint16_t sum;
+
+  void restart();
+
+public:
+  /// The clock the timestamps count in, known once the header has been read.
+  uint32_t clockHz;
+
+  /// The amount of events in the dump, known once the header has been read.
+  uint32_t count;
+
+  /// Constructor
+  ///
+  /// Constructs a TraceReader that waits for the magic.
+  TraceReader();
+
+  /// Reads one byte.
+  ///
+  /// Returns event when an event is complete, which is then stored in e, done when the dump is complete and
+  /// its checksum is right, and error when the checksum is wrong. After done or error it waits for the next magic.
+  result feed(uint8_t byte, TraceEvent & e);
+};
+
+#endif
@@ -0,0 +1,297 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "MPU6050.hpp"
+#include "mockI2cBus.hpp"
+
+static void fillMeasurements(mockI2cBus & bus){
+  bus.setWord(0x3B, 1000);
+  bus.setWord(0x3D, -2000);
+  bus.setWord(0x3F, 16384);
+  bus.setWord(0x41, -340);
+  bus.setWord(0x43, 131);
+  bus.setWord(0x45, -262);
+  bus.setWord(0x47, 32767);
+}
+
+TEST_CASE( "readAll returns every measurement in one burst" ){
+  mockI2cBus bus;
+  fillMeasurements(bus);
+  Mpu6050 mpu(bus, 0x68);
+
+  auto sample = mpu.readAll();
+  REQUIRE( sample.accX == 1000 );
+  REQUIRE( sample.accY == -2000 );
+  REQUIRE( sample.accZ == 16384 );
+  REQUIRE( sample.temperature == -340 );
+  REQUIRE( sample.gyroX == 131 );
+  REQUIRE( sample.gyroY == -262 );
+  REQUIRE( sample.gyroZ == 32767 );
+  REQUIRE( bus.lastAddress == 0x68 );
+}
+
+TEST_CASE( "readAll costs two transactions" ){
+  mockI2cBus bus;
+  fillMeasurements(bus);
+  Mpu6050 mpu(bus, 0x68);
+
+  mpu.readAll();
+  REQUIRE( bus.transactions == 2 );
+  REQUIRE( bus.bytesRead == 14 );
+}
+
+TEST_CASE( "readAll agrees with the single register reads, which cost more transactions" ){
+  mockI2cBus bus;
+  fillMeasurements(bus);
+  Mpu6050 mpu(bus, 0x68);
+
+  auto sample = mpu.readAll();
+  bus.reset();
+  REQUIRE( mpu.readAccXRaw() == sample.accX );
+  REQUIRE( mpu.readAccYRaw() == sample.accY );
+  REQUIRE( mpu.readAccZRaw() == sample.accZ );
+  REQUIRE( mpu.readGyroXRaw() == sample.gyroX );
+  REQUIRE( mpu.readGyroYRaw() == sample.gyroY );
+  REQUIRE( mpu.readGyroZRaw() == sample.gyroZ );
+  REQUIRE( bus.transactions > 7 * 2 );
+}
+
+TEST_CASE( "converted reads cost as many transactions as raw reads" ){
+  mockI2cBus bus;
+  fillMeasurements(bus);
+  Mpu6050 mpu(bus, 0x68);
+  mpu.setGyroConfig(1);
+  mpu.setAcceleroConfig(2);
+
+  bus.reset();
+  mpu.readGyroXRaw();
+  auto rawTransactions = bus.transactions;
+  bus.reset();
+  REQUIRE( mpu.readGyroX() == 2 );
+  REQUIRE( bus.transactions == rawTransactions );
+
+  bus.reset();
+  mpu.readAccXRaw();
+  rawTransactions = bus.transactions;
+  bus.reset();
+  REQUIRE( mpu.readAccX() == 1000 * 981 / 4096 );
+  REQUIRE( bus.transactions == rawTransactions );
+}
+
+TEST_CASE( "resyncConfig picks up configuration changed behind the driver's back" ){
+  mockI2cBus bus;
+  fillMeasurements(bus);
+  Mpu6050 mpu(bus, 0x68);
+  mpu.setGyroConfig(0);
+  REQUIRE( mpu.readGyroX() == 1 );
+
+  bus.registers[0x1B] = 3 << 3;
+  REQUIRE( mpu.readGyroX() == 1 );
+
+  bus.reset();
+  mpu.resyncConfig();
+  REQUIRE( bus.transactions == 2 );
+  REQUIRE( mpu.readGyroX() == 7 );
+}
+
+TEST_CASE( "configure writes the rate, filter and ranges in one burst" ){
+  mockI2cBus bus;
+  fillMeasurements(bus);
+  Mpu6050 mpu(bus, 0x68);
+
+  mpu.configure( mpu6050Config::forRate( 200, dlpfBandwidth::hz44, 2, 1 ) );
+  REQUIRE( bus.transactions == 1 );
+  REQUIRE( bus.registers[0x19] == 4 );
+  REQUIRE( bus.registers[0x1A] == 3 );
+  REQUIRE( bus.registers[0x1B] == 1 << 3 );
+  REQUIRE( bus.registers[0x1C] == 2 << 3 );
+  REQUIRE( mpu.samplePeriod() == 5000 );
+  REQUIRE( mpu.filterDelay() == 4900 );
+  // the conversions use the new ranges without reading them back
+  bus.reset();
+  REQUIRE( mpu.readGyroX() == 2 );
+  REQUIRE( mpu.readAccXRaw() == 1000 );
+}
+
+TEST_CASE( "configure replaces invalid settings by 0" ){
+  mockI2cBus bus;
+  Mpu6050 mpu(bus, 0x68);
+
+  mpu.configure( Mpu6050Config{static_cast<dlpfBandwidth>(7), 9, 4, 5} );
+  REQUIRE( bus.registers[0x19] == 9 );
+  REQUIRE( bus.registers[0x1A] == 0 );
+  REQUIRE( bus.registers[0x1B] == 0 );
+  REQUIRE( bus.registers[0x1C] == 0 );
+  REQUIRE( mpu.samplePeriod() == 1250 );
+}
+
+TEST_CASE( "resyncConfig picks up the sample rate divider" ){
+  mockI2cBus bus;
+  Mpu6050 mpu(bus, 0x68);
+  REQUIRE( mpu.samplePeriod() == 125 );
+
+  bus.registers[0x19] = 9;
+  bus.registers[0x1A] = 2;
+  mpu.resyncConfig();
+  auto config = mpu.getConfiguration();
+  REQUIRE( config.rateDivider == 9 );
+  REQUIRE( config.bandwidth == dlpfBandwidth::hz94 );
+  REQUIRE( mpu.samplePeriod() == 10000 );
+}
+
+static Mpu6050Sample numberedSample(int16_t n){
+  return Mpu6050Sample{n, static_cast<int16_t>(-n), 1, 2, 3, 4, static_cast<int16_t>(n * 2)};
+}
+
+TEST_CASE( "readFifo drains complete frames in one burst" ){
+  mockI2cBus bus;
+  Mpu6050 mpu(bus, 0x68);
+  mpu.enableFifo();
+  REQUIRE( bus.registers[0x23] == 0xF8 );
+  for(int16_t i = 0; i < 10; i++){
+    bus.sample(numberedSample(i));
+  }
+  REQUIRE( mpu.readFifoCount() == 140 );
+
+  Mpu6050Sample storage[16];
+  Mpu6050SampleBuffer buffer(storage, 16);
+  bus.reset();
+  REQUIRE( mpu.readFifo(buffer) == 10 );
+  REQUIRE( bus.transactions == 4 );
+  REQUIRE( buffer.size() == 10 );
+  for(int16_t i = 0; i < 10; i++){
+    Mpu6050Sample sample;
+    REQUIRE( buffer.pop(sample) );
+    REQUIRE( sample.accX == i );
+    REQUIRE( sample.accY == -i );
+    REQUIRE( sample.gyroZ == i * 2 );
+  }
+  REQUIRE( mpu.readFifoCount() == 0 );
+}
+
+TEST_CASE( "readFifo leaves frames that don't fit in the buffer in the FIFO" ){
+  mockI2cBus bus;
+  Mpu6050 mpu(bus, 0x68);
+  mpu.enableFifo();
+  for(int16_t i = 0; i < 6; i++){
+    bus.sample(numberedSample(i));
+  }
+
+  Mpu6050Sample storage[4];
+  Mpu6050SampleBuffer buffer(storage, 4);
+  REQUIRE( mpu.readFifo(buffer, 3) == 3 );
+  REQUIRE( mpu.readFifo(buffer) == 1 );
+  REQUIRE( buffer.space() == 0 );
+  REQUIRE( mpu.readFifoCount() == 2 * 14 );
+
+  Mpu6050Sample sample;
+  buffer.clear();
+  REQUIRE( mpu.readFifo(buffer) == 2 );
+  REQUIRE( buffer.pop(sample) );
+  REQUIRE( sample.accX == 4 );
+}
+
+TEST_CASE( "readFifo detects an overflowed FIFO and starts over" ){
+  mockI2cBus bus;
+  Mpu6050 mpu(bus, 0x68);
+  mpu.enableFifo();
+  for(int16_t i = 0; i < 80; i++){
+    bus.sample(numberedSample(i));
+  }
+
+  Mpu6050Sample storage[8];
+  Mpu6050SampleBuffer buffer(storage, 8);
+  REQUIRE( mpu.readFifo(buffer) == 0 );
+  REQUIRE( mpu.readFifoOverflows() == 1 );
+  REQUIRE( mpu.readFifoCount() == 0 );
+
+  bus.sample(numberedSample(7));
+  REQUIRE( mpu.readFifo(buffer) == 1 );
+  REQUIRE( mpu.readFifoOverflows() == 1 );
+}
+
+TEST_CASE( "disableFifo stops buffering" ){
+  mockI2cBus bus;
+  Mpu6050 mpu(bus, 0x68);
+  mpu.enableFifo();
+  mpu.disableFifo();
+  bus.sample(numberedSample(1));
+  REQUIRE( mpu.readFifoCount() == 0 );
+}
+
+/// An i2cRegisterBus on top of the register map of a mockI2cBus, which reads registers in one transfer.
+class mockRegisterBus : public i2cRegisterBus {
+public:
+  mockI2cBus & bus;
+
+  /// The amount of transfers done.
+  unsigned int transfers = 0;
+
+  mockRegisterBus(mockI2cBus & bus):
+    bus( bus )
+  {}
+
+  void write(uint8_t address, const uint8_t data[], size_t n) override {
+    transfers++;
+    hwlib::i2c_write_transaction(bus, address).write(data, n);
+  }
+
+  void read(uint8_t address, uint8_t data[], size_t n) override {
+    transfers++;
+    hwlib::i2c_read_transaction(bus, address).read(data, n);
+  }
+
+  void readRegisters(uint8_t address, uint8_t registerAddress, uint8_t data[], size_t n) override {
+    transfers++;
+    hwlib::i2c_write_transaction(bus, address).write(registerAddress);
+    hwlib::i2c_read_transaction(bus, address).read(data, n);
+  }
+};
+
+TEST_CASE( "readAll over an i2cRegisterBus costs one transfer" ){
+  mockI2cBus bus;
+  fillMeasurements(bus);
+  mockRegisterBus registerBus(bus);
+  Mpu6050 mpu(registerBus, 0x68);
+
+  registerBus.transfers = 0;
+  auto sample = mpu.readAll();
+  REQUIRE( registerBus.transfers == 1 );
+  REQUIRE( sample.accX == 1000 );
+  REQUIRE( sample.gyroZ == 32767 );
+  REQUIRE( bus.lastAddress == 0x68 );
+}
+
+TEST_CASE( "configuration over an i2cRegisterBus ends up in the registers" ){
+  mockI2cBus bus;
+  mockRegisterBus registerBus(bus);
+  Mpu6050 mpu(registerBus, 0x68);
+
+  mpu.setGyroConfig(2);
+  REQUIRE( bus.registers[0x1B] == 2 << 3 );
+  REQUIRE( mpu.readGyroConfig() == Approx(32.8) );
+}
+
+TEST_CASE( "readFifo over an i2cRegisterBus reads 16 frames per transfer" ){
+  mockI2cBus bus;
+  mockRegisterBus registerBus(bus);
+  Mpu6050 mpu(registerBus, 0x68);
+  mpu.enableFifo();
+  for(int16_t i = 0; i < 40; i++){
+    bus.sample(numberedSample(i));
+  }
+
+  Mpu6050Sample storage[64];
+  Mpu6050SampleBuffer buffer(storage, 64);
+  registerBus.transfers = 0;
+  REQUIRE( mpu.readFifo(buffer) == 40 );
+  REQUIRE( registerBus.transfers == 1 + 3 );
+  for(int16_t i = 0; i < 40; i++){
+    Mpu6050Sample sample;
+    REQUIRE( buffer.pop(sample) );
+    REQUIRE( sample.accX == i );
+  }
+}
@@ -0,0 +1,118 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "attitudeEstimator.hpp"
+#include <cmath>
+#include <vector>
+
+// A trace of what a MPU6050 (fs_sel 0, afs_sel 0) measures while being moved by hand,
+// sampled at 1kHz, together with the true angles at every sample.
+struct traceEntry {
+  Mpu6050Sample sample;
+  float roll;
+  float pitch;
+};
+
+static const float PI = 3.14159265f;
+
+// Records the trace: level, roll to 30 degrees, pitch to -20 degrees, with a sideways
+// bump of half a g halfway, gyroscope bias and noise on everything.
+static std::vector<traceEntry> recordTrace(){
+  std::vector<traceEntry> trace;
+  uint32_t seed = 12345;
+  auto noise = [&seed](int amplitude){
+    seed = seed * 1103515245 + 12345;
+    return static_cast<int>((seed >> 16) % (2 * amplitude + 1)) - amplitude;
+  };
+  float roll = 0, pitch = 0;
+  for(int t = 0; t < 6000; t++){
+    float rollRate = (t >= 1000 && t < 2000) ? 30 : 0;
+    float pitchRate = (t >= 3000 && t < 4000) ? -20 : 0;
+    roll += rollRate * 0.001f;
+    pitch += pitchRate * 0.001f;
+    float r = roll * PI / 180, p = pitch * PI / 180;
+
+    // the up direction and the angular velocity in the sensor's axes
+    float upX = -std::sin(p), upY = std::sin(r) * std::cos(p), upZ = std::cos(r) * std::cos(p);
+    float rateX = rollRate, rateY = pitchRate * std::cos(r), rateZ = -pitchRate * std::sin(r);
+    float bumpY = (t >= 4500 && t < 4550) ? 0.5f : 0;
+
+    traceEntry entry;
+    entry.sample.accX = 16384 * upX + noise(300);
+    entry.sample.accY = 16384 * (upY + bumpY) + noise(300);
+    entry.sample.accZ = 16384 * upZ + noise(300);
+    entry.sample.temperature = 0;
+    entry.sample.gyroX = 131 * rateX + 131 + noise(30);
+    entry.sample.gyroY = 131 * rateY - 65 + noise(30);
+    entry.sample.gyroZ = 131 * rateZ + noise(30);
+    entry.roll = roll;
+    entry.pitch = pitch;
+    trace.push_back(entry);
+  }
+  return trace;
+}
+
+// Replays a trace and returns the largest error after the first second, which is left for settling.
+static float replay(AttitudeEstimator & estimator, const std::vector<traceEntry> & trace, float & rmsError){
+  float maxError = 0, squares = 0;
+  int count = 0;
+  estimator.reset(trace[0].sample);
+  for(size_t i = 0; i < trace.size(); i++){
+    estimator.update(trace[i].sample, 1000);
+    if(i < 1000){
+      continue;
+    }
+    float rollError = std::fabs(estimator.getRoll() - trace[i].roll);
+    float pitchError = std::fabs(estimator.getPitch() - trace[i].pitch);
+    maxError = std::fmax(maxError, std::fmax(rollError, pitchError));
+    squares += rollError * rollError + pitchError * pitchError;
+    count += 2;
+  }
+  rmsError = std::sqrt(squares / count);
+  return maxError;
+}
+
+TEST_CASE( "accelerometer only angles are thrown off by the sideways bump" ){
+  auto trace = recordTrace();
+  auto bump = trace[4540].sample;
+  ComplementaryFilter accelerometerOnly(131.0f, 0);
+  accelerometerOnly.update(bump, 1000);
+  REQUIRE( std::fabs(accelerometerOnly.getRoll() - trace[4540].roll) > 15 );
+}
+
+TEST_CASE( "complementary filter follows the recorded trace" ){
+  auto trace = recordTrace();
+  ComplementaryFilter filter(131.0f, 500000);
+  float rms;
+  float maxError = replay(filter, trace, rms);
+  REQUIRE( maxError < 3.0f );
+  REQUIRE( rms < 1.0f );
+  REQUIRE( filter.getRoll() == Approx(30).margin(1.5) );
+  REQUIRE( filter.getPitch() == Approx(-20).margin(1.5) );
+}
+
+TEST_CASE( "Madgwick filter follows the recorded trace" ){
+  auto trace = recordTrace();
+  MadgwickFilter filter(131.0f, 0.05f);
+  float rms;
+  float maxError = replay(filter, trace, rms);
+  REQUIRE( maxError < 3.0f );
+  REQUIRE( rms < 1.0f );
+  REQUIRE( filter.getRoll() == Approx(30).margin(1.5) );
+  REQUIRE( filter.getPitch() == Approx(-20).margin(1.5) );
+}
+
+TEST_CASE( "reset starts from the accelerometer angles" ){
+  Mpu6050Sample tilted = {0, 8192, 14189, 0, 0, 0, 0}; // 30 degrees roll
+  ComplementaryFilter complementary;
+  MadgwickFilter madgwick;
+  complementary.reset(tilted);
+  madgwick.reset(tilted);
+  REQUIRE( complementary.getRoll() == Approx(30).margin(0.1) );
+  madgwick.update(tilted, 1000);
+  REQUIRE( madgwick.getRoll() == Approx(30).margin(0.1) );
+  REQUIRE( madgwick.getPitch() == Approx(0).margin(0.1) );
+}
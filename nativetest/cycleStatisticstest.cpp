@@ -0,0 +1,46 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "cycleStatistics.hpp"
+
+TEST_CASE( "CycleStatistics summarizes timings added in any order" ){
+  uint32_t storage[1000];
+  CycleStatistics statistics(storage, 1000);
+  REQUIRE( statistics.max() == 0 );
+  REQUIRE( statistics.mean() == 0 );
+
+  // 1 to 1000, shuffled by stepping with a number that has no factor in common with 1000
+  for(uint32_t i = 0; i < 1000; i++){
+    REQUIRE( statistics.add((i * 373) % 1000 + 1) );
+  }
+  REQUIRE_FALSE( statistics.add(5) );
+  REQUIRE( statistics.size() == 1000 );
+  REQUIRE( statistics.min() == 1 );
+  REQUIRE( statistics.max() == 1000 );
+  REQUIRE( statistics.mean() == 500 );
+  REQUIRE( statistics.percentile(50) == 500 );
+  REQUIRE( statistics.percentile(99) == 990 );
+}
+
+TEST_CASE( "CycleStatistics shows the rare slow run the mean hides" ){
+  uint32_t storage[200];
+  CycleStatistics statistics(storage, 200);
+  for(int i = 0; i < 197; i++){
+    statistics.add(100);
+  }
+  statistics.add(5000);
+  statistics.add(5000);
+  statistics.add(5000);
+  REQUIRE( statistics.mean() == 173 );
+  REQUIRE( statistics.percentile(98) == 100 );
+  REQUIRE( statistics.percentile(99) == 5000 );
+  REQUIRE( statistics.max() == 5000 );
+
+  statistics.clear();
+  statistics.add(7);
+  REQUIRE( statistics.min() == 7 );
+  REQUIRE( statistics.percentile(99) == 7 );
+}
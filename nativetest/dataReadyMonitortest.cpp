@@ -0,0 +1,97 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "dataReadyMonitor.hpp"
+#include "MPU6050.hpp"
+#include "mockI2cBus.hpp"
+#include "mockInterruptPin.hpp"
+
+TEST_CASE( "DataReadyMonitor hands out every sample once, with the time of its edge" ){
+  mockInterruptPin pin;
+  DataReadyMonitor monitor(pin);
+  REQUIRE( pin.attached() );
+
+  uint_fast64_t timestamp = 0;
+  REQUIRE_FALSE( monitor.sampleReady() );
+  REQUIRE_FALSE( monitor.takeSample(timestamp) );
+
+  pin.fire(1000);
+  REQUIRE( monitor.sampleReady() );
+  REQUIRE( monitor.takeSample(timestamp) );
+  REQUIRE( timestamp == 1000 );
+  REQUIRE_FALSE( monitor.sampleReady() );
+  REQUIRE_FALSE( monitor.takeSample(timestamp) );
+
+  pin.fire(2000);
+  REQUIRE( monitor.takeSample(timestamp) );
+  REQUIRE( timestamp == 2000 );
+  REQUIRE( monitor.readMissed() == 0 );
+}
+
+TEST_CASE( "DataReadyMonitor converts the raw timestamps of the pin outside the interrupt" ){
+  // like DueInterruptPin, which hands the interrupt a count of 84MHz cycles
+  struct cyclePin : mockInterruptPin {
+    uint_fast64_t toMicroseconds(uint_fast64_t timestamp) const override { return timestamp / 84; }
+  } pin;
+  DataReadyMonitor monitor(pin);
+  uint_fast64_t timestamp = 0;
+
+  pin.fire(84000);
+  REQUIRE( monitor.takeSample(timestamp) );
+  REQUIRE( timestamp == 1000 );
+}
+
+TEST_CASE( "DataReadyMonitor counts samples that were never taken" ){
+  mockInterruptPin pin;
+  DataReadyMonitor monitor(pin);
+  uint_fast64_t timestamp = 0;
+
+  pin.fire(1000);
+  pin.fire(2000);
+  pin.fire(3000);
+  REQUIRE( monitor.takeSample(timestamp) );
+  REQUIRE( timestamp == 3000 );
+  REQUIRE( monitor.readMissed() == 2 );
+}
+
+TEST_CASE( "DataReadyMonitor detaches when it goes away" ){
+  mockInterruptPin pin;
+  {
+    DataReadyMonitor monitor(pin);
+  }
+  REQUIRE_FALSE( pin.attached() );
+}
+
+TEST_CASE( "a loop driven by DataReadyMonitor reads the bus once per sample" ){
+  mockI2cBus bus;
+  mockInterruptPin pin;
+  Mpu6050 mpu(bus, 0x68);
+  mpu.enableDataReadyInterrupt();
+  REQUIRE( bus.registers[0x37] == 0 );
+  REQUIRE( bus.registers[0x38] == 0x01 );
+
+  DataReadyMonitor monitor(pin);
+  bus.reset();
+  unsigned int samples = 0;
+  uint_fast64_t timestamp = 0;
+  uint_fast64_t lastTimestamp = 0;
+  for(uint_fast64_t now = 0; now < 10000; now += 10){
+    if(now % 1000 == 0){
+      pin.fire(now);
+    }
+    if(monitor.takeSample(timestamp)){
+      mpu.readAll();
+      if(samples > 0){
+        REQUIRE( timestamp - lastTimestamp == 1000 );
+      }
+      lastTimestamp = timestamp;
+      samples++;
+    }
+  }
+  REQUIRE( samples == 10 );
+  REQUIRE( bus.transactions == 2 * 10 );
+  REQUIRE( monitor.readMissed() == 0 );
+}
@@ -0,0 +1,88 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+// the model of the TWI has to come first, it provides the registers dueTwiBus.cpp uses
+#include "mockTwi.hpp"
+#include "dueTwiBus.cpp"
+
+static mockTwi & resetTwi(){
+  mockTwi & twi = mockTwi::instance();
+  twi.chipPresent = true;
+  twi.bytesSent = 0;
+  twi.stops = 0;
+  for(int i = 0; i < 256; i++){
+    twi.chipRegisters[i] = i;
+  }
+  return twi;
+}
+
+TEST_CASE( "DueTwiBus reads exactly the registers it was asked for, by PDC and by CPU" ){
+  mockTwi & twi = resetTwi();
+  for(bool usePdc : {true, false}){
+    DueTwiBus bus(400000, usePdc);
+    for(size_t n : {1, 2, 3, 14}){
+      uint8_t data[14] = {};
+      twi.bytesSent = 0;
+      bus.readRegisters(0x68, 0x3B, data, n);
+      REQUIRE( bus.acknowledged() );
+      REQUIRE( twi.bytesSent == n );
+      for(size_t i = 0; i < n; i++){
+        REQUIRE( data[i] == 0x3B + i );
+      }
+    }
+  }
+}
+
+TEST_CASE( "DueTwiBus writes the register address and then the data" ){
+  mockTwi & twi = resetTwi();
+  DueTwiBus bus;
+  const uint8_t data[3] = {0x6B, 0x00, 0x42};
+  size_t stops = twi.stops;
+  bus.write(0x68, data, 3);
+  REQUIRE( bus.acknowledged() );
+  REQUIRE( twi.chipRegisters[0x6B] == 0x00 );
+  REQUIRE( twi.chipRegisters[0x6C] == 0x42 );
+  REQUIRE( twi.stops == stops + 1 );
+}
+
+TEST_CASE( "DueTwiBus doesn't read a byte too many when readDone is called late" ){
+  mockTwi & twi = resetTwi();
+  DueTwiBus bus;
+  uint8_t data[14] = {};
+  bus.beginReadRegisters(0x68, 0x74, data, 14);
+  // an interrupt between every call, long enough for several bytes
+  while(!bus.readDone()){
+    twi.elapse(5);
+  }
+  REQUIRE( twi.bytesSent == 14 );
+  REQUIRE( data[13] == 0x74 + 13 );
+}
+
+TEST_CASE( "DueTwiBus returns when the chip doesn't answer" ){
+  mockTwi & twi = resetTwi();
+  twi.chipPresent = false;
+  for(bool usePdc : {true, false}){
+    DueTwiBus bus(400000, usePdc);
+    for(size_t n : {1, 2, 14}){
+      uint8_t data[14] = {};
+      bus.readRegisters(0x68, 0x3B, data, n);
+      REQUIRE_FALSE( bus.acknowledged() );
+      REQUIRE( data[0] == 0 );
+    }
+    const uint8_t command[2] = {0x6B, 0x00};
+    bus.write(0x68, command, 2);
+    REQUIRE_FALSE( bus.acknowledged() );
+  }
+  REQUIRE( twi.bytesSent == 0 );
+
+  // and works again once it does
+  twi.chipPresent = true;
+  DueTwiBus bus;
+  uint8_t data[2] = {};
+  bus.readRegisters(0x68, 0x3B, data, 2);
+  REQUIRE( bus.acknowledged() );
+  REQUIRE( data[1] == 0x3C );
+}
@@ -0,0 +1,90 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "steppermotor.hpp"
+#include "gimbalSimulator.hpp"
+#include <math.h>
+
+// Steps a SimStepper at a fixed rate for a second.
+static void stepAt(VirtualClock & clock, steppermotor & motor, uint_fast64_t interval){
+  for(uint_fast64_t i = 0; i < 1000000 / interval; i++){
+    motor.stepClockwise();
+    clock.advance(interval);
+  }
+}
+
+TEST_CASE( "SimStepper follows a motor stepped within its limits" ){
+  VirtualClock clock;
+  SimStepper port(clock);
+  steppermotor motor(port, clock);
+
+  stepAt(clock, motor, 2000);
+  clock.advance(20000);
+  REQUIRE( port.steps == 500 );
+  REQUIRE( port.lostSteps == 0 );
+  REQUIRE( port.getAngle() == Approx(500 * 360.0f / 4096).margin(0.1f) );
+}
+
+TEST_CASE( "SimStepper loses steps beyond its maximum speed" ){
+  VirtualClock clock;
+  SimStepper port(clock);
+  steppermotor motor(port, clock);
+
+  stepAt(clock, motor, 400); // 2500 half steps per second, started without a ramp
+  REQUIRE( port.lostSteps > 0 );
+  REQUIRE( port.getAngle() < 2500 * 360.0f / 4096 );
+}
+
+TEST_CASE( "the stabilizer levels the platform after a step of the base" ){
+  GimbalSimulator simulator(Disturbance::step(10, -10));
+  ControllerSettings settings;
+  settings.calibrate = true;
+  SimulationReport report = simulator.run(settings, 2000000);
+  REQUIRE( report.samples == Approx(2000).margin(2) );
+  REQUIRE( report.lostSteps == 0 );
+  REQUIRE( report.settlingTime >= 0 );
+  REQUIRE( report.settlingTime < 500000 );
+  REQUIRE( fabsf(simulator.getRoll()) < 1.0f );
+  REQUIRE( fabsf(simulator.getPitch()) < 1.0f );
+}
+
+TEST_CASE( "without a bias the platform ends up within the deadband of a step" ){
+  GimbalSimulator simulator(Disturbance::step(10, 0));
+  simulator.getSensor().setGyroBias(0, 0, 0);
+  simulator.getSensor().setAccelBias(0, 0, 0);
+  simulator.getSensor().setNoise(0, 0);
+  simulator.run(ControllerSettings(), 2000000);
+  REQUIRE( fabsf(simulator.getRoll()) < 0.1f );
+  REQUIRE( fabsf(simulator.getPitch()) < 0.1f );
+}
+
+TEST_CASE( "calibrating removes the tilt caused by the accelerometer bias" ){
+  GimbalSimulator uncalibrated(Disturbance::step(10, -10));
+  uncalibrated.getSensor().setNoise(0, 0);
+  uncalibrated.run(ControllerSettings(), 2000000);
+  float uncalibratedError = fabsf(uncalibrated.getRoll()) + fabsf(uncalibrated.getPitch());
+
+  GimbalSimulator calibrated(Disturbance::step(10, -10));
+  calibrated.getSensor().setNoise(0, 0);
+  ControllerSettings settings;
+  settings.calibrate = true;
+  calibrated.run(settings, 2000000);
+  float calibratedError = fabsf(calibrated.getRoll()) + fabsf(calibrated.getPitch());
+
+  REQUIRE( uncalibratedError > 1.0f );
+  REQUIRE( calibratedError < 0.3f );
+}
+
+TEST_CASE( "a stabilizer driven too hard loses steps" ){
+  ControllerSettings settings;
+  settings.kp = 400;
+  settings.maxStepRate = 2500;
+  settings.maxSpeed = 2500;
+  settings.acceleration = 30000;
+  GimbalSimulator simulator(Disturbance::step(10, 0));
+  SimulationReport report = simulator.run(settings, 1000000);
+  REQUIRE( report.lostSteps > 0 );
+}
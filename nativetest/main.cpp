@@ -0,0 +1,10 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+// The tests themselves live in the *test.cpp files listed in the Makefile.
+// This file only provides the Catch2 main.
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
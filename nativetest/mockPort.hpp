@@ -0,0 +1,33 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOCKPORT_HPP
+#define MOCKPORT_HPP
+
+#include "hwlib.hpp"
+#include <vector>
+
+/// @file
+
+/// A 4 pin hwlib::port_out that remembers everything written to it.
+///
+/// Only flushed values count, because that's when a real port changes its pins.
+class mockPort : public hwlib::port_out {
+private:
+  /// The value written but not yet flushed.
+  uint_fast16_t buffered = 0;
+
+public:
+  /// Every flushed value, oldest first.
+  std::vector<uint8_t> written;
+
+  uint_fast8_t number_of_pins() override { return 4; }
+
+  void write( uint_fast16_t x ) override { buffered = x; }
+
+  void flush() override { written.push_back(buffered); }
+};
+
+#endif
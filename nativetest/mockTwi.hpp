@@ -0,0 +1,252 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOCKTWI_HPP
+#define MOCKTWI_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdexcept>
+
+/// @file
+
+/// A model of the TWI1 peripheral of the SAM3X8E, with the PDC, and a register based chip on its bus.
+///
+/// Stands in for the registers of the CMSIS headers, so DueTwiBus can be tested natively: include this before
+/// dueTwiBus.cpp. Every read of the status register is one step of the bus, in which one byte is sent or received.
+/// Like the real TWI it holds the clock while a received byte waits in RHR, and ends a read after the byte that was
+/// coming in when STOP was written. When the chip doesn't answer, the TWI sets NACK, which reading the status
+/// clears, and ends the transfer with a stop condition of its own.
+class mockTwi {
+public:
+  /// A register of the peripheral. Writes and reads of the status and data registers go to the model.
+  class reg {
+    mockTwi *owner;
+    uintptr_t value;
+
+  public:
+    reg(): owner( nullptr ), value( 0 ) {}
+
+    void attach(mockTwi *twi){ owner = twi; }
+
+    reg & operator=(uintptr_t v){
+      value = v;
+      owner->written(*this);
+      return *this;
+    }
+
+    operator uint32_t(){
+      return owner->read(*this);
+    }
+
+    uintptr_t raw() const { return value; }
+  };
+
+  /// The registers, named as in the CMSIS headers.
+  struct Twi {
+    reg TWI_CR, TWI_MMR, TWI_IADR, TWI_CWGR, TWI_SR, TWI_RHR, TWI_THR, TWI_RPR, TWI_RCR, TWI_PTCR;
+  } registers;
+
+  /// The address the chip answers to, and its registers.
+  uint8_t chipAddress = 0x68;
+  bool chipPresent = true;
+  uint8_t chipRegisters[256] = {};
+
+  /// The amount of bytes the chip sent, and the amount of stop conditions on the bus.
+  size_t bytesSent = 0;
+  size_t stops = 0;
+
+  mockTwi(){
+    for(reg *r : {&registers.TWI_CR, &registers.TWI_MMR, &registers.TWI_IADR, &registers.TWI_CWGR,
+        &registers.TWI_SR, &registers.TWI_RHR, &registers.TWI_THR, &registers.TWI_RPR, &registers.TWI_RCR,
+        &registers.TWI_PTCR}){
+      r->attach(this);
+    }
+  }
+
+  /// The model the TWI1 macro points to.
+  static mockTwi & instance(){
+    static mockTwi twi;
+    return twi;
+  }
+
+  /// Lets the given amount of bus steps pass without reading the status, like an interrupt would.
+  void elapse(int steps){
+    for(int i = 0; i < steps; i++){
+      step();
+    }
+  }
+
+private:
+  enum class transfer { idle, address, reading, writing };
+  transfer current = transfer::idle;
+  bool rxrdy = false;
+  bool nack = false;
+  bool stopRequested = false;
+  bool thrFull = false;
+  bool pdcEnabled = false;
+  uint8_t rhr = 0;
+  uint8_t thr = 0;
+  uint8_t pointer = 0;
+  bool pointerWritten = false;
+  int idleReads = 0;
+
+  static const uint32_t MREAD = 1u << 12;
+  static const uint32_t IADRSZ_1_BYTE = 1u << 8;
+
+  uint8_t address() const {
+    return (registers.TWI_MMR.raw() >> 16) & 0x7F;
+  }
+
+  bool reading() const {
+    return registers.TWI_MMR.raw() & MREAD;
+  }
+
+  void written(reg & r){
+    if(&r == &registers.TWI_CR){
+      uintptr_t v = r.raw();
+      if(v & (1u << 7)){ // SWRST
+        current = transfer::idle;
+        rxrdy = nack = stopRequested = thrFull = pdcEnabled = false;
+      }
+      if(v & (1u << 1)){ // STOP
+        stopRequested = true;
+      }
+      if((v & 1u) && reading()){ // START
+        if(registers.TWI_MMR.raw() & IADRSZ_1_BYTE){
+          pointer = registers.TWI_IADR.raw();
+        }
+        current = transfer::address;
+      }
+    }else if(&r == &registers.TWI_THR){
+      thr = r.raw();
+      thrFull = true;
+      if(current == transfer::idle){
+        pointerWritten = false;
+        current = transfer::address;
+      }
+    }else if(&r == &registers.TWI_PTCR){
+      if(r.raw() & (1u << 0)){ // RXTEN
+        pdcEnabled = true;
+      }
+      if(r.raw() & (1u << 1)){ // RXTDIS
+        pdcEnabled = false;
+      }
+    }
+  }
+
+  uint32_t read(reg & r){
+    if(&r == &registers.TWI_RHR){
+      rxrdy = false;
+      return rhr;
+    }
+    if(&r == &registers.TWI_SR){
+      step();
+      uint32_t status = (current == transfer::idle ? 1u << 0 : 0) // TXCOMP
+        | (rxrdy ? 1u << 1 : 0)                                   // RXRDY
+        | (thrFull ? 0 : 1u << 2)                                 // TXRDY
+        | (nack ? 1u << 8 : 0)                                    // NACK
+        | (registers.TWI_RCR.raw() == 0 ? 1u << 12 : 0);         // ENDRX
+      nack = false;
+      if(current == transfer::idle && !rxrdy && ++idleReads > 100000){
+        throw std::runtime_error("waiting for a TWI that has nothing to do");
+      }
+      return status;
+    }
+    return r.raw();
+  }
+
+  /// The chip sends the next byte, which ends the read when STOP was written while it came in.
+  void receive(){
+    rhr = chipRegisters[pointer++];
+    rxrdy = true;
+    bytesSent++;
+    if(stopRequested){
+      stopRequested = false;
+      current = transfer::idle;
+      stops++;
+    }
+  }
+
+  void step(){
+    idleReads = current == transfer::idle ? idleReads : 0;
+    switch(current){
+      case transfer::address:
+        if(address() != chipAddress || !chipPresent){
+          nack = true;
+          thrFull = false;
+          stopRequested = false;
+          current = transfer::idle;
+          stops++;
+        }else{
+          current = reading() ? transfer::reading : transfer::writing;
+        }
+        break;
+      case transfer::reading:
+        // the clock is held while RHR is full
+        if(!rxrdy){
+          receive();
+        }
+        break;
+      case transfer::writing:
+        if(thrFull){
+          if(pointerWritten){
+            chipRegisters[pointer++] = thr;
+          }else{
+            pointer = thr;
+            pointerWritten = true;
+          }
+          thrFull = false;
+        }else if(stopRequested){
+          stopRequested = false;
+          current = transfer::idle;
+          stops++;
+        }
+        break;
+      default:
+        break;
+    }
+    // the PDC empties RHR as soon as a byte is in, which starts the next one
+    if(pdcEnabled && rxrdy && registers.TWI_RCR.raw() > 0){
+      *reinterpret_cast<uint8_t *>(registers.TWI_RPR.raw()) = rhr;
+      rxrdy = false;
+      registers.TWI_RPR = registers.TWI_RPR.raw() + 1;
+      registers.TWI_RCR = registers.TWI_RCR.raw() - 1;
+    }
+  }
+};
+
+// the names of the CMSIS headers DueTwiBus uses
+struct Pio { uint32_t PIO_PDR; uint32_t PIO_ABSR; };
+struct Pmc { uint32_t PMC_PCER0; };
+inline Pio mockPiob;
+inline Pmc mockPmc;
+#define PIOB (&mockPiob)
+#define PMC (&mockPmc)
+#define TWI1 (&mockTwi::instance().registers)
+#define ID_TWI1 23
+#define PIO_PB12A_TWD1 (1u << 12)
+#define PIO_PB13A_TWCK1 (1u << 13)
+#define TWI_CR_START (1u << 0)
+#define TWI_CR_STOP (1u << 1)
+#define TWI_CR_MSEN (1u << 2)
+#define TWI_CR_SVDIS (1u << 5)
+#define TWI_CR_SWRST (1u << 7)
+#define TWI_MMR_IADRSZ_1_BYTE (1u << 8)
+#define TWI_MMR_MREAD (1u << 12)
+#define TWI_MMR_DADR(value) (((value) & 0x7Fu) << 16)
+#define TWI_CWGR_CLDIV(value) ((value) & 0xFFu)
+#define TWI_CWGR_CHDIV(value) (((value) & 0xFFu) << 8)
+#define TWI_CWGR_CKDIV(value) (((value) & 0x7u) << 16)
+#define TWI_SR_TXCOMP (1u << 0)
+#define TWI_SR_RXRDY (1u << 1)
+#define TWI_SR_TXRDY (1u << 2)
+#define TWI_SR_NACK (1u << 8)
+#define TWI_SR_ENDRX (1u << 12)
+#define TWI_PTCR_RXTEN (1u << 0)
+#define TWI_PTCR_RXTDIS (1u << 1)
+#define TWI_PTCR_TXTDIS (1u << 9)
+
+#endif
@@ -0,0 +1,96 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "motionGroup.hpp"
+#include "stepper28BYJ48.hpp"
+#include "virtualClock.hpp"
+#include "recordingPort.hpp"
+
+TEST_CASE( "a MotionGroup finishes both axes in the time of the longest" ){
+  VirtualClock clock;
+  RecordingPort port0(clock);
+  RecordingPort port1(clock);
+  stepper28BYJ48 motor0(port0, 4096, clock);
+  stepper28BYJ48 motor1(port1, 4096, clock);
+  MotionGroup group(1000, clock);
+  REQUIRE( group.addMotor(motor0) == 0 );
+  REQUIRE( group.addMotor(motor1) == 1 );
+
+  const int32_t steps[] = {400, -150};
+  group.move(steps);
+  REQUIRE( group.moveDuration() == 400 * 1000 );
+  group.run();
+  REQUIRE_FALSE( group.isMoving() );
+  REQUIRE( group.getPosition(0) == 400 );
+  REQUIRE( group.getPosition(1) == -150 );
+  REQUIRE( port0.log.size() == 400 );
+  REQUIRE( port1.log.size() == 150 );
+  // one after the other would have taken 550 ticks
+  REQUIRE( clock.now_us() == 399 * 1000 );
+  REQUIRE( port0.shortestInterval() == 1000 );
+  REQUIRE( port1.log.back().time > 395 * 1000 );
+}
+
+TEST_CASE( "a MotionGroup spreads the steps of the shorter axis evenly" ){
+  VirtualClock clock;
+  RecordingPort port0(clock);
+  RecordingPort port1(clock);
+  stepper28BYJ48 motor0(port0, 4096, clock);
+  stepper28BYJ48 motor1(port1, 4096, clock);
+  MotionGroup group(1000, clock);
+  group.addMotor(motor0);
+  group.addMotor(motor1);
+
+  const int32_t steps[] = {-400, 150};
+  group.move(steps);
+  group.run();
+  // 400 / 150 ticks per step, so 2 or 3 ticks apart and never two steps in one tick
+  for(size_t i = 1; i < port1.log.size(); i++){
+    auto interval = port1.log[i].time - port1.log[i - 1].time;
+    REQUIRE( interval >= 2000 );
+    REQUIRE( interval <= 3000 );
+  }
+}
+
+TEST_CASE( "MotionGroup::poll takes one tick per interval and moveTo counts from the current position" ){
+  VirtualClock clock;
+  RecordingPort port0(clock);
+  RecordingPort port1(clock);
+  stepper28BYJ48 motor0(port0, 4096, clock);
+  stepper28BYJ48 motor1(port1, 4096, clock);
+  MotionGroup group(500, clock);
+  group.addMotor(motor0);
+  group.addMotor(motor1);
+
+  const int32_t targets[] = {10, 10};
+  group.moveTo(targets);
+  unsigned int ticks = 0;
+  while(group.isMoving()){
+    ticks += group.poll(clock.now_us());
+    clock.advance(100);
+  }
+  REQUIRE( ticks == 10 );
+  REQUIRE( port0.shortestInterval() == 500 );
+
+  const int32_t back[] = {4, 10};
+  group.moveTo(back);
+  group.run();
+  REQUIRE( group.getPosition(0) == 4 );
+  REQUIRE( group.getPosition(1) == 10 );
+  REQUIRE( port1.log.size() == 10 );
+}
+
+TEST_CASE( "a full MotionGroup refuses more motors" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  stepper28BYJ48 motor(port, 4096, clock);
+  MotionGroup group(1000, clock);
+  for(uint8_t i = 0; i < MotionGroup::MAX_MOTORS; i++){
+    REQUIRE( group.addMotor(motor) == i );
+  }
+  REQUIRE( group.addMotor(motor) == MotionGroup::MAX_MOTORS );
+  REQUIRE( group.size() == MotionGroup::MAX_MOTORS );
+}
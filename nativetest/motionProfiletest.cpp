@@ -0,0 +1,169 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "motionProfile.hpp"
+#include "stepperEngine.hpp"
+#include "mockPort.hpp"
+#include <cmath>
+
+TEST_CASE( "trapezoidal profile follows constant acceleration" ){
+  MotionProfile profile(1500, 8000, 0, 500);
+
+  // with constant acceleration step k is reached at speed sqrt(v0^2 + 2ak)
+  for(uint16_t k = 1; k < profile.getRampSteps() - 1; k += 7){
+    double speed = std::sqrt(500.0 * 500.0 + 2.0 * 8000.0 * k);
+    REQUIRE( profile.getInterval(k) == Approx(1000000.0 / speed).epsilon(0.02) );
+  }
+  REQUIRE( profile.getInterval(profile.getRampSteps() - 1) == 666 );
+  REQUIRE( profile.getInterval(60000) == 666 );
+  REQUIRE( profile.getInterval(0) < 2000 );
+}
+
+TEST_CASE( "profile intervals never grow" ){
+  MotionProfile trapezoid(1500, 8000, 0, 500);
+  MotionProfile sCurve(1500, 8000, 100000, 500);
+  for(uint16_t k = 1; k < MotionProfile::MAX_RAMP_STEPS; k++){
+    REQUIRE( trapezoid.getInterval(k) <= trapezoid.getInterval(k - 1) );
+    REQUIRE( sCurve.getInterval(k) <= sCurve.getInterval(k - 1) );
+  }
+}
+
+TEST_CASE( "S-curve profile starts and ends more gently than the trapezoid" ){
+  MotionProfile trapezoid(1500, 8000, 0, 500);
+  MotionProfile sCurve(1500, 8000, 100000, 500);
+  REQUIRE( sCurve.getRampSteps() > trapezoid.getRampSteps() );
+  REQUIRE( sCurve.getInterval(1) > trapezoid.getInterval(1) );
+  REQUIRE( sCurve.getInterval(sCurve.getRampSteps() - 1) == 666 );
+
+  // the last steps before reaching maximum speed hardly speed up anymore
+  auto n = sCurve.getRampSteps();
+  REQUIRE( sCurve.getInterval(n - 3) - sCurve.getInterval(n - 2) <= 1 );
+}
+
+TEST_CASE( "a ramp that doesn't fit the table ends at the speed reached" ){
+  MotionProfile profile(5000, 100, 0, 500);
+  REQUIRE( profile.getRampSteps() == MotionProfile::MAX_RAMP_STEPS );
+  REQUIRE( profile.getInterval(60000) > 200 );
+}
+
+TEST_CASE( "StepperEngine with a profile accelerates, cruises and brakes onto the target" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  MotionProfile profile(1500, 8000, 0, 500);
+  engine.setProfile(profile);
+  engine.setTarget(1000);
+
+  std::vector<uint_fast64_t> stepTimes;
+  for(uint_fast64_t now = 10000; engine.isMoving() && now < 10000000; now += 10){
+    if(engine.poll(now)){
+      stepTimes.push_back(now);
+    }
+  }
+  REQUIRE( engine.getPosition() == 1000 );
+  REQUIRE( stepTimes.size() == 1000 );
+
+  // faster than stepping at the start speed all the way, slower than starting at full speed
+  auto duration = stepTimes.back() - stepTimes.front();
+  REQUIRE( duration < 999 * 2000 );
+  REQUIRE( duration > 999 * 666 );
+
+  // braking walks back down the same ramp
+  REQUIRE( stepTimes[1] - stepTimes[0] == Approx(profile.getInterval(1)).margin(10) );
+  REQUIRE( stepTimes[999] - stepTimes[998] == Approx(profile.getInterval(0)).margin(10) );
+  REQUIRE( stepTimes[500] - stepTimes[499] == Approx(666).margin(10) );
+}
+
+TEST_CASE( "StepperEngine with a profile brakes before turning around" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  MotionProfile profile(1500, 8000, 0, 500);
+  engine.setProfile(profile);
+  engine.setTarget(1000);
+
+  uint_fast64_t now = 10000;
+  for(; engine.getPosition() < 500; now += 10){
+    engine.poll(now);
+  }
+  engine.setTarget(0);
+  int32_t furthest = 0;
+  for(; engine.isMoving() && now < 10000000; now += 10){
+    engine.poll(now);
+    if(engine.getPosition() > furthest){ furthest = engine.getPosition(); }
+  }
+  REQUIRE( furthest > 500 );
+  REQUIRE( engine.getPosition() == 0 );
+}
+
+TEST_CASE( "StepperEngine with a profile brakes to a stop without turning back" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  MotionProfile profile(1500, 8000, 0, 500);
+  engine.setProfile(profile);
+  engine.setTarget(1000000);
+
+  uint_fast64_t now = 10000;
+  for(; now < 510000; now += 10){
+    engine.poll(now);
+  }
+  int32_t stopped = engine.getPosition();
+  engine.stop();
+  REQUIRE( engine.getTarget() > stopped );
+
+  int32_t previous = stopped;
+  uint_fast64_t last = now;
+  uint_fast64_t lastInterval = 0;
+  for(; engine.isMoving() && now < 10000000; now += 10){
+    if(engine.poll(now)){
+      // only forward, and slower with every step
+      REQUIRE( engine.getPosition() == previous + 1 );
+      REQUIRE( now - last + 20 >= lastInterval );
+      lastInterval = now - last;
+      last = now;
+      previous = engine.getPosition();
+    }
+  }
+  REQUIRE( engine.getPosition() == engine.getTarget() );
+  REQUIRE( lastInterval == Approx(profile.getInterval(1)).margin(10) );
+
+  // standing still, it stops where it is
+  engine.stop();
+  REQUIRE( engine.getTarget() == engine.getPosition() );
+}
+
+TEST_CASE( "StepperEngine with a profile walks down its ramp to a lowered speed limit" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  MotionProfile profile(1500, 8000, 0, 500);
+  engine.setProfile(profile);
+  engine.setSpeed(1500);
+
+  uint_fast64_t now = 10000;
+  uint_fast64_t last = 0;
+  for(; now < 510000; now += 10){
+    if(engine.poll(now)){
+      last = now;
+    }
+  }
+  engine.setSpeedLimit(1000);
+  std::vector<uint_fast64_t> intervals;
+  for(; now < 1010000; now += 10){
+    if(engine.poll(now)){
+      intervals.push_back(now - last);
+      last = now;
+    }
+  }
+  // no sudden jump from 666us to 1000us, which would make the rotor run ahead of the coils
+  REQUIRE( intervals.front() < 700 );
+  for(size_t i = 1; i < intervals.size(); i++){
+    REQUIRE( intervals[i] <= intervals[i - 1] + 20 );
+  }
+  REQUIRE( intervals.back() == Approx(1000).margin(20) );
+  REQUIRE( intervals.back() >= 1000 );
+}
@@ -0,0 +1,156 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "mpu6050Calibrator.hpp"
+#include "simMpu6050.hpp"
+#include "mockPersistentStore.hpp"
+
+// a chip with the offsets of a real one, awake at 1kHz
+static void setUp(SimMpu6050 & sensor, Mpu6050 & mpu){
+  sensor.setNoise(0.003f, 0.03f);
+  sensor.setGyroBias(0.8f, -1.1f, 0.4f);
+  sensor.setAccelBias(0.02f, -0.01f, 0.03f);
+  mpu.disableSleep();
+  mpu.setConfig(1);
+}
+
+// the average of n samples
+static Mpu6050Sample average(Mpu6050 & mpu, VirtualClock & clock, int n){
+  int32_t sums[6] = {};
+  for(int i = 0; i < n; i++){
+    clock.advance(1000);
+    auto s = mpu.readAll();
+    const int16_t values[6] = {s.accX, s.accY, s.accZ, s.gyroX, s.gyroY, s.gyroZ};
+    for(int j = 0; j < 6; j++){
+      sums[j] += values[j];
+    }
+  }
+  return Mpu6050Sample{
+    static_cast<int16_t>(sums[0] / n), static_cast<int16_t>(sums[1] / n), static_cast<int16_t>(sums[2] / n), 0,
+    static_cast<int16_t>(sums[3] / n), static_cast<int16_t>(sums[4] / n), static_cast<int16_t>(sums[5] / n)
+  };
+}
+
+TEST_CASE( "measure finds the offsets of a still chip" ){
+  VirtualClock clock;
+  SimMpu6050 sensor(clock);
+  Mpu6050 mpu(sensor, 0x68);
+  setUp(sensor, mpu);
+  Mpu6050Calibrator calibrator(mpu, clock);
+
+  Mpu6050Offsets offsets;
+  REQUIRE( calibrator.measure(offsets) );
+  REQUIRE( offsets.accX == Approx(0.02f * 16384).margin(10) );
+  REQUIRE( offsets.accY == Approx(-0.01f * 16384).margin(10) );
+  REQUIRE( offsets.accZ == Approx(0.03f * 16384).margin(10) );
+  REQUIRE( offsets.gyroX == Approx(0.8f * 131).margin(2) );
+  REQUIRE( offsets.gyroY == Approx(-1.1f * 131).margin(2) );
+  REQUIRE( offsets.gyroZ == Approx(0.4f * 131).margin(2) );
+  REQUIRE( clock.now_us() == 500 * 1000 );
+}
+
+TEST_CASE( "measure works at other ranges and orientations, in the units of the most sensitive ranges" ){
+  VirtualClock clock;
+  SimMpu6050 sensor(clock);
+  Mpu6050 mpu(sensor, 0x68);
+  setUp(sensor, mpu);
+  mpu.setAcceleroConfig(2);
+  mpu.setGyroConfig(1);
+  // X up is roll 0, pitch -90
+  sensor.setAttitude(0, -90);
+  Mpu6050Calibrator calibrator(mpu, clock);
+
+  Mpu6050Offsets offsets;
+  REQUIRE( calibrator.measure(offsets, 500, upAxis::xUp) );
+  REQUIRE( offsets.accX == Approx(0.02f * 16384).margin(20) );
+  REQUIRE( offsets.accZ == Approx(0.03f * 16384).margin(20) );
+  REQUIRE( offsets.gyroY == Approx(-1.1f * 131).margin(3) );
+}
+
+TEST_CASE( "measure refuses a chip that moves" ){
+  VirtualClock clock;
+  SimMpu6050 sensor(clock);
+  Mpu6050 mpu(sensor, 0x68);
+  setUp(sensor, mpu);
+  sensor.setNoise(0.003f, 5.0f);
+  Mpu6050Calibrator calibrator(mpu, clock);
+
+  Mpu6050Offsets offsets{1, 2, 3, 4, 5, 6};
+  REQUIRE_FALSE( calibrator.measure(offsets, 100) );
+  REQUIRE( offsets.accX == 1 );
+  REQUIRE( offsets.gyroZ == 6 );
+}
+
+TEST_CASE( "apply corrects the chip itself and keeps bit 0 of the factory trim" ){
+  VirtualClock clock;
+  SimMpu6050 sensor(clock);
+  Mpu6050 mpu(sensor, 0x68);
+  setUp(sensor, mpu);
+  Mpu6050Calibrator calibrator(mpu, clock);
+
+  Mpu6050Offsets offsets;
+  REQUIRE( calibrator.measure(offsets) );
+  calibrator.apply(offsets);
+
+  int16_t accel[3];
+  mpu.readAcceleroOffsets(accel);
+  for(int i = 0; i < 3; i++){
+    REQUIRE( (accel[i] & 1) == (SimMpu6050::FACTORY_ACCEL_OFFSETS[i] & 1) );
+  }
+  int16_t gyro[3];
+  mpu.readGyroOffsets(gyro);
+  REQUIRE( gyro[0] == Approx(-0.8f * 32.8f).margin(1) );
+
+  auto corrected = average(mpu, clock, 500);
+  REQUIRE( corrected.accX == Approx(0).margin(10) );
+  REQUIRE( corrected.accY == Approx(0).margin(10) );
+  REQUIRE( corrected.accZ == Approx(16384).margin(10) );
+  REQUIRE( corrected.gyroX == Approx(0).margin(3) );
+  REQUIRE( corrected.gyroY == Approx(0).margin(3) );
+  REQUIRE( corrected.gyroZ == Approx(0).margin(3) );
+
+  // measuring again includes what the chip already corrects
+  Mpu6050Offsets again;
+  REQUIRE( calibrator.measure(again) );
+  REQUIRE( again.gyroY == Approx(offsets.gyroY).margin(3) );
+  REQUIRE( again.accZ == Approx(offsets.accZ).margin(12) );
+}
+
+TEST_CASE( "remove corrects samples in software at any range" ){
+  Mpu6050Offsets offsets{400, -200, 800, 100, -150, 52};
+  Mpu6050Sample sample{1000, 1000, 16384, 7, 200, 200, 200};
+  auto corrected = Mpu6050Calibrator::remove(sample, offsets);
+  REQUIRE( corrected.accX == 600 );
+  REQUIRE( corrected.accZ == 15584 );
+  REQUIRE( corrected.temperature == 7 );
+  REQUIRE( corrected.gyroY == 350 );
+
+  corrected = Mpu6050Calibrator::remove(sample, offsets, 2, 1);
+  REQUIRE( corrected.accX == 900 );
+  REQUIRE( corrected.accY == 1050 );
+  REQUIRE( corrected.gyroX == 150 );
+  REQUIRE( corrected.gyroZ == 174 );
+}
+
+TEST_CASE( "offsets survive a save and load, damaged or missing ones are refused" ){
+  mockPersistentStore store;
+  Mpu6050Offsets offsets{327, -164, 492, 105, -144, 52};
+  Mpu6050Offsets loaded{0, 0, 0, 0, 0, 0};
+
+  REQUIRE_FALSE( Mpu6050Calibrator::load(store, loaded) );
+  REQUIRE( Mpu6050Calibrator::save(store, offsets) );
+  REQUIRE( store.writes == 1 );
+  REQUIRE( Mpu6050Calibrator::load(store, loaded) );
+  REQUIRE( loaded.accX == 327 );
+  REQUIRE( loaded.accY == -164 );
+  REQUIRE( loaded.gyroY == -144 );
+  REQUIRE( loaded.gyroZ == 52 );
+
+  store.bytes[7] ^= 0x10;
+  Mpu6050Offsets untouched{1, 1, 1, 1, 1, 1};
+  REQUIRE_FALSE( Mpu6050Calibrator::load(store, untouched) );
+  REQUIRE( untouched.accX == 1 );
+}
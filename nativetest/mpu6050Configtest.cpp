@@ -0,0 +1,67 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "mpu6050Config.hpp"
+#include "MPU6050.hpp"
+#include "simMpu6050.hpp"
+
+// the whole table is usable at compile time
+static_assert( mpu6050Config::samplePeriod( mpu6050Config::forRate( 200, dlpfBandwidth::hz44 ) ) == 5000, "" );
+static_assert( mpu6050Config::latency( Mpu6050Config{dlpfBandwidth::hz184, 0, 0, 0} ) == 3000, "" );
+
+TEST_CASE( "the sample period follows the DLPF and SMPLRT_DIV" ){
+  REQUIRE( mpu6050Config::samplePeriod( Mpu6050Config{dlpfBandwidth::hz260, 0, 0, 0} ) == 125 );
+  REQUIRE( mpu6050Config::samplePeriod( Mpu6050Config{dlpfBandwidth::hz260, 7, 0, 0} ) == 1000 );
+  REQUIRE( mpu6050Config::samplePeriod( Mpu6050Config{dlpfBandwidth::hz184, 0, 0, 0} ) == 1000 );
+  REQUIRE( mpu6050Config::samplePeriod( Mpu6050Config{dlpfBandwidth::hz5, 255, 0, 0} ) == 256000 );
+  REQUIRE( mpu6050Config::sampleRate( Mpu6050Config{dlpfBandwidth::hz94, 4, 0, 0} ) == 200 );
+}
+
+TEST_CASE( "narrower filters delay longer" ){
+  uint32_t previous = 0;
+  for(uint8_t dlpf = 0; dlpf <= 6; dlpf++){
+    auto config = Mpu6050Config{static_cast<dlpfBandwidth>(dlpf), 0, 0, 0};
+    REQUIRE( mpu6050Config::filterDelay( config ) > previous );
+    previous = mpu6050Config::filterDelay( config );
+  }
+  // the gyroscope is a little faster than the accelerometer, the longer delay counts
+  REQUIRE( mpu6050Config::filterDelay( Mpu6050Config{dlpfBandwidth::hz44, 0, 0, 0} ) == 4900 );
+  REQUIRE( mpu6050Config::filterDelay( Mpu6050Config{dlpfBandwidth::hz260, 0, 0, 0} ) == 980 );
+}
+
+TEST_CASE( "forRate picks the closest divider" ){
+  auto config = mpu6050Config::forRate( 333, dlpfBandwidth::hz44, 1, 2 );
+  REQUIRE( config.bandwidth == dlpfBandwidth::hz44 );
+  REQUIRE( config.rateDivider == 2 );
+  REQUIRE( config.afs_sel == 1 );
+  REQUIRE( config.fs_sel == 2 );
+  REQUIRE( mpu6050Config::forRate( 8000, dlpfBandwidth::hz260 ).rateDivider == 0 );
+  REQUIRE( mpu6050Config::forRate( 2000, dlpfBandwidth::hz260 ).rateDivider == 3 );
+  REQUIRE( mpu6050Config::forRate( 5000, dlpfBandwidth::hz184 ).rateDivider == 0 );
+  REQUIRE( mpu6050Config::forRate( 1, dlpfBandwidth::hz184 ).rateDivider == 255 );
+  REQUIRE( mpu6050Config::forRate( 0, dlpfBandwidth::hz184 ).rateDivider == 255 );
+}
+
+TEST_CASE( "a filter wider than half the sample rate lets noise alias" ){
+  REQUIRE( mpu6050Config::isAliasFree( mpu6050Config::forRate( 1000, dlpfBandwidth::hz184 ) ) );
+  REQUIRE( mpu6050Config::isAliasFree( mpu6050Config::forRate( 100, dlpfBandwidth::hz44 ) ) );
+  REQUIRE_FALSE( mpu6050Config::isAliasFree( mpu6050Config::forRate( 200, dlpfBandwidth::hz184 ) ) );
+  REQUIRE_FALSE( mpu6050Config::isAliasFree( mpu6050Config::forRate( 400, dlpfBandwidth::hz260 ) ) );
+}
+
+TEST_CASE( "the configured sample period is the one the chip samples at" ){
+  VirtualClock clock;
+  SimMpu6050 chip(clock);
+  Mpu6050 mpu(chip, 0x68);
+  mpu.disableSleep();
+
+  for(auto config : {Mpu6050Config{dlpfBandwidth::hz260, 1, 0, 0}, mpu6050Config::forRate( 250, dlpfBandwidth::hz44 ),
+                     mpu6050Config::forRate( 50, dlpfBandwidth::hz10 )}){
+    mpu.configure( config );
+    REQUIRE( mpu.samplePeriod() == mpu6050Config::samplePeriod( config ) );
+    REQUIRE( chip.samplePeriod() == mpu.samplePeriod() );
+  }
+}
@@ -0,0 +1,91 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "pidController.hpp"
+#include "stepperEngine.hpp"
+#include "mockPort.hpp"
+#include <cmath>
+
+TEST_CASE( "PidController output is proportional and limited" ){
+  PidController pid(10.0f, 0.0f, 0.0f, 100.0f);
+  REQUIRE( pid.update(0.0f, 2.0f, 1000) == Approx(-20.0f) );
+  REQUIRE( pid.update(0.0f, -50.0f, 1000) == Approx(100.0f) );
+  REQUIRE( pid.update(0.0f, 50.0f, 1000) == Approx(-100.0f) );
+}
+
+TEST_CASE( "PidController integral doesn't wind up while the output is limited" ){
+  PidController pid(1.0f, 10.0f, 0.0f, 5.0f);
+  for(int i = 0; i < 10000; i++){
+    REQUIRE( pid.update(10.0f, 0.0f, 1000) == Approx(5.0f) );
+  }
+  // after 10 seconds of limited output the integral can't be much larger than the limit
+  REQUIRE( pid.update(0.0f, 0.0f, 1000) <= 5.0f );
+  float output = 0;
+  for(int i = 0; i < 1000; i++){
+    output = pid.update(0.0f, 1.0f, 1000);
+  }
+  REQUIRE( output < 0.0f );
+}
+
+TEST_CASE( "PidController derivative ignores setpoint changes and filters noise" ){
+  PidController pid(0.0f, 0.0f, 1.0f, 1000.0f, 10000);
+  pid.update(0.0f, 0.0f, 1000);
+  REQUIRE( pid.update(50.0f, 0.0f, 1000) == Approx(0.0f) );
+
+  // a single noisy measurement is damped by the filter
+  float kick = pid.update(50.0f, 1.0f, 1000);
+  REQUIRE( kick < 0.0f );
+  REQUIRE( kick > -1000.0f * 0.1f );
+}
+
+TEST_CASE( "PidController ignores errors inside the deadband" ){
+  PidController pid(10.0f, 100.0f, 0.0f, 100.0f, 10000, 0.5f);
+  for(int i = 0; i < 100; i++){
+    REQUIRE( pid.update(0.0f, 0.4f, 1000) == 0.0f );
+  }
+  REQUIRE( pid.update(0.0f, 1.0f, 1000) == Approx(-10.1f) );
+}
+
+// The gimbal axis: the handle is tilted by disturbance degrees and the motor turns the
+// platform back by 360 / 4096 degrees per step. The sensor on the platform sees the sum.
+static float platformAngle(float disturbance, const StepperEngine & engine){
+  return disturbance + engine.getPosition() * 360.0f / 4096.0f;
+}
+
+TEST_CASE( "PID and StepperEngine level a tilted gimbal axis without hunting" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  MotionProfile profile(1500, 8000, 100000, 500);
+  engine.setProfile(profile);
+  PidController pid(150.0f, 10.0f, 2.0f, 1500.0f, 10000, 0.05f);
+
+  float disturbance = 10.0f;
+  int reversals = 0;
+  int32_t lastSpeed = 0;
+  uint_fast64_t settled = 0;
+  for(uint_fast64_t now = 1000; now < 3000000; now += 50){
+    if(now % 1000 == 0){
+      float angle = platformAngle(disturbance, engine);
+      auto command = static_cast<int32_t>(pid.update(0.0f, angle, 1000));
+      if((command > 0 && lastSpeed < 0) || (command < 0 && lastSpeed > 0)){
+        reversals++;
+      }
+      if(command != 0){
+        lastSpeed = command;
+      }
+      engine.setSpeed(command);
+      if(settled == 0 && std::fabs(angle) < 0.2f){
+        settled = now;
+      }
+    }
+    engine.poll(now);
+  }
+  REQUIRE( settled != 0 );
+  REQUIRE( settled < 500000 );
+  REQUIRE( std::fabs(platformAngle(disturbance, engine)) < 0.1f );
+  REQUIRE( reversals <= 3 );
+}
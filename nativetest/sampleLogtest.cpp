@@ -0,0 +1,203 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "sampleLog.hpp"
+#include "virtualClock.hpp"
+#include "simMpu6050.hpp"
+#include <vector>
+
+struct timedSample {
+  uint32_t time;
+  Mpu6050Sample sample;
+};
+
+static bool operator==(const Mpu6050Sample & a, const Mpu6050Sample & b){
+  return a.accX == b.accX && a.accY == b.accY && a.accZ == b.accZ && a.temperature == b.temperature
+    && a.gyroX == b.gyroX && a.gyroY == b.gyroY && a.gyroZ == b.gyroZ;
+}
+
+// Makes a trace like a gimbal being carried around: noise on a slowly swaying attitude, sampled every millisecond
+// with a few microseconds of jitter, the way the loop of applicatie timestamps them.
+static std::vector<timedSample> makeTrace(size_t n, float accelNoise = 0.003, float gyroNoise = 0.03){
+  VirtualClock clock;
+  SimMpu6050 sensor(clock);
+  sensor.setNoise(accelNoise, gyroNoise);
+  std::vector<timedSample> trace;
+  uint32_t time = 123456;
+  for(size_t i = 0; i < n; i++){
+    float t = i / 1000.0f;
+    sensor.setAttitude(10 * t - 5 * t * t / (1 + t), 3 * (i % 2000 < 1000 ? 1 : -1));
+    sensor.setRates(10 - 10 * t / (1 + t), 0, 2);
+    time += 1000 + (i * 7 % 5) - 2;
+    trace.push_back({time, sensor.makeSample()});
+  }
+  return trace;
+}
+
+static std::vector<timedSample> contents(const SampleLog & log){
+  std::vector<timedSample> samples;
+  log.forEach([&](uint32_t time, const Mpu6050Sample & sample){ samples.push_back({time, sample}); });
+  return samples;
+}
+
+TEST_CASE( "zigzag keeps small differences small and varints take 7 bits per byte" ){
+  REQUIRE( sampleLogFormat::zigzag(0) == 0 );
+  REQUIRE( sampleLogFormat::zigzag(-1) == 1 );
+  REQUIRE( sampleLogFormat::zigzag(1) == 2 );
+  REQUIRE( sampleLogFormat::zigzag(-65535) == 131069 );
+  for(int32_t value : {0, 1, -1, 63, -64, 64, 65535, -65535, INT32_MAX, INT32_MIN}){
+    REQUIRE( sampleLogFormat::unzigzag(sampleLogFormat::zigzag(value)) == value );
+  }
+
+  uint8_t data[5];
+  REQUIRE( sampleLogFormat::putVarint(data, 127) == 1 );
+  REQUIRE( sampleLogFormat::putVarint(data, 128) == 2 );
+  REQUIRE( sampleLogFormat::putVarint(data, 131069) == 3 );
+  REQUIRE( sampleLogFormat::putVarint(data, 0xFFFFFFFF) == 5 );
+  size_t i = 0;
+  uint32_t value;
+  REQUIRE( sampleLogFormat::getVarint(data, i, 5, value) );
+  REQUIRE( value == 0xFFFFFFFF );
+  REQUIRE( i == 5 );
+  i = 0;
+  REQUIRE_FALSE( sampleLogFormat::getVarint(data, i, 4, value) );
+}
+
+TEST_CASE( "SampleLog gives back exactly the samples and times it recorded" ){
+  static uint8_t storage[128 * SampleLog::BLOCK_SIZE];
+  SampleLog log(storage, sizeof(storage));
+  auto trace = makeTrace(2000);
+  for(auto & s : trace){
+    log.record(s.time, s.sample);
+  }
+  REQUIRE( log.size() == 2000 );
+  auto samples = contents(log);
+  REQUIRE( samples.size() == 2000 );
+  for(size_t i = 0; i < samples.size(); i++){
+    REQUIRE( samples[i].time == trace[i].time );
+    REQUIRE( samples[i].sample == trace[i].sample );
+  }
+}
+
+TEST_CASE( "SampleLog survives the largest differences and gaps in time" ){
+  static uint8_t storage[4 * SampleLog::BLOCK_SIZE];
+  SampleLog log(storage, sizeof(storage));
+  std::vector<timedSample> trace = {
+    {0, {32767, -32768, 32767, -32768, 32767, -32768, 32767}},
+    {1000, {-32768, 32767, -32768, 32767, -32768, 32767, -32768}},
+    {0xFFFFFF00, {0, 0, 0, 0, 0, 0, 0}},
+    {100, {-1, 1, -1, 1, -1, 1, -1}},
+    {100, {-1, 1, -1, 1, -1, 1, -1}}
+  };
+  for(auto & s : trace){
+    log.record(s.time, s.sample);
+  }
+  auto samples = contents(log);
+  REQUIRE( samples.size() == trace.size() );
+  for(size_t i = 0; i < samples.size(); i++){
+    REQUIRE( samples[i].time == trace[i].time );
+    REQUIRE( samples[i].sample == trace[i].sample );
+  }
+}
+
+TEST_CASE( "a full SampleLog drops its oldest block and keeps the latest samples" ){
+  static uint8_t storage[4 * SampleLog::BLOCK_SIZE + 100];
+  SampleLog log(storage, sizeof(storage));
+  auto trace = makeTrace(1000);
+  for(auto & s : trace){
+    log.record(s.time, s.sample);
+  }
+  REQUIRE( log.blocks() == 4 );
+  REQUIRE( log.size() < 1000 );
+  REQUIRE( log.bytes() <= 4 * SampleLog::BLOCK_SIZE );
+
+  // what is left is the end of the trace, without gaps
+  auto samples = contents(log);
+  REQUIRE( samples.size() == log.size() );
+  size_t start = trace.size() - samples.size();
+  for(size_t i = 0; i < samples.size(); i++){
+    REQUIRE( samples[i].time == trace[start + i].time );
+    REQUIRE( samples[i].sample == trace[start + i].sample );
+  }
+
+  // frozen after a fault, it keeps the samples from before it
+  log.enable(false);
+  log.record(0, Mpu6050Sample{});
+  REQUIRE( contents(log).back().time == trace.back().time );
+
+  log.clear();
+  REQUIRE( log.size() == 0 );
+  REQUIRE( log.blocks() == 0 );
+  REQUIRE( contents(log).empty() );
+  log.enable(true);
+  log.record(5, trace[0].sample);
+  REQUIRE( contents(log).size() == 1 );
+}
+
+TEST_CASE( "a dumped SampleLog reads back with SampleLogReader" ){
+  static uint8_t storage[32 * SampleLog::BLOCK_SIZE];
+  SampleLog log(storage, sizeof(storage));
+  auto trace = makeTrace(500);
+  for(auto & s : trace){
+    log.record(s.time, s.sample);
+  }
+  std::vector<uint8_t> bytes = {'o', 'k', '\n', 'S', 'L'};
+  log.dump([&](uint8_t b){ bytes.push_back(b); });
+  REQUIRE( bytes.size() == 5 + 4 + sampleLogFormat::HEADER_SIZE + log.blocks() * SampleLog::BLOCK_SIZE + 2 );
+
+  SampleLogReader reader;
+  std::vector<timedSample> samples;
+  int done = 0;
+  for(uint8_t b : bytes){
+    auto result = reader.feed(b);
+    if(result == SampleLogReader::result::block){
+      sampleLogFormat::decodeBlock(reader.block, [&](uint32_t time, const Mpu6050Sample & sample){
+        samples.push_back({time, sample});
+      });
+    }
+    done += result == SampleLogReader::result::done;
+    REQUIRE( result != SampleLogReader::result::error );
+  }
+  REQUIRE( done == 1 );
+  REQUIRE( reader.count == log.blocks() );
+  REQUIRE( samples.size() == 500 );
+  REQUIRE( samples.back().time == trace.back().time );
+  REQUIRE( samples.back().sample == trace.back().sample );
+
+  SECTION( "a damaged dump fails its checksum" ){
+    bytes[100] ^= 0x10;
+    SampleLogReader damaged;
+    bool error = false;
+    for(uint8_t b : bytes){
+      error |= damaged.feed(b) == SampleLogReader::result::error;
+    }
+    REQUIRE( error );
+  }
+}
+
+TEST_CASE( "SampleLog stores a realistic trace in little more than half the memory of raw samples" ){
+  // compared with a SampleBuffer of 14 byte samples and a 4 byte timestamp for each
+  static uint8_t storage[64 * SampleLog::BLOCK_SIZE];
+  const size_t raw = sizeof(Mpu6050Sample) + sizeof(uint32_t);
+
+  SECTION( "with the noise of the datasheet at DLPF setting 3" ){
+    SampleLog log(storage, sizeof(storage));
+    for(auto & s : makeTrace(1000)){
+      log.record(s.time, s.sample);
+    }
+    float ratio = float(log.size() * raw) / log.bytes();
+    REQUIRE( ratio > 1.75 );
+  }
+
+  SECTION( "with three times that noise, as without a filter" ){
+    SampleLog log(storage, sizeof(storage));
+    for(auto & s : makeTrace(1000, 0.01, 0.1)){
+      log.record(s.time, s.sample);
+    }
+    float ratio = float(log.size() * raw) / log.bytes();
+    REQUIRE( ratio > 1.5 );
+  }
+}
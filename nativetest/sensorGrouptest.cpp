@@ -0,0 +1,179 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "sensorGroup.hpp"
+#include "simMpu6050.hpp"
+#include "mockSharedBus.hpp"
+#include "mockInterruptPin.hpp"
+
+TEST_CASE( "transferTime counts every bit of a burst read" ){
+  REQUIRE( SensorGroup::transferTime( 400000 ) == 393 );
+  REQUIRE( SensorGroup::transferTime( 100000 ) == 1570 );
+  REQUIRE( SensorGroup::transferTime( 400000, 2 ) == 123 );
+}
+
+TEST_CASE( "a shared bus only lets the addressed chip answer" ){
+  mockI2cBus chip0;
+  mockI2cBus chip1;
+  chip0.registers[0x75] = 0x68;
+  chip1.registers[0x75] = 0x69;
+  mockSharedBus bus;
+  bus.addChip(chip0, 0x68);
+  bus.addChip(chip1, 0x69);
+
+  Mpu6050 mpu0(bus, 0x68);
+  Mpu6050 mpu1(bus, 0x69);
+  REQUIRE( mpu0.readRegister(0x75) == 0x68 );
+  REQUIRE( mpu1.readRegister(0x75) == 0x69 );
+  mpu1.setGyroConfig(2);
+  REQUIRE( chip0.registers[0x1B] == 0 );
+  REQUIRE( chip1.registers[0x1B] == 2 << 3 );
+  REQUIRE( chip0.transactions == 2 );
+  REQUIRE( chip1.transactions == 3 );
+  REQUIRE( bus.transactions == 5 );
+}
+
+TEST_CASE( "poll reads the oldest sample first" ){
+  mockI2cBus chip0;
+  mockI2cBus chip1;
+  mockSharedBus bus;
+  bus.addChip(chip0, 0x68);
+  bus.addChip(chip1, 0x69);
+  chip0.setWord(0x3B, 100);
+  chip1.setWord(0x3B, 200);
+  Mpu6050 mpu0(bus, 0x68);
+  Mpu6050 mpu1(bus, 0x69);
+  mockInterruptPin pin0;
+  mockInterruptPin pin1;
+  DataReadyMonitor ready0(pin0);
+  DataReadyMonitor ready1(pin1);
+  SensorGroup group;
+  REQUIRE( group.addSensor(mpu0, ready0) == 0 );
+  REQUIRE( group.addSensor(mpu1, ready1) == 1 );
+  REQUIRE( group.size() == 2 );
+
+  Mpu6050Sample sample;
+  uint_fast64_t timestamp;
+  REQUIRE( group.poll() == 0 );
+  REQUIRE_FALSE( group.takeSample(0, sample, timestamp) );
+
+  pin1.fire(1000);
+  pin0.fire(1200);
+  REQUIRE( group.poll() == 2 );
+  REQUIRE( bus.lastAddress == 0x68 );
+  pin0.fire(2000);
+  pin1.fire(2100);
+  REQUIRE( group.poll() == 2 );
+  REQUIRE( bus.lastAddress == 0x69 );
+
+  REQUIRE( group.takeSample(0, sample, timestamp) );
+  REQUIRE( sample.accX == 100 );
+  REQUIRE( timestamp == 2000 );
+  REQUIRE_FALSE( group.takeSample(0, sample, timestamp) );
+  REQUIRE( group.takeSample(1, sample, timestamp) );
+  REQUIRE( sample.accX == 200 );
+  REQUIRE( timestamp == 2100 );
+  REQUIRE_FALSE( group.takeSample(2, sample, timestamp) );
+}
+
+TEST_CASE( "configure slows the sensors down to what the bus can carry" ){
+  mockI2cBus chip0;
+  mockI2cBus chip1;
+  mockSharedBus bus;
+  bus.addChip(chip0, 0x68);
+  bus.addChip(chip1, 0x69);
+  Mpu6050 mpu0(bus, 0x68);
+  Mpu6050 mpu1(bus, 0x69);
+  mockInterruptPin pin0;
+  mockInterruptPin pin1;
+  DataReadyMonitor ready0(pin0);
+  DataReadyMonitor ready1(pin1);
+
+  SECTION( "at 400kHz two sensors fit at 1kHz" ){
+    SensorGroup group(400000);
+    group.addSensor(mpu0, ready0);
+    group.addSensor(mpu1, ready1);
+    auto config = group.configure( mpu6050Config::forRate(1000, dlpfBandwidth::hz184) );
+    REQUIRE( config.rateDivider == 0 );
+    REQUIRE( group.busLoad() == 78 );
+  }
+
+  SECTION( "at 100kHz they are slowed down to 250Hz" ){
+    SensorGroup group(100000);
+    group.addSensor(mpu0, ready0);
+    group.addSensor(mpu1, ready1);
+    auto config = group.configure( mpu6050Config::forRate(1000, dlpfBandwidth::hz184, 1, 2) );
+    REQUIRE( config.rateDivider == 3 );
+    REQUIRE( config.afs_sel == 1 );
+    REQUIRE( config.fs_sel == 2 );
+    REQUIRE( group.busLoad() == 78 );
+    REQUIRE( chip0.registers[0x19] == 3 );
+    REQUIRE( chip1.registers[0x19] == 3 );
+    REQUIRE( chip1.registers[0x1B] == 2 << 3 );
+  }
+}
+
+TEST_CASE( "two simulated sensors on one bus are read at their own sample times" ){
+  VirtualClock clock;
+  mockInterruptPin pin0;
+  mockInterruptPin pin1;
+  SimMpu6050 handle(clock, &pin0);
+  SimMpu6050 platform(clock, &pin1);
+  handle.setAttitude(30, 0);
+  platform.setAttitude(0, 0);
+  mockSharedBus bus;
+  bus.addChip(handle, 0x68);
+  bus.addChip(platform, 0x69);
+
+  Mpu6050 handleMpu(bus, 0x68);
+  Mpu6050 platformMpu(bus, 0x69);
+  DataReadyMonitor handleReady(pin0);
+  DataReadyMonitor platformReady(pin1);
+  SensorGroup group(100000);
+  group.addSensor(handleMpu, handleReady);
+  group.addSensor(platformMpu, platformReady);
+  group.configure( mpu6050Config::forRate(1000, dlpfBandwidth::hz184) );
+  handleMpu.enableDataReadyInterrupt();
+  platformMpu.enableDataReadyInterrupt();
+
+  // the chips run on their own oscillators, so their samples don't line up
+  handleMpu.disableSleep();
+  clock.advance(1500);
+  platformMpu.disableSleep();
+
+  bus.reset();
+  uint_fast64_t start = clock.now_us();
+  unsigned int samples[2] = {0, 0};
+  uint_fast64_t previous[2] = {0, 0};
+  bool evenlySpaced = true;
+  while(clock.now_us() < start + 400000){
+    group.poll();
+    for(uint8_t i = 0; i < 2; i++){
+      Mpu6050Sample sample;
+      uint_fast64_t timestamp;
+      if(group.takeSample(i, sample, timestamp)){
+        if(samples[i] > 0 && timestamp - previous[i] != 4000){
+          evenlySpaced = false;
+        }
+        // the handle is tilted, the platform is level
+        REQUIRE( (sample.accY > 8000) == (i == 0) );
+        previous[i] = timestamp;
+        samples[i]++;
+      }
+    }
+    clock.advance(10);
+  }
+  REQUIRE( samples[0] == Approx(100).margin(1) );
+  REQUIRE( samples[1] == Approx(100).margin(1) );
+  REQUIRE( evenlySpaced );
+  REQUIRE( previous[0] % 4000 != previous[1] % 4000 );
+  REQUIRE( group.readMissed(0) == 0 );
+  REQUIRE( group.readMissed(1) == 0 );
+
+  // the bus was as busy as busLoad predicted
+  float busySeconds = bus.bits / 100000.0f;
+  REQUIRE( busySeconds / 0.4f == Approx(group.busLoad() / 100.0f).margin(0.01) );
+}
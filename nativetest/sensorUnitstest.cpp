@@ -0,0 +1,79 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "sensorUnits.hpp"
+#include "MPU6050.hpp"
+#include "mockI2cBus.hpp"
+#include <cmath>
+
+static const double GYRO_SENSITIVITIES[4] = {131.0, 65.5, 32.8, 16.4};
+
+// the largest difference between a conversion and the exact value, over every raw value
+template< typename F, typename R >
+static double worstError(F convert, R reference){
+  double worst = 0;
+  for(int32_t raw = -32768; raw < 32768; raw++){
+    double error = std::fabs(convert(static_cast<int16_t>(raw)) - reference(raw));
+    worst = error > worst ? error : worst;
+  }
+  return worst;
+}
+
+TEST_CASE( "fixed point accelerometer conversions round correctly in every range" ){
+  for(uint8_t range = 0; range < 4; range++){
+    auto exact = [&](int32_t raw){ return raw * 9810.0 / (16384 >> range); };
+    REQUIRE( worstError([&](int16_t raw){ return sensorUnits::fixedAccelero(raw, range); }, exact) <= 0.5 );
+    REQUIRE( worstError([&](int16_t raw){ return sensorUnits::floatAccelero(raw, range); }, exact) < 1.0 );
+  }
+}
+
+TEST_CASE( "fixed point gyroscope conversions are within half a unit plus the factor's rounding" ){
+  for(uint8_t range = 0; range < 4; range++){
+    auto exact = [&](int32_t raw){ return raw * 1000.0 / GYRO_SENSITIVITIES[range]; };
+    // the factor is off by at most 2^-17, which adds up to 0.25 over 32768 LSB
+    REQUIRE( worstError([&](int16_t raw){ return sensorUnits::fixedGyro(raw, range); }, exact) <= 0.75 );
+    REQUIRE( worstError([&](int16_t raw){ return sensorUnits::floatGyro(raw, range); }, exact) < 1.0 );
+  }
+}
+
+TEST_CASE( "fixed point temperature conversion matches the float reference" ){
+  auto exact = [](int32_t raw){ return raw * 1000.0 / 340 + 31530; };
+  REQUIRE( worstError([](int16_t raw){ return sensorUnits::fixedTemperature(raw); }, exact) <= 0.75 );
+  REQUIRE( worstError([](int16_t raw){ return sensorUnits::floatTemperature(raw); }, exact) < 1.0 );
+  REQUIRE( sensorUnits::fixedTemperature(0) == 31530 );
+}
+
+TEST_CASE( "fixed point and float conversions differ by at most one unit" ){
+  for(uint8_t range = 0; range < 4; range++){
+    for(int32_t raw = -32768; raw < 32768; raw += 7){
+      auto value = static_cast<int16_t>(raw);
+      REQUIRE( std::abs(sensorUnits::fixedAccelero(value, range) - sensorUnits::floatAccelero(value, range)) <= 1 );
+      REQUIRE( std::abs(sensorUnits::fixedGyro(value, range) - sensorUnits::floatGyro(value, range)) <= 1 );
+    }
+  }
+}
+
+TEST_CASE( "Mpu6050::readAllScaled uses the configured ranges" ){
+  mockI2cBus bus;
+  bus.setWord(0x3B, 4096);
+  bus.setWord(0x3D, -2048);
+  bus.setWord(0x3F, 0);
+  bus.setWord(0x41, 340);
+  bus.setWord(0x43, 328);
+  bus.setWord(0x45, -164);
+  bus.setWord(0x47, 0);
+  Mpu6050 mpu(bus, 0x68);
+  mpu.setAcceleroConfig(2);
+  mpu.setGyroConfig(2);
+
+  auto sample = mpu.readAllScaled();
+  REQUIRE( sample.accX == 9810 );
+  REQUIRE( sample.accY == -4905 );
+  REQUIRE( sample.accZ == 0 );
+  REQUIRE( sample.temperature == 32530 );
+  REQUIRE( sample.gyroX == 10000 );
+  REQUIRE( sample.gyroY == -5000 );
+}
@@ -0,0 +1,113 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "MPU6050.hpp"
+#include "stepper28BYJ48.hpp"
+#include "stepperEngine.hpp"
+#include "dataReadyMonitor.hpp"
+#include "virtualClock.hpp"
+#include "recordingPort.hpp"
+#include "simMpu6050.hpp"
+
+TEST_CASE( "VirtualClock only moves when told to and brings devices along" ){
+  VirtualClock clock;
+  SimMpu6050 sensor(clock);
+  REQUIRE( clock.now_us() == 0 );
+  clock.wait_us(1500);
+  clock.advance(500);
+  REQUIRE( clock.now_us() == 2000 );
+  REQUIRE( sensor.samplesTaken == 0 ); // still asleep
+
+  Mpu6050 mpu(sensor, 0x68);
+  mpu.disableSleep();
+  mpu.setConfig(1);
+  clock.advance(10000);
+  REQUIRE( sensor.samplesTaken == 10 );
+}
+
+TEST_CASE( "the blocking steppermotor functions step at the drive mode's speed limit in virtual time" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  stepper28BYJ48 motor(port, 4096, clock);
+
+  motor.turnCounterClockwise(300);
+  REQUIRE( port.log.size() == 300 );
+  REQUIRE( port.changes() == 299 );
+  REQUIRE( port.shortestInterval() == 650 );
+  REQUIRE( clock.now_us() == 300 * 650 );
+  REQUIRE( port.ratePerSecond() == Approx(1e6 / 650) );
+
+  port.log.clear();
+  motor.setDriveMode(driveMode::fullStep);
+  motor.turnClockwise(300);
+  REQUIRE( port.log.size() == 301 );
+  REQUIRE( port.shortestInterval() == 1000 );
+}
+
+TEST_CASE( "StepperEngine keeps its speed on the virtual clock" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  steppermotor motor(port, clock);
+  StepperEngine engine(motor);
+
+  engine.setSpeed(800);
+  while(clock.now_us() < 1000000){
+    engine.poll(clock.now_us());
+    clock.advance(10);
+  }
+  REQUIRE( engine.getPosition() == Approx(800).margin(1) );
+  REQUIRE( port.shortestInterval() >= 1250 );
+  REQUIRE( port.ratePerSecond() == Approx(800).epsilon(0.01) );
+}
+
+TEST_CASE( "an interrupt driven loop reads every simulated sample once with two transactions" ){
+  VirtualClock clock;
+  mockInterruptPin pin;
+  SimMpu6050 sensor(clock, &pin);
+  sensor.setAttitude(30, 0);
+  sensor.setRates(10, -20, 0);
+
+  Mpu6050 mpu(sensor, 0x68);
+  mpu.disableSleep();
+  mpu.setConfig(1);
+  mpu.enableDataReadyInterrupt();
+  DataReadyMonitor monitor(pin);
+
+  sensor.reset();
+  unsigned int samples = 0;
+  uint_fast64_t timestamp = 0;
+  Mpu6050Sample sample{};
+  while(clock.now_us() < 100000){
+    if(monitor.takeSample(timestamp)){
+      sample = mpu.readAll();
+      samples++;
+    }
+    clock.advance(10);
+  }
+  REQUIRE( samples == 100 );
+  REQUIRE( sensor.transactions == 2 * samples );
+  REQUIRE( monitor.readMissed() == 0 );
+  REQUIRE( sample.accY == Approx(8192).margin(1) );
+  REQUIRE( sample.accZ == Approx(14189).margin(1) );
+  REQUIRE( sample.gyroX == 1310 );
+  REQUIRE( sample.gyroY == -2620 );
+}
+
+TEST_CASE( "the simulated FIFO fills at the configured sample rate" ){
+  VirtualClock clock;
+  SimMpu6050 sensor(clock);
+  Mpu6050 mpu(sensor, 0x68);
+  mpu.disableSleep();
+  mpu.setConfig(0);
+  mpu.enableFifo();
+
+  clock.advance(5000); // 8kHz without the DLPF
+  Mpu6050Sample storage[128];
+  Mpu6050SampleBuffer buffer(storage, 128);
+  sensor.reset();
+  REQUIRE( mpu.readFifo(buffer) == 40 );
+  REQUIRE( sensor.transactions == 2 + 2 * 3 );
+}
@@ -0,0 +1,97 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "MPU6050.hpp"
+#include "staticMpu6050.hpp"
+#include "mockI2cBus.hpp"
+
+using mpu6050::accelRange;
+using mpu6050::gyroRange;
+
+// the conversion factors are known at compile time
+static_assert( StaticMpu6050< HwlibRegisterBus<>, 0x68, accelRange::g8 >::ACCEL_SENSITIVITY == 4096, "" );
+static_assert( StaticMpu6050< HwlibRegisterBus<>, 0x68, accelRange::g2 >::convertAccelero(16384) == 981, "" );
+static_assert( StaticMpu6050< HwlibRegisterBus<>, 0x68, accelRange::g16 >::convertAccelero(-2048) == -981, "" );
+static_assert( StaticMpu6050< HwlibRegisterBus<> >::convertTemperature(-340) == 30, "" );
+
+TEST_CASE( "a StaticMpu6050 only holds a reference to its bus" ){
+  REQUIRE( sizeof(StaticMpu6050< HwlibRegisterBus<> >) == sizeof(void *) );
+  REQUIRE( sizeof(StaticMpu6050< HwlibRegisterBus<> >) < sizeof(Mpu6050) );
+}
+
+TEST_CASE( "StaticMpu6050::init wakes the chip up and sets the ranges" ){
+  mockI2cBus bus;
+  bus.registers[0x6B] = 0x40;
+  HwlibRegisterBus<> registerBus(bus);
+  StaticMpu6050< HwlibRegisterBus<>, 0x69, accelRange::g4, gyroRange::dps2000 > mpu(registerBus);
+
+  mpu.init();
+  REQUIRE( bus.registers[0x6B] == 0 );
+  REQUIRE( bus.registers[0x1B] == 3 << 3 );
+  REQUIRE( bus.registers[0x1C] == 1 << 3 );
+  REQUIRE( bus.lastAddress == 0x69 );
+  REQUIRE( mpu.readRegister(0x75) == 0 );
+}
+
+template< accelRange ACCEL, gyroRange GYRO >
+static void compareWithMpu6050(){
+  mockI2cBus bus;
+  HwlibRegisterBus<> registerBus(bus);
+  StaticMpu6050< HwlibRegisterBus<>, 0x68, ACCEL, GYRO > fixed(registerBus);
+  fixed.init();
+  Mpu6050 dynamic(bus, 0x68);
+  dynamic.resyncConfig();
+
+  for(int32_t raw = -32768; raw < 32768; raw += 97){
+    int16_t value = static_cast<int16_t>(raw);
+    int16_t accelero = value;
+    dynamic.convertAccelero(accelero);
+    REQUIRE( fixed.convertAccelero(value) == accelero );
+    int16_t gyro = value;
+    dynamic.convertGyro(gyro);
+    // a multiplication by the reciprocal may round differently than the division
+    REQUIRE( std::abs(fixed.convertGyro(value) - gyro) <= 1 );
+  }
+}
+
+TEST_CASE( "StaticMpu6050 converts like Mpu6050 in every range" ){
+  compareWithMpu6050< accelRange::g2, gyroRange::dps250 >();
+  compareWithMpu6050< accelRange::g4, gyroRange::dps500 >();
+  compareWithMpu6050< accelRange::g8, gyroRange::dps1000 >();
+  compareWithMpu6050< accelRange::g16, gyroRange::dps2000 >();
+}
+
+TEST_CASE( "StaticMpu6050 reads the same measurements as Mpu6050 in fewer transactions" ){
+  mockI2cBus bus;
+  bus.setWord(0x3B, 1000);
+  bus.setWord(0x3D, -2000);
+  bus.setWord(0x3F, 16384);
+  bus.setWord(0x41, -340);
+  bus.setWord(0x43, 131);
+  bus.setWord(0x45, -262);
+  bus.setWord(0x47, 32767);
+  HwlibRegisterBus<> registerBus(bus);
+  StaticMpu6050< HwlibRegisterBus<> > fixed(registerBus);
+  Mpu6050 dynamic(bus, 0x68);
+
+  auto sample = fixed.readAll();
+  auto expected = dynamic.readAll();
+  REQUIRE( sample.accX == expected.accX );
+  REQUIRE( sample.accY == expected.accY );
+  REQUIRE( sample.temperature == expected.temperature );
+  REQUIRE( sample.gyroZ == expected.gyroZ );
+
+  bus.reset();
+  REQUIRE( fixed.readAccY() == dynamic.readAccY() );
+  auto both = bus.transactions;
+  bus.reset();
+  dynamic.readAccY();
+  REQUIRE( both - bus.transactions == 2 );
+  REQUIRE( bus.transactions > 2 );
+
+  REQUIRE( fixed.readGyroX() == dynamic.readGyroX() );
+  REQUIRE( fixed.readTemperature() == dynamic.readTemperature() );
+}
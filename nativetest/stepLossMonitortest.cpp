@@ -0,0 +1,125 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "stepLossMonitor.hpp"
+#include "gimbalSimulator.hpp"
+#include "mockPort.hpp"
+
+// 131 raw is 1 degree per second, the most sensitive range of the MPU6050.
+static const float SENSITIVITY = 131;
+static const float DEGREES_PER_STEP = 360.0f / 4096;
+
+// Turns an engine at 1000 steps per second for the given time, feeding the monitor every millisecond with a gyroscope
+// that sees the motor turn at the given part of that speed, plus the base turning at baseRate degrees per second.
+static int run(StepperEngine & engine, StepLossMonitor & monitor, uint_fast64_t & now, uint_fast64_t duration,
+  float part, float baseRate = 0)
+{
+  int slips = 0;
+  engine.setSpeed(1000);
+  float motorRate = 1000 * DEGREES_PER_STEP * part;
+  for(uint_fast64_t end = now + duration; now < end; now += 1000){
+    for(uint_fast64_t t = now; t < now + 1000; t += 50){
+      engine.poll(t);
+    }
+    int16_t gyro = static_cast<int16_t>((motorRate + baseRate) * SENSITIVITY);
+    int16_t baseGyro = static_cast<int16_t>(baseRate * SENSITIVITY);
+    slips += monitor.update(gyro, baseGyro, 1000);
+  }
+  return slips;
+}
+
+TEST_CASE( "StepLossMonitor leaves a motor alone that turns as far as it was told" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  StepLossMonitor monitor(engine, DEGREES_PER_STEP, SENSITIVITY, 1500);
+  REQUIRE( engine.getSpeedLimit() == 1500 );
+
+  uint_fast64_t now = 10000;
+  REQUIRE( run(engine, monitor, now, 1000000, 1.0f) == 0 );
+  REQUIRE( monitor.getSlips() == 0 );
+  REQUIRE( engine.getSpeedLimit() == 1500 );
+
+  // even with the base turning along, which the sensor on the base takes out
+  REQUIRE( run(engine, monitor, now, 1000000, 1.0f, 40) == 0 );
+  REQUIRE( engine.getSpeedLimit() == 1500 );
+}
+
+TEST_CASE( "StepLossMonitor lowers the speed limit of a motor that lost steps, and raises it again" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  StepLossMonitor monitor(engine, DEGREES_PER_STEP, SENSITIVITY, 1500);
+
+  // the rotor only manages half the steps
+  uint_fast64_t now = 10000;
+  REQUIRE( run(engine, monitor, now, 100000, 0.5f) > 0 );
+  REQUIRE( monitor.getSlips() > 0 );
+  REQUIRE( engine.getSpeedLimit() == monitor.getSpeedLimit() );
+  REQUIRE( engine.getSpeedLimit() < 1000 );
+  REQUIRE( engine.getSpeedLimit() >= 500 );
+
+  // a second without slipping raises the limit by RECOVERY
+  uint32_t lowered = engine.getSpeedLimit();
+  engine.setSpeed(0);
+  for(int i = 0; i < 1000; i++){
+    monitor.update(0, 0, 1000);
+  }
+  REQUIRE( engine.getSpeedLimit() == Approx(lowered + StepLossMonitor::RECOVERY).margin(2) );
+  for(int i = 0; i < 20000; i++){
+    monitor.update(0, 0, 1000);
+  }
+  REQUIRE( engine.getSpeedLimit() == 1500 );
+}
+
+TEST_CASE( "StepLossMonitor counts steps of a motor the gyroscope sees the other way around" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  StepLossMonitor monitor(engine, -DEGREES_PER_STEP, SENSITIVITY, 1500);
+
+  uint_fast64_t now = 10000;
+  REQUIRE( run(engine, monitor, now, 200000, -1.0f) == 0 );
+  REQUIRE( run(engine, monitor, now, 200000, -0.5f) > 0 );
+}
+
+TEST_CASE( "without a sensor on the base a moving base looks like lost steps" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  StepLossMonitor monitor(engine, DEGREES_PER_STEP, SENSITIVITY, 1500);
+
+  // the base turns against the motor, as it does when the stabilizer keeps up with it
+  uint_fast64_t now = 10000;
+  int slips = 0;
+  engine.setSpeed(1000);
+  for(uint_fast64_t end = now + 100000; now < end; now += 1000){
+    for(uint_fast64_t t = now; t < now + 1000; t += 50){
+      engine.poll(t);
+    }
+    slips += monitor.update(0, 0, 1000);
+  }
+  REQUIRE( slips > 0 );
+}
+
+TEST_CASE( "StepLossMonitors keep a stabilizer driven too hard from losing steps" ){
+  ControllerSettings settings;
+  settings.kp = 400;
+  settings.maxStepRate = 2500;
+  settings.maxSpeed = 2500;
+  settings.acceleration = 30000;
+  settings.stepLossMonitor = true;
+  GimbalSimulator simulator(Disturbance::step(10, -10));
+  SimulationReport report = simulator.run(settings, 1000000);
+  REQUIRE( report.slips > 0 );
+  REQUIRE( report.lostSteps < 100 );
+
+  // and don't see lost steps in a base that is only rocking
+  GimbalSimulator rocking(Disturbance::sine(5, 5, 1));
+  report = rocking.run(settings, 2000000);
+  REQUIRE( report.slips == 0 );
+  REQUIRE( report.lostSteps == 0 );
+}
@@ -0,0 +1,79 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "stepScheduler.hpp"
+#include "mockPort.hpp"
+
+TEST_CASE( "SpscQueue keeps order and refuses items when full" ){
+  SpscQueue<int, 4> queue;
+  int item = 0;
+  REQUIRE( queue.empty() );
+  REQUIRE_FALSE( queue.pop(item) );
+  REQUIRE( queue.push(1) );
+  REQUIRE( queue.push(2) );
+  REQUIRE( queue.push(3) );
+  REQUIRE_FALSE( queue.push(4) );
+
+  for(int round = 0; round < 10; round++){
+    REQUIRE( queue.pop(item) );
+    REQUIRE( item == round + 1 );
+    REQUIRE( queue.push(round + 4) );
+  }
+  REQUIRE_FALSE( queue.empty() );
+}
+
+TEST_CASE( "StepScheduler steps motors at their own rate from ticks only" ){
+  mockPort port0, port1;
+  steppermotor motor0(port0), motor1(port1);
+  StepScheduler scheduler;
+  auto m0 = scheduler.addMotor(motor0, 4);
+  auto m1 = scheduler.addMotor(motor1, 2);
+  REQUIRE( m0 == 0 );
+  REQUIRE( m1 == 1 );
+
+  REQUIRE( scheduler.post(m0, 3) );
+  REQUIRE( scheduler.post(m1, -3) );
+  REQUIRE( scheduler.getPosition(m0) == 0 );
+
+  // the fake timer: one tick per loop
+  uint16_t steps = 0;
+  for(int tick = 0; tick < 5; tick++){
+    steps += scheduler.tick();
+  }
+  REQUIRE( scheduler.getPosition(m0) == 2 );
+  REQUIRE( scheduler.getPosition(m1) == -3 );
+  REQUIRE( steps == 5 );
+  REQUIRE( port0.written == std::vector<uint8_t>{3, 2} );
+  REQUIRE( port1.written == std::vector<uint8_t>{9, 8, 12} );
+}
+
+TEST_CASE( "StepScheduler picks up new targets and speeds on the next tick" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepScheduler scheduler;
+  auto m = scheduler.addMotor(motor, 10);
+  scheduler.post(m, 100);
+  scheduler.tick();
+  REQUIRE( scheduler.getPosition(m) == 1 );
+
+  scheduler.post(m, -100, 1);
+  for(int tick = 0; tick < 20; tick++){
+    scheduler.tick();
+  }
+  // the pending countdown of the old speed finishes first
+  REQUIRE( scheduler.getPosition(m) == 1 - 11 );
+}
+
+TEST_CASE( "StepScheduler refuses unknown motors and too many motors" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepScheduler scheduler;
+  REQUIRE_FALSE( scheduler.post(0, 10) );
+  for(uint8_t i = 0; i < StepScheduler::MAX_MOTORS; i++){
+    REQUIRE( scheduler.addMotor(motor, 1) == i );
+  }
+  REQUIRE( scheduler.addMotor(motor, 1) == StepScheduler::MAX_MOTORS );
+}
@@ -0,0 +1,114 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "stepperEngine.hpp"
+#include "mockPort.hpp"
+
+TEST_CASE( "StepperEngine takes at most one step per poll" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor, 1000);
+  engine.setTarget(3);
+
+  REQUIRE( engine.poll(10000) );
+  REQUIRE( engine.getPosition() == 1 );
+  REQUIRE_FALSE( engine.poll(10000) );
+  REQUIRE_FALSE( engine.poll(10999) );
+  REQUIRE( engine.poll(11000) );
+  REQUIRE( engine.poll(12000) );
+  REQUIRE_FALSE( engine.poll(13000) );
+  REQUIRE_FALSE( engine.isMoving() );
+  REQUIRE( engine.getPosition() == 3 );
+  REQUIRE( port.written == std::vector<uint8_t>{3, 2, 6} );
+}
+
+TEST_CASE( "StepperEngine follows a changed target straight away" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor, 1000);
+  engine.setTarget(10);
+  engine.poll(10000);
+  engine.poll(11000);
+
+  engine.setTarget(-1);
+  REQUIRE( engine.poll(12000) );
+  REQUIRE( engine.getPosition() == 1 );
+  engine.poll(13000);
+  engine.poll(14000);
+  REQUIRE( engine.getPosition() == -1 );
+  REQUIRE( port.written == std::vector<uint8_t>{3, 2, 3, 1, 9} );
+
+  engine.move(2);
+  REQUIRE( engine.getTarget() == 1 );
+  engine.stop();
+  REQUIRE_FALSE( engine.poll(20000) );
+}
+
+TEST_CASE( "Several StepperEngines share one loop" ){
+  mockPort port0, port1;
+  steppermotor motor0(port0), motor1(port1);
+  StepperEngine engine0(motor0, 1000), engine1(motor1, 500);
+  engine0.setTarget(4);
+  engine1.setTarget(-4);
+
+  for(uint_fast64_t now = 10000; now < 12100; now += 100){
+    engine0.poll(now);
+    engine1.poll(now);
+  }
+  REQUIRE( engine0.getPosition() == 3 );
+  REQUIRE( engine1.getPosition() == -4 );
+}
+
+TEST_CASE( "StepperEngine in speed mode keeps turning at the given speed" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor);
+  engine.setSpeed(-500);
+  REQUIRE( engine.isMoving() );
+
+  int steps = 0;
+  for(uint_fast64_t now = 10000; now < 110000; now += 100){
+    steps += engine.poll(now);
+  }
+  REQUIRE( steps == 50 );
+  REQUIRE( engine.getPosition() == -50 );
+
+  engine.setSpeed(0);
+  REQUIRE_FALSE( engine.poll(200000) );
+  engine.move(2);
+  REQUIRE( engine.getTarget() == -48 );
+  REQUIRE( engine.getSpeed() == 0 );
+}
+
+TEST_CASE( "StepperEngine never steps faster than its speed limit" ){
+  mockPort port;
+  steppermotor motor(port);
+  StepperEngine engine(motor, 1000);
+  engine.setSpeedLimit(500);
+  REQUIRE( engine.getSpeedLimit() == 500 );
+
+  int steps = 0;
+  engine.setTarget(1000);
+  for(uint_fast64_t now = 10000; now < 110000; now += 100){
+    steps += engine.poll(now);
+  }
+  REQUIRE( steps == 50 );
+
+  steps = 0;
+  engine.setSpeed(-1000);
+  for(uint_fast64_t now = 110000; now < 210000; now += 100){
+    steps += engine.poll(now);
+  }
+  REQUIRE( steps == 50 );
+
+  // without a limit the speed is back
+  engine.setSpeedLimit(0);
+  steps = 0;
+  for(uint_fast64_t now = 210000; now < 310000; now += 100){
+    steps += engine.poll(now);
+  }
+  REQUIRE( steps == 100 );
+}
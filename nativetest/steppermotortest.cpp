@@ -0,0 +1,165 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "stepper28BYJ48.hpp"
+#include "stepperEngine.hpp"
+#include "virtualClock.hpp"
+#include "recordingPort.hpp"
+
+// the values written by n steps in the given direction
+static std::vector<uint8_t> sequence(steppermotor & motor, RecordingPort & port, int n, bool clockwise){
+  port.log.clear();
+  for(int i = 0; i < n; i++){
+    if(clockwise){
+      motor.stepClockwise();
+    }else{
+      motor.stepCounterClockwise();
+    }
+  }
+  std::vector<uint8_t> values;
+  for(auto & e : port.log){
+    values.push_back(e.value);
+  }
+  return values;
+}
+
+TEST_CASE( "every drive mode walks its sequence in both directions" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  steppermotor motor(port, clock);
+
+  REQUIRE( motor.getDriveMode() == driveMode::halfStep );
+  REQUIRE( sequence(motor, port, 8, true) == std::vector<uint8_t>{3, 2, 6, 4, 12, 8, 9, 1} );
+  REQUIRE( sequence(motor, port, 3, false) == std::vector<uint8_t>{9, 8, 12} );
+
+  // 12 is a full step phase, so nothing moves
+  port.log.clear();
+  motor.setDriveMode(driveMode::fullStep);
+  REQUIRE( port.log.empty() );
+  REQUIRE( sequence(motor, port, 5, true) == std::vector<uint8_t>{9, 3, 6, 12, 9} );
+  REQUIRE( sequence(motor, port, 2, false) == std::vector<uint8_t>{12, 6} );
+
+  // from 6 to the wave phase half a step counterclockwise
+  port.log.clear();
+  motor.setDriveMode(driveMode::wave);
+  REQUIRE( port.log.size() == 1 );
+  REQUIRE( port.log[0].value == 2 );
+  REQUIRE( sequence(motor, port, 4, true) == std::vector<uint8_t>{4, 8, 1, 2} );
+  REQUIRE( sequence(motor, port, 4, false) == std::vector<uint8_t>{1, 8, 4, 2} );
+}
+
+TEST_CASE( "every phase is a neighbour of the previous one" ){
+  for(auto mode : {driveMode::wave, driveMode::fullStep, driveMode::halfStep}){
+    auto & info = driveModes::info(mode);
+    for(uint8_t i = 0; i < info.length; i++){
+      uint8_t step = info.sequence[i];
+      uint8_t next = info.sequence[(i + 1) % info.length];
+      // the phase in the half step sequence moves by exactly halfSteps
+      int a = -1, b = -1;
+      for(int j = 0; j < 8; j++){
+        a = driveModes::HALF_STEP[j] == step ? j : a;
+        b = driveModes::HALF_STEP[j] == next ? j : b;
+      }
+      REQUIRE( (b - a + 8) % 8 == info.halfSteps );
+    }
+  }
+}
+
+TEST_CASE( "turning degrees takes half as many steps in the full step modes" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  stepper28BYJ48 motor(port, 4096, clock);
+
+  motor.turnClockwiseDegrees(90);
+  REQUIRE( port.log.size() == 1024 );
+  REQUIRE( clock.now_us() == 1024 * 650 );
+
+  motor.setDriveMode(driveMode::fullStep);
+  port.log.clear();
+  clock.advance(5000);
+  auto start = clock.now_us();
+  motor.turnCounterClockwiseDegrees(90);
+  REQUIRE( port.log.size() == 512 );
+  REQUIRE( motor.halfStepsPerStep() == 2 );
+  // a full step takes longer than a half step, but covers twice the angle
+  REQUIRE( clock.now_us() - start == 512 * 1000 );
+  REQUIRE( clock.now_us() - start < 1024 * 650 );
+}
+
+TEST_CASE( "the release idle policy switches the coils off and the next step continues the sequence" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  steppermotor motor(port, clock);
+  motor.setIdlePolicy(idlePolicy::release, 5000);
+
+  motor.stepClockwise();
+  motor.stepClockwise();
+  for(int i = 0; i < 100; i++){
+    motor.update(clock.now_us());
+    clock.advance(100);
+  }
+  REQUIRE_FALSE( motor.isEnergized() );
+  REQUIRE( port.log.back().value == 0 );
+  // switched off once, after 5ms
+  REQUIRE( port.log.size() == 3 );
+  REQUIRE( port.log[2].time == 5000 );
+
+  motor.stepClockwise();
+  REQUIRE( motor.isEnergized() );
+  REQUIRE( port.log.back().value == 6 );
+}
+
+TEST_CASE( "the pulse idle policy energizes the coils the given part of the time" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  steppermotor motor(port, clock);
+  motor.setIdlePolicy(idlePolicy::pulse, 1000, 25, 2000);
+
+  motor.stepCounterClockwise();
+  for(int i = 0; i < 2000; i++){
+    motor.update(clock.now_us());
+    clock.advance(10);
+  }
+  // on for the first 1ms, then the last 500us of every 2ms, the last period ending 10us early
+  REQUIRE( motor.getMeasuredTime() == 19990 );
+  REQUIRE( motor.getEnergizedTime() == 1000 + 9 * 500 );
+  for(auto & e : port.log){
+    REQUIRE( (e.value == 9 || e.value == 0) );
+  }
+
+  motor.resetEnergizedTime();
+  REQUIRE( motor.getEnergizedTime() == 0 );
+  motor.stepCounterClockwise();
+  REQUIRE( port.log.back().value == 8 );
+}
+
+TEST_CASE( "the hold idle policy keeps the coils on and a StepperEngine measures it" ){
+  VirtualClock clock;
+  RecordingPort port(clock);
+  stepper28BYJ48 motor(port, 4096, clock);
+  StepperEngine engine(motor);
+
+  // nothing is energized before the first step
+  engine.poll(clock.now_us());
+  clock.advance(1000);
+  engine.poll(clock.now_us());
+  REQUIRE( motor.getEnergizedTime() == 0 );
+
+  engine.setTarget(3);
+  while(clock.now_us() < 101000){
+    engine.poll(clock.now_us());
+    clock.advance(50);
+  }
+  REQUIRE( engine.getPosition() == 3 );
+  REQUIRE( motor.isEnergized() );
+  // the last poll was at 100950, the first step at 1000
+  REQUIRE( motor.getMeasuredTime() == 100950 );
+  REQUIRE( motor.getEnergizedTime() == 99950 );
+
+  motor.setIdlePolicy(idlePolicy::release, 10000);
+  engine.poll(clock.now_us());
+  REQUIRE_FALSE( motor.isEnergized() );
+}
@@ -0,0 +1,232 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "telemetry.hpp"
+#include "simUart.hpp"
+#include <vector>
+
+// Feeds bytes to a reader and keeps the good packets.
+static std::vector<TelemetryMessage> readAll(TelemetryReader & reader, const std::vector<uint8_t> & bytes){
+  std::vector<TelemetryMessage> messages;
+  TelemetryMessage message;
+  for(uint8_t b : bytes){
+    if(reader.feed(b, message) == TelemetryReader::result::packet){
+      messages.push_back(message);
+    }
+  }
+  return messages;
+}
+
+// Drains a Telemetry completely through a port that is never busy.
+struct instantPort {
+  std::vector<uint8_t> bytes;
+  bool busy() const { return false; }
+  void send(const uint8_t data[], size_t n){ bytes.insert(bytes.end(), data, data + n); }
+};
+
+static void drainAll(Telemetry & telemetry, instantPort & port){
+  while(telemetry.size() > 0){
+    telemetry.drain(port);
+  }
+  telemetry.drain(port);
+}
+
+TEST_CASE( "crc16 is CRC-16/CCITT-FALSE" ){
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  REQUIRE( telemetryFormat::crc16(check, 9) == 0x29B1 );
+  REQUIRE( telemetryFormat::crc16(check, 0) == 0xFFFF );
+}
+
+TEST_CASE( "COBS takes the zeros out and puts them back" ){
+  SECTION( "short packets with zeros" ){
+    const uint8_t data[] = {0x11, 0x00, 0x00, 0x22, 0x33, 0x00};
+    uint8_t frame[telemetryFormat::frameSize(6)];
+    size_t n = telemetryFormat::encode(data, 6, frame);
+    REQUIRE( n == telemetryFormat::frameSize(6) );
+    const uint8_t expected[] = {0x02, 0x11, 0x01, 0x03, 0x22, 0x33, 0x01, 0x00};
+    for(size_t i = 0; i < n; i++){
+      REQUIRE( frame[i] == expected[i] );
+    }
+    uint8_t decoded[8];
+    REQUIRE( telemetryFormat::decode(frame, n - 1, decoded) == 6 );
+    for(size_t i = 0; i < 6; i++){
+      REQUIRE( decoded[i] == data[i] );
+    }
+  }
+
+  SECTION( "runs longer than 254 bytes" ){
+    uint8_t data[600];
+    for(size_t i = 0; i < 600; i++){
+      data[i] = i % 300 == 299 ? 0 : (i % 251) + 1;
+    }
+    for(size_t n : {253, 254, 255, 508, 600}){
+      uint8_t frame[telemetryFormat::frameSize(600)];
+      size_t length = telemetryFormat::encode(data, n, frame);
+      REQUIRE( length <= telemetryFormat::frameSize(n) );
+      REQUIRE( frame[length - 1] == 0 );
+      for(size_t i = 0; i < length - 1; i++){
+        REQUIRE( frame[i] != 0 );
+      }
+      uint8_t decoded[600];
+      REQUIRE( telemetryFormat::decode(frame, length - 1, decoded) == n );
+      for(size_t i = 0; i < n; i++){
+        REQUIRE( decoded[i] == data[i] );
+      }
+    }
+  }
+
+  SECTION( "broken frames" ){
+    const uint8_t cut[] = {0x05, 0x11, 0x22};
+    uint8_t decoded[8];
+    REQUIRE( telemetryFormat::decode(cut, 3, decoded) == 0 );
+  }
+}
+
+TEST_CASE( "loop packets arrive with everything in them" ){
+  uint8_t storage[256];
+  Telemetry telemetry(storage, sizeof(storage));
+  instantPort port;
+  Mpu6050Sample sample{100, -200, 16384, 0, -1, 0, 32767};
+  REQUIRE( telemetry.sendLoop(123456789, sample, 12.34f, -5.5f, -1500, 70000) );
+  REQUIRE( telemetry.sendLoop(123457789, sample, 0, 0, 0, 0) );
+  drainAll(telemetry, port);
+  REQUIRE( port.bytes[0] == 0 );
+  REQUIRE( port.bytes.size() == 1 + 2 * telemetryFormat::frameSize(telemetryFormat::HEADER_SIZE + telemetryFormat::LOOP_PAYLOAD + 2) );
+
+  TelemetryReader reader;
+  auto messages = readAll(reader, port.bytes);
+  REQUIRE( messages.size() == 2 );
+  REQUIRE( messages[0].type == TELEMETRY_LOOP );
+  REQUIRE( messages[0].sequence == 0 );
+  REQUIRE( messages[1].sequence == 1 );
+  REQUIRE( messages[0].time == 123456789 );
+  TelemetryLoop loop;
+  REQUIRE( messages[0].decodeLoop(loop) );
+  REQUIRE( loop.accX == 100 );
+  REQUIRE( loop.accY == -200 );
+  REQUIRE( loop.accZ == 16384 );
+  REQUIRE( loop.gyroX == -1 );
+  REQUIRE( loop.gyroZ == 32767 );
+  REQUIRE( loop.roll == 1234 );
+  REQUIRE( loop.pitch == -550 );
+  REQUIRE( loop.pitchSpeed == -1500 );
+  REQUIRE( loop.rollSpeed == 32767 );
+  REQUIRE( reader.received == 2 );
+  REQUIRE( reader.lost == 0 );
+  REQUIRE( reader.corrupted == 0 );
+}
+
+TEST_CASE( "a full ring drops whole packets and the reader counts them" ){
+  uint8_t storage[100];
+  Telemetry telemetry(storage, sizeof(storage));
+  instantPort port;
+  const uint8_t payload[20] = {};
+  unsigned int queued = 0;
+  for(int i = 0; i < 10; i++){
+    queued += telemetry.send(TELEMETRY_USER, i, payload, 20);
+  }
+  // a packet with 20 zeros takes 31 bytes, after the first zero 3 fit
+  REQUIRE( queued == 3 );
+  REQUIRE( telemetry.sent() == 3 );
+  REQUIRE( telemetry.dropped() == 7 );
+  drainAll(telemetry, port);
+  REQUIRE( telemetry.send(TELEMETRY_USER, 10, payload, 20) );
+  drainAll(telemetry, port);
+
+  TelemetryReader reader;
+  auto messages = readAll(reader, port.bytes);
+  REQUIRE( messages.size() == 4 );
+  REQUIRE( messages[3].sequence == 10 );
+  REQUIRE( messages[3].length == 20 );
+  REQUIRE( reader.lost == 7 );
+}
+
+TEST_CASE( "the reader skips text and survives damaged packets" ){
+  uint8_t storage[256];
+  Telemetry telemetry(storage, sizeof(storage));
+  instantPort port;
+  for(const char *c = "hello"; *c != 0; c++){
+    port.bytes.push_back(*c);
+  }
+  const uint8_t payload[3] = {1, 2, 3};
+  for(int i = 0; i < 3; i++){
+    telemetry.send(TELEMETRY_USER + 1, i, payload, 3);
+  }
+  drainAll(telemetry, port);
+  // flip a bit in the payload of the second packet, which starts after the text, the first zero and the first packet
+  size_t second = 5 + 1 + telemetryFormat::frameSize(telemetryFormat::HEADER_SIZE + 3 + 2);
+  port.bytes[second + 9] ^= 0x10;
+
+  TelemetryReader reader;
+  auto messages = readAll(reader, port.bytes);
+  REQUIRE( messages.size() == 2 );
+  REQUIRE( messages[0].sequence == 0 );
+  REQUIRE( messages[1].sequence == 2 );
+  REQUIRE( messages[1].payload[2] == 3 );
+  REQUIRE( reader.corrupted == 1 );
+  REQUIRE( reader.lost == 1 );
+}
+
+TEST_CASE( "a 1kHz loop streams every packet over a 400000 baud port without waiting" ){
+  VirtualClock clock;
+  SimUart uart(clock, 400000);
+  uint8_t storage[1024];
+  Telemetry telemetry(storage, sizeof(storage));
+  Mpu6050Sample sample{1, 2, 3, 4, 5, 6, 7};
+
+  // 1000 loop passes a second, polled every 50us
+  for(uint32_t now = 0; now < 1000000; now += 50){
+    if(now % 1000 == 0){
+      sample.gyroX = now / 1000;
+      telemetry.sendLoop(now, sample, 1.0f, -1.0f, 500, -500);
+    }
+    telemetry.drain(uart);
+    clock.advance(50);
+  }
+  clock.advance(10000);
+  telemetry.drain(uart);
+
+  REQUIRE( telemetry.dropped() == 0 );
+  TelemetryReader reader;
+  auto messages = readAll(reader, uart.received);
+  REQUIRE( messages.size() == 1000 );
+  REQUIRE( reader.lost == 0 );
+  TelemetryLoop loop;
+  REQUIRE( messages[999].decodeLoop(loop) );
+  REQUIRE( loop.gyroX == 999 );
+  REQUIRE( messages[999].time == 999000 );
+}
+
+TEST_CASE( "a slow port drops packets instead of slowing the loop down" ){
+  VirtualClock clock;
+  SimUart uart(clock, 115200);
+  uint8_t storage[1024];
+  Telemetry telemetry(storage, sizeof(storage));
+  Mpu6050Sample sample{};
+
+  for(uint32_t now = 0; now < 1000000; now += 50){
+    if(now % 1000 == 0){
+      telemetry.sendLoop(now, sample, 0, 0, 0, 0);
+    }
+    telemetry.drain(uart);
+    clock.advance(50);
+  }
+  clock.advance(100000);
+  telemetry.drain(uart);
+  telemetry.drain(uart);
+  clock.advance(100000);
+
+  TelemetryReader reader;
+  auto messages = readAll(reader, uart.received);
+  // 11520 bytes a second of 31 byte packets
+  // 11520 bytes a second carry about 370 packets of 31 bytes, plus what was left in the ring at the end
+  REQUIRE( messages.size() == telemetry.sent() );
+  REQUIRE( messages.size() < 420 );
+  REQUIRE( telemetry.sent() + telemetry.dropped() == 1000 );
+  // the ones dropped after the last packet that came through don't leave a gap
+  REQUIRE( reader.lost <= telemetry.dropped() );
+  REQUIRE( reader.corrupted == 0 );
+}
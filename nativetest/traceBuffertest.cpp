@@ -0,0 +1,72 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "catch.hpp"
+#include "traceBuffer.hpp"
+#include <vector>
+
+static uint32_t fakeTime = 0;
+
+static uint32_t fakeClock(){
+  return fakeTime;
+}
+
+TEST_CASE( "TraceBuffer keeps the newest events when it wraps around" ){
+  TraceEvent storage[10]; // rounded down to 8
+  TraceBuffer trace(storage, 10, fakeClock, 1000000);
+  for(uint32_t i = 0; i < 20; i++){
+    fakeTime = i * 10;
+    trace.record(TRACE_USER, i);
+  }
+  REQUIRE( trace.size() == 8 );
+  REQUIRE( trace.lost() == 12 );
+  REQUIRE( trace[0].payload == 12 );
+  REQUIRE( trace[0].timestamp == 120 );
+  REQUIRE( trace[7].payload == 19 );
+
+  trace.enable(false);
+  trace.record(TRACE_USER, 99);
+  REQUIRE( trace[7].payload == 19 );
+  trace.clear();
+  REQUIRE( trace.size() == 0 );
+}
+
+TEST_CASE( "a dump read by TraceReader gives back every event" ){
+  TraceEvent storage[16];
+  TraceBuffer trace(storage, 16, fakeClock, 84000000);
+  for(uint32_t i = 0; i < 5; i++){
+    fakeTime = 0xFFFFFF00u + i * 100; // wraps around halfway
+    trace.record(i % 2 ? TRACE_PITCH_COMMAND : TRACE_LOOP_TICK, -static_cast<int32_t>(i));
+  }
+
+  std::vector<uint8_t> bytes = {'h', 'i', '\n', 'T', 'R'};
+  trace.dump([&](uint8_t b){ bytes.push_back(b); });
+  REQUIRE( bytes.size() == 5 + 4 + 8 + 5 * 9 + 2 );
+
+  TraceReader reader;
+  TraceEvent e;
+  std::vector<TraceEvent> events;
+  TraceReader::result last = TraceReader::result::nothing;
+  for(uint8_t b : bytes){
+    last = reader.feed(b, e);
+    if(last == TraceReader::result::event){
+      events.push_back(e);
+    }
+  }
+  REQUIRE( last == TraceReader::result::done );
+  REQUIRE( reader.clockHz == 84000000 );
+  REQUIRE( events.size() == 5 );
+  for(uint32_t i = 0; i < 5; i++){
+    REQUIRE( events[i].timestamp == static_cast<uint32_t>(0xFFFFFF00u + i * 100) );
+    REQUIRE( events[i].id == (i % 2 ? TRACE_PITCH_COMMAND : TRACE_LOOP_TICK) );
+    REQUIRE( static_cast<int32_t>(events[i].payload) == -static_cast<int32_t>(i) );
+  }
+
+  bytes[20] ^= 0x01;
+  for(uint8_t b : bytes){
+    last = reader.feed(b, e);
+  }
+  REQUIRE( last == TraceReader::result::error );
+}
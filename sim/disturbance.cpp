@@ -0,0 +1,100 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "disturbance.hpp"
+#include <math.h>
+#include <random>
+
+const int Disturbance::SHAKE_WAVES;
+
+namespace {
+
+const float TWO_PI = 2 * 3.14159265f;
+
+}
+
+Disturbance::Disturbance(shape kind, float roll, float pitch):
+  kind( kind ),
+  roll( roll ),
+  pitch( pitch ),
+  at( 0 ),
+  duration( 0 ),
+  frequencies{},
+  phases{}
+{}
+
+Disturbance Disturbance::none(){
+  return Disturbance(shape::none, 0, 0);
+}
+
+Disturbance Disturbance::step(float roll, float pitch, uint_fast64_t at, uint_fast64_t duration){
+  Disturbance d(shape::step, roll, pitch);
+  d.at = at;
+  d.duration = duration > 0 ? duration : 1;
+  return d;
+}
+
+Disturbance Disturbance::sine(float roll, float pitch, float frequency){
+  Disturbance d(shape::sine, roll, pitch);
+  d.frequencies[0] = frequency;
+  return d;
+}
+
+Disturbance Disturbance::shake(float amplitude, uint32_t seed){
+  Disturbance d(shape::shake, amplitude / SHAKE_WAVES, amplitude / SHAKE_WAVES);
+  std::mt19937 random(seed);
+  std::uniform_real_distribution<float> frequency(0.5f, 3.0f);
+  std::uniform_real_distribution<float> phase(0.0f, TWO_PI);
+  for(int i = 0; i < SHAKE_WAVES; i++){
+    d.frequencies[i] = frequency(random);
+    d.phases[i] = phase(random);
+  }
+  return d;
+}
+
+void Disturbance::angles(uint_fast64_t t, float & roll, float & pitch) const {
+  float seconds = t / 1e6f;
+  switch(kind){
+    case shape::step: {
+      float progress = 0;
+      if(t >= at + duration){
+        progress = 1;
+      }else if(t > at){
+        // half a cosine, so the base starts and stops without a jerk
+        progress = 0.5f - 0.5f * cosf(3.14159265f * (t - at) / duration);
+      }
+      roll = this->roll * progress;
+      pitch = this->pitch * progress;
+      return;
+    }
+    case shape::sine:
+      roll = this->roll * sinf(TWO_PI * frequencies[0] * seconds);
+      pitch = this->pitch * sinf(TWO_PI * frequencies[0] * seconds);
+      return;
+    case shape::shake:
+      roll = 0;
+      pitch = 0;
+      for(int i = 0; i < SHAKE_WAVES; i++){
+        roll += this->roll * sinf(TWO_PI * frequencies[i] * seconds + phases[i]);
+        pitch += this->pitch * sinf(TWO_PI * frequencies[(i + 1) % SHAKE_WAVES] * seconds + phases[i] * 2);
+      }
+      return;
+    default:
+      roll = 0;
+      pitch = 0;
+      return;
+  }
+}
+
+uint_fast64_t Disturbance::settledAfter() const {
+  switch(kind){
+    case shape::none:
+      return 0;
+    case shape::step:
+      return at + duration;
+    default:
+      return UINT_FAST64_MAX;
+  }
+}
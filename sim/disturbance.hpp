@@ -0,0 +1,61 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef DISTURBANCE_HPP
+#define DISTURBANCE_HPP
+
+#include <stdint.h>
+
+/// @file
+
+/// A scripted movement of the base of the gimbal, the hand holding it.
+///
+/// Gives the roll and pitch of the base in degrees at any time in microseconds. Made with one of the
+/// static functions, which each describe a kind of movement a stabilizer has to cope with.
+class Disturbance {
+public:
+  /// The amount of sines a shake is made of.
+  static const int SHAKE_WAVES = 4;
+
+private:
+  enum class shape { none, step, sine, shake };
+  shape kind;
+
+  /// The amplitudes in degrees, the size of the step for a step.
+  float roll;
+  float pitch;
+
+  /// When a step starts and how long it takes, in microseconds.
+  uint_fast64_t at;
+  uint_fast64_t duration;
+
+  /// The frequencies in Hz and phases in radians of the sines.
+  float frequencies[SHAKE_WAVES];
+  float phases[SHAKE_WAVES];
+
+  Disturbance(shape kind, float roll, float pitch);
+
+public:
+  /// A base that doesn't move.
+  static Disturbance none();
+
+  /// A base that tilts by roll and pitch degrees at time at, smoothly, in duration microseconds.
+  static Disturbance step(float roll, float pitch, uint_fast64_t at = 100000, uint_fast64_t duration = 50000);
+
+  /// A base that rocks back and forth around both axes at once, with the given amplitudes in degrees and frequency in Hz.
+  static Disturbance sine(float roll, float pitch, float frequency);
+
+  /// A base held by a shaky hand: on both axes a sum of sines between 0.5Hz and 3Hz with random phases,
+  /// together no more than amplitude degrees. The same seed gives the same shake.
+  static Disturbance shake(float amplitude, uint32_t seed = 1);
+
+  /// Sets roll and pitch to the attitude of the base at time t.
+  void angles(uint_fast64_t t, float & roll, float & pitch) const;
+
+  /// Returns the time after which the base doesn't move any more, or UINT_FAST64_MAX when it keeps moving.
+  uint_fast64_t settledAfter() const;
+};
+
+#endif
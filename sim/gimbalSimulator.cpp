@@ -0,0 +1,168 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "gimbalSimulator.hpp"
+#include "MPU6050.hpp"
+#include "dataReadyMonitor.hpp"
+#include "attitudeEstimator.hpp"
+#include "pidController.hpp"
+#include "motionProfile.hpp"
+#include "stepper28BYJ48.hpp"
+#include "stepperEngine.hpp"
+#include "stabilizer.hpp"
+#include "stepLossMonitor.hpp"
+#include "mpu6050Calibrator.hpp"
+#include <math.h>
+
+namespace {
+
+// The time between two runs of the control loop, in microseconds.
+const uint_fast64_t LOOP_PERIOD = 10;
+
+// The time the loop waits for the first sample, in microseconds.
+const uint_fast64_t STARTUP = 5000;
+
+}
+
+GimbalSimulator::GimbalSimulator(const Disturbance & disturbance, const StepperParameters & motor):
+  pitchMotor( clock, motor ),
+  rollMotor( clock, motor ),
+  sensor( clock, &intPin ),
+  baseSensor( clock ),
+  disturbance( disturbance )
+{
+  sensor.setNoise(0.003f, 0.03f);
+  sensor.setGyroBias(0.8f, -1.1f, 0.4f);
+  sensor.setAccelBias(0.02f, -0.01f, 0.03f);
+  baseSensor.setNoise(0.003f, 0.03f, 2);
+  baseSensor.setGyroBias(-0.5f, 0.7f, 0.2f);
+  clock.addDevice(*this);
+}
+
+SimMpu6050 & GimbalSimulator::getSensor(){
+  return sensor;
+}
+
+float GimbalSimulator::getRoll() const {
+  return roll;
+}
+
+float GimbalSimulator::getPitch() const {
+  return pitch;
+}
+
+void GimbalSimulator::advanceTo(uint_fast64_t now){
+  float newBaseRoll, newBasePitch;
+  disturbance.angles(now > origin ? now - origin : 0, newBaseRoll, newBasePitch);
+  float newRoll = newBaseRoll + rollMotor.getAngle();
+  float newPitch = newBasePitch - pitchMotor.getAngle();
+  if(now > lastUpdate){
+    // for the small tilts of a stabilized platform the angular velocity is the change of roll and pitch
+    float seconds = (now - lastUpdate) / 1e6f;
+    sensor.setRates((newRoll - roll) / seconds, (newPitch - pitch) / seconds, 0);
+    baseSensor.setRates((newBaseRoll - baseRoll) / seconds, (newBasePitch - basePitch) / seconds, 0);
+  }
+  sensor.setAttitude(newRoll, newPitch);
+  baseSensor.setAttitude(newBaseRoll, newBasePitch);
+  roll = newRoll;
+  pitch = newPitch;
+  baseRoll = newBaseRoll;
+  basePitch = newBasePitch;
+  lastUpdate = now;
+}
+
+SimulationReport GimbalSimulator::run(const ControllerSettings & settings, uint_fast64_t duration, float tolerance){
+  Mpu6050 mpu(sensor, 0x68);
+  mpu.disableSleep();
+  mpu.configure(settings.sampling);
+  mpu.enableDataReadyInterrupt();
+  DataReadyMonitor dataReady(intPin);
+  if(settings.calibrate){
+    // the base stands still until origin
+    origin = UINT_FAST64_MAX;
+    Mpu6050Calibrator calibrator(mpu, clock);
+    Mpu6050Offsets offsets;
+    while(!calibrator.measure(offsets)){}
+    calibrator.apply(offsets);
+    origin = clock.now_us();
+  }
+
+  stepper28BYJ48 pitchStepper(pitchMotor, 4096, clock);
+  stepper28BYJ48 rollStepper(rollMotor, 4096, clock);
+  pitchStepper.setIdlePolicy(settings.idle, settings.idleTime, settings.idleDuty);
+  rollStepper.setIdlePolicy(settings.idle, settings.idleTime, settings.idleDuty);
+  MotionProfile profile(settings.maxSpeed, settings.acceleration, settings.jerk, settings.startSpeed);
+  StepperEngine pitchEngine(pitchStepper);
+  StepperEngine rollEngine(rollStepper);
+  pitchEngine.setProfile(profile);
+  rollEngine.setProfile(profile);
+
+  ComplementaryFilter complementary(mpu.readGyroConfig());
+  MadgwickFilter madgwick(mpu.readGyroConfig());
+  AttitudeEstimator & estimator = settings.madgwick
+    ? static_cast<AttitudeEstimator &>(madgwick)
+    : static_cast<AttitudeEstimator &>(complementary);
+  PidController pitchPid(settings.kp, settings.ki, settings.kd, settings.maxStepRate, 10000, settings.deadband);
+  PidController rollPid(settings.kp, settings.ki, settings.kd, settings.maxStepRate, 10000, settings.deadband);
+  Stabilizer stabilizer(mpu, dataReady, estimator, pitchPid, rollPid, pitchEngine, rollEngine);
+
+  Mpu6050 baseMpu(baseSensor, 0x68);
+  baseMpu.disableSleep();
+  baseMpu.configure(settings.sampling);
+  // the pitch motor turns the pitch down, so the gyroscope sees its steps the other way around
+  StepLossMonitor pitchMonitor(pitchEngine, -360.0f / 4096, mpu.readGyroConfig(), settings.maxSpeed, settings.startSpeed);
+  StepLossMonitor rollMonitor(rollEngine, 360.0f / 4096, mpu.readGyroConfig(), settings.maxSpeed, settings.startSpeed);
+  if(settings.stepLossMonitor){
+    stabilizer.setStepLossMonitors(&pitchMonitor, &rollMonitor, &baseMpu);
+  }
+
+  clock.advance(STARTUP);
+  uint_fast64_t begin = clock.now_us();
+  stabilizer.start(begin);
+
+  SimulationReport report;
+  double squares = 0;
+  unsigned long count = 0;
+  uint_fast64_t lastOutside = 0;
+  bool outside = false;
+  while(clock.now_us() - begin < duration){
+    if(stabilizer.poll(clock.now_us())){
+      report.samples++;
+    }
+    clock.advance(LOOP_PERIOD);
+
+    squares += roll * roll + pitch * pitch;
+    count++;
+    float error = fabsf(roll) > fabsf(pitch) ? fabsf(roll) : fabsf(pitch);
+    if(error > report.maxError){
+      report.maxError = error;
+    }
+    outside = error > tolerance;
+    if(outside){
+      lastOutside = clock.now_us();
+    }
+  }
+
+  report.rmsError = count > 0 ? sqrt(squares / count) : 0;
+  report.steps = pitchMotor.steps + rollMotor.steps;
+  report.lostSteps = pitchMotor.lostSteps + rollMotor.lostSteps;
+  report.slips = settings.stepLossMonitor ? pitchMonitor.getSlips() + rollMonitor.getSlips() : 0;
+  uint_fast64_t measured = pitchStepper.getMeasuredTime() + rollStepper.getMeasuredTime();
+  report.energized = measured > 0
+    ? static_cast<float>(pitchStepper.getEnergizedTime() + rollStepper.getEnergizedTime()) / measured
+    : 0;
+  uint_fast64_t settledAfter = disturbance.settledAfter();
+  if(settledAfter != UINT_FAST64_MAX){
+    settledAfter += origin;
+  }
+  if(outside || settledAfter == UINT_FAST64_MAX){
+    report.settlingTime = -1;
+  }else if(lastOutside <= settledAfter){
+    report.settlingTime = 0;
+  }else{
+    report.settlingTime = lastOutside - settledAfter;
+  }
+  return report;
+}
@@ -0,0 +1,141 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef GIMBALSIMULATOR_HPP
+#define GIMBALSIMULATOR_HPP
+
+#include "virtualClock.hpp"
+#include "simMpu6050.hpp"
+#include "simStepper.hpp"
+#include "disturbance.hpp"
+#include "steppermotor.hpp"
+#include "mpu6050Config.hpp"
+
+/// @file
+
+/// Everything about the control loop that can be tuned, with the values applicatie uses as defaults.
+struct ControllerSettings {
+  /// The PID gains, from degrees of tilt to steps per second.
+  float kp = 150;
+  float ki = 10;
+  float kd = 2;
+
+  /// Errors smaller than this many degrees are ignored.
+  float deadband = 0.05f;
+
+  /// The step rate the PID controllers are limited to.
+  float maxStepRate = 1500;
+
+  /// The MotionProfile of both motors.
+  float maxSpeed = 1500;
+  float acceleration = 8000;
+  float jerk = 100000;
+  float startSpeed = 500;
+
+  /// Whether to use the MadgwickFilter instead of the ComplementaryFilter.
+  bool madgwick = false;
+
+  /// The output rate, DLPF and full scale ranges of the MPU6050.
+  Mpu6050Config sampling = {dlpfBandwidth::hz184, 0, 0, 0};
+
+  /// Whether to calibrate the MPU6050 with a Mpu6050Calibrator before the base starts moving.
+  bool calibrate = false;
+
+  /// The idle policy of both motors, see steppermotor::setIdlePolicy.
+  /// SimStepper doesn't simulate a load turning a motor whose coils are off, so only the power side shows.
+  idlePolicy idle = idlePolicy::hold;
+  uint32_t idleTime = 100000;
+  uint8_t idleDuty = 25;
+
+  /// Whether to watch both motors with a StepLossMonitor, against an MPU6050 on the base, which lowers the
+  /// speed limit of a motor that loses steps to below maxSpeed.
+  bool stepLossMonitor = false;
+};
+
+/// The numbers a simulation run is judged by.
+struct SimulationReport {
+  /// The root mean square of the platform's tilt in degrees, both axes together.
+  float rmsError = 0;
+
+  /// The largest tilt of the platform around either axis in degrees.
+  float maxError = 0;
+
+  /// How long after the base stopped moving the tilt last left the tolerance, in microseconds.
+  /// 0 when it never did, -1 when the tilt was still too large at the end or the base never stopped.
+  int64_t settlingTime = -1;
+
+  /// The half steps commanded and lost, both motors together.
+  unsigned int steps = 0;
+  unsigned int lostSteps = 0;
+
+  /// The amount of times a StepLossMonitor noticed lost steps, both motors together.
+  unsigned int slips = 0;
+
+  /// The amount of samples the control loop used.
+  unsigned int samples = 0;
+
+  /// The part of the time the coils were energized, averaged over both motors, between 0 and 1.
+  float energized = 0;
+};
+
+/// The gimbal on a virtual clock: two motors, a platform and an MPU6050 on it, with the real control loop.
+///
+/// The base is moved by a Disturbance. The pitch motor and the roll motor are SimSteppers, which carry the
+/// inertia of the platform and lose steps when driven too hard. The platform's attitude is the base's attitude
+/// corrected by the motors (the pitch motor turns the pitch down, the roll motor turns the roll up, like
+/// the Stabilizer expects) and is what the SimMpu6050 measures, with noise and a gyroscope bias.
+/// A second SimMpu6050 on the base measures the base's attitude, for the StepLossMonitors.
+///
+/// run builds the same Mpu6050, DataReadyMonitor, AttitudeEstimator, PidControllers, MotionProfile,
+/// StepperEngines and Stabilizer as applicatie does, but on the simulated hardware, and reports how
+/// well the platform was kept level. Only run once per GimbalSimulator.
+class GimbalSimulator : public SimDevice {
+private:
+  VirtualClock clock;
+  mockInterruptPin intPin;
+  SimStepper pitchMotor;
+  SimStepper rollMotor;
+  SimMpu6050 sensor;
+  SimMpu6050 baseSensor;
+  Disturbance disturbance;
+
+  /// The time the disturbance starts, after the calibration if there is one.
+  uint_fast64_t origin = 0;
+
+  /// The platform's attitude at lastUpdate in degrees.
+  float roll = 0;
+  float pitch = 0;
+  uint_fast64_t lastUpdate = 0;
+
+  /// The base's attitude at lastUpdate in degrees.
+  float baseRoll = 0;
+  float basePitch = 0;
+
+public:
+  /// Constructor
+  ///
+  /// Constructs a level gimbal whose base moves according to disturbance and whose motors have the given parameters.
+  /// The sensor gets the noise the datasheet gives, a gyroscope bias of about 1 degree per second and
+  /// an accelerometer bias of a few hundredths of a g.
+  GimbalSimulator(const Disturbance & disturbance, const StepperParameters & motor = StepperParameters());
+
+  /// Returns the simulated sensor, to change its noise and bias before run.
+  SimMpu6050 & getSensor();
+
+  /// Returns the platform's roll in degrees.
+  float getRoll() const;
+
+  /// Returns the platform's pitch in degrees.
+  float getPitch() const;
+
+  /// Runs the control loop with the given settings for duration microseconds.
+  ///
+  /// The tilt counts as settled when it stays within tolerance degrees on both axes.
+  SimulationReport run(const ControllerSettings & settings, uint_fast64_t duration, float tolerance = 1.0f);
+
+  void advanceTo(uint_fast64_t now) override;
+};
+
+#endif
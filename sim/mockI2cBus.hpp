@@ -0,0 +1,148 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOCKI2CBUS_HPP
+#define MOCKI2CBUS_HPP
+
+#include "hwlib.hpp"
+#include "sampleBuffer.hpp"
+#include <deque>
+
+/// @file
+
+/// An i2c bus that pretends to be a single chip with a 128 byte register map.
+///
+/// The first byte written in a write transaction selects a register, every next
+/// byte is written to the selected register after which the selection moves on to the
+/// next register, just like the MPU6050 does. Read transactions return the selected register
+/// and move on in the same way. Every transaction (every start condition) is counted, which makes
+/// it possible to check how much bus traffic a driver function costs.
+///
+/// The FIFO of the MPU6050 is simulated as well: FIFO_COUNTH/FIFO_COUNTL report the amount of
+/// buffered bytes, reading FIFO_R_W pops a byte without moving on to the next register, and
+/// setting FIFO_RESET in USER_CTRL empties it. Like the real chip, a full FIFO drops its oldest bytes.
+class mockI2cBus : public hwlib::i2c_bus {
+private:
+  /// What the next written byte means.
+  enum class state { idle, address, registerSelect, data };
+  state current = state::idle;
+
+  /// Whether the current transaction is a read transaction.
+  bool reading = false;
+
+  // Register addresses with special behaviour.
+  static constexpr uint8_t USER_CTRL =   0x6A;
+  static constexpr uint8_t FIFO_COUNTH = 0x72;
+  static constexpr uint8_t FIFO_COUNTL = 0x73;
+  static constexpr uint8_t FIFO_R_W =    0x74;
+
+public:
+  /// The size of the simulated FIFO in bytes.
+  static constexpr size_t FIFO_SIZE = 1024;
+
+  /// The bytes in the simulated FIFO, oldest first.
+  std::deque<uint8_t> fifo;
+
+  /// The contents of the simulated register map.
+  uint8_t registers[128] = {};
+
+  /// The register that will be read or written next.
+  uint8_t selected = 0;
+
+  /// The address the last transaction was sent to.
+  uint8_t lastAddress = 0;
+
+  /// The amount of transactions since construction or the last call to reset.
+  unsigned int transactions = 0;
+
+  /// The amount of bytes read from the register map.
+  unsigned int bytesRead = 0;
+
+  /// Sets all counters back to zero.
+  void reset(){
+    transactions = 0;
+    bytesRead = 0;
+  }
+
+  void write_start() override {
+    transactions++;
+    current = state::address;
+  }
+
+  void write_stop() override {
+    current = state::idle;
+  }
+
+  void write_ack() override {}
+  void write_nack() override {}
+  bool read_ack() override { return true; }
+
+  void write( uint8_t x ) override {
+    if(current == state::address){
+      lastAddress = x >> 1;
+      reading = x & 1;
+      current = state::registerSelect;
+    }else if(current == state::registerSelect){
+      selected = x & 0x7F;
+      current = state::data;
+    }else if(current == state::data){
+      if(selected == USER_CTRL && (x & 0x04)){
+        fifo.clear();
+        x &= ~0x04;
+      }
+      registers[selected] = x;
+      selected = (selected + 1) & 0x7F;
+    }
+  }
+
+  uint8_t read_byte() override {
+    bytesRead++;
+    uint8_t value = registers[selected];
+    if(selected == FIFO_COUNTH){
+      value = fifo.size() >> 8;
+    }else if(selected == FIFO_COUNTL){
+      value = fifo.size() & 0xFF;
+    }else if(selected == FIFO_R_W){
+      value = 0;
+      if(!fifo.empty()){
+        value = fifo.front();
+        fifo.pop_front();
+      }
+      return value;
+    }
+    if(reading){
+      selected = (selected + 1) & 0x7F;
+    }
+    return value;
+  }
+
+  /// Stores an int16_t in two consecutive registers, most significant byte first.
+  void setWord(uint8_t registerAdress, int16_t value){
+    registers[registerAdress] = static_cast<uint16_t>(value) >> 8;
+    registers[registerAdress + 1] = value & 0xFF;
+  }
+
+  /// Lets the simulated chip take a sample.
+  ///
+  /// Stores the sample in the measurement registers and, when the FIFO is enabled in USER_CTRL,
+  /// adds it to the FIFO as a 14 byte frame.
+  void sample(const Mpu6050Sample & s){
+    const int16_t words[7] = {s.accX, s.accY, s.accZ, s.temperature, s.gyroX, s.gyroY, s.gyroZ};
+    for(int i = 0; i < 7; i++){
+      setWord(0x3B + 2 * i, words[i]);
+    }
+    if(!(registers[USER_CTRL] & 0x40)){
+      return;
+    }
+    for(int i = 0; i < 14; i++){
+      if(fifo.size() == FIFO_SIZE){
+        fifo.pop_front();
+      }
+      fifo.push_back(registers[0x3B + i]);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,40 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOCKINTERRUPTPIN_HPP
+#define MOCKINTERRUPTPIN_HPP
+
+#include "interruptPin.hpp"
+
+/// @file
+
+/// An InterruptPin that only fires when told to.
+class mockInterruptPin : public InterruptPin {
+private:
+  handler h = nullptr;
+  void *context = nullptr;
+
+public:
+  void attach(handler h, void *context) override {
+    this->h = h;
+    this->context = context;
+  }
+
+  void detach() override {
+    h = nullptr;
+  }
+
+  /// Returns whether a handler is attached.
+  bool attached() const { return h != nullptr; }
+
+  /// Pretends a rising edge happened at the given time, like an interrupt would.
+  void fire(uint_fast64_t timestamp){
+    if(h != nullptr){
+      h(context, timestamp);
+    }
+  }
+};
+
+#endif
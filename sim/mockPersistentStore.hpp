@@ -0,0 +1,57 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOCKPERSISTENTSTORE_HPP
+#define MOCKPERSISTENTSTORE_HPP
+
+#include "persistentStore.hpp"
+
+/// @file
+
+/// A PersistentStore in RAM, erased like flash and counting its writes.
+class mockPersistentStore : public PersistentStore {
+public:
+  /// The amount of bytes the store holds.
+  static constexpr size_t SIZE = 256;
+
+  /// The contents, all 0xFF until written.
+  uint8_t bytes[SIZE];
+
+  /// The amount of calls to write.
+  unsigned int writes = 0;
+
+  mockPersistentStore(){
+    erase();
+  }
+
+  /// Makes the store look like it was never written.
+  void erase(){
+    for(auto & b : bytes){
+      b = 0xFF;
+    }
+  }
+
+  size_t capacity() const override { return SIZE; }
+
+  void read(uint8_t data[], size_t n) override {
+    for(size_t i = 0; i < n && i < SIZE; i++){
+      data[i] = bytes[i];
+    }
+  }
+
+  bool write(const uint8_t data[], size_t n) override {
+    if(n > SIZE){
+      return false;
+    }
+    writes++;
+    erase();
+    for(size_t i = 0; i < n; i++){
+      bytes[i] = data[i];
+    }
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,106 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef MOCKSHAREDBUS_HPP
+#define MOCKSHAREDBUS_HPP
+
+#include "mockI2cBus.hpp"
+
+/// @file
+
+/// An i2c bus shared by several mockI2cBus register maps, each at its own address.
+///
+/// Every transaction goes to the chip whose address is in its first byte, chips at other addresses don't see it.
+/// Transactions to an address without a chip aren't acknowledged. The bus counts the bits it would clock out,
+/// including start and stop conditions and acknowledge bits, so a test can check how busy a real bus would be.
+class mockSharedBus : public hwlib::i2c_bus {
+public:
+  /// The maximum amount of chips on the bus.
+  static constexpr size_t MAX_CHIPS = 4;
+
+private:
+  /// The chips on the bus and their addresses.
+  mockI2cBus *chips[MAX_CHIPS] = {};
+  uint8_t addresses[MAX_CHIPS] = {};
+  size_t chipCount = 0;
+
+  /// The chip the current transaction goes to, or nullptr when it doesn't go anywhere (yet).
+  mockI2cBus *current = nullptr;
+
+  /// Whether the next written byte is the address byte of a new transaction.
+  bool addressing = false;
+
+public:
+  /// The amount of bits on the bus since construction or the last call to reset.
+  unsigned int bits = 0;
+
+  /// The amount of transactions since construction or the last call to reset.
+  unsigned int transactions = 0;
+
+  /// The address the last transaction was sent to.
+  uint8_t lastAddress = 0;
+
+  /// Puts a chip on the bus at the given 7-bit address.
+  void addChip(mockI2cBus & chip, uint8_t address){
+    if(chipCount < MAX_CHIPS){
+      chips[chipCount] = &chip;
+      addresses[chipCount] = address;
+      chipCount++;
+    }
+  }
+
+  /// Sets all counters back to zero.
+  void reset(){
+    bits = 0;
+    transactions = 0;
+  }
+
+  void write_start() override {
+    transactions++;
+    bits++;
+    addressing = true;
+    current = nullptr;
+  }
+
+  void write_stop() override {
+    bits++;
+    if(current != nullptr){
+      current->write_stop();
+    }
+    current = nullptr;
+  }
+
+  void write_ack() override {}
+  void write_nack() override {}
+
+  bool read_ack() override {
+    bits++;
+    return current != nullptr;
+  }
+
+  void write( uint8_t x ) override {
+    bits += 8;
+    if(addressing){
+      addressing = false;
+      lastAddress = x >> 1;
+      for(size_t i = 0; i < chipCount; i++){
+        if(addresses[i] == x >> 1){
+          current = chips[i];
+          current->write_start();
+        }
+      }
+    }
+    if(current != nullptr){
+      current->write(x);
+    }
+  }
+
+  uint8_t read_byte() override {
+    bits += 9;
+    return current != nullptr ? current->read_byte() : 0xFF;
+  }
+};
+
+#endif
@@ -0,0 +1,85 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef RECORDINGPORT_HPP
+#define RECORDINGPORT_HPP
+
+#include "clock.hpp"
+#include <vector>
+
+/// @file
+
+/// A 4 pin hwlib::port_out that logs every flushed value with the time it was flushed.
+///
+/// Connected to a steppermotor, the log holds every phase the coils went through, which is enough to
+/// work out how many steps were taken, how fast, and whether any were taken too fast for a real motor.
+class RecordingPort : public hwlib::port_out {
+public:
+  /// One flushed value.
+  struct entry {
+    /// The time of the flush in microseconds.
+    uint_fast64_t time;
+
+    /// The value of the pins.
+    uint8_t value;
+  };
+
+private:
+  /// The clock the timestamps come from.
+  Clock & clock;
+
+  /// The value written but not yet flushed.
+  uint_fast16_t buffered = 0;
+
+public:
+  /// Every flushed value, oldest first.
+  std::vector<entry> log;
+
+  /// Constructor
+  ///
+  /// Constructs a RecordingPort that takes its timestamps from the given clock.
+  RecordingPort(Clock & clock):
+    clock( clock )
+  {}
+
+  uint_fast8_t number_of_pins() override { return 4; }
+
+  void write( uint_fast16_t x ) override { buffered = x; }
+
+  void flush() override { log.push_back(entry{clock.now_us(), static_cast<uint8_t>(buffered)}); }
+
+  /// Returns the amount of flushes that changed the value, which is the amount of steps for a steppermotor.
+  size_t changes() const {
+    size_t n = 0;
+    for(size_t i = 1; i < log.size(); i++){
+      if(log[i].value != log[i - 1].value){
+        n++;
+      }
+    }
+    return n;
+  }
+
+  /// Returns the shortest time between two flushes in microseconds, or 0 when there are less than two.
+  uint_fast64_t shortestInterval() const {
+    uint_fast64_t shortest = 0;
+    for(size_t i = 1; i < log.size(); i++){
+      uint_fast64_t interval = log[i].time - log[i - 1].time;
+      if(i == 1 || interval < shortest){
+        shortest = interval;
+      }
+    }
+    return shortest;
+  }
+
+  /// Returns the average amount of flushes per second between the first and the last, or 0 when that can't be known.
+  float ratePerSecond() const {
+    if(log.size() < 2 || log.back().time == log.front().time){
+      return 0;
+    }
+    return (log.size() - 1) * 1e6f / (log.back().time - log.front().time);
+  }
+};
+
+#endif
@@ -0,0 +1,132 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "simMpu6050.hpp"
+#include <math.h>
+
+namespace {
+
+const uint8_t SMPLRT_DIV =   0x19;
+const uint8_t CONFIG =       0x1A;
+const uint8_t GYRO_CONFIG =  0x1B;
+const uint8_t ACCEL_CONFIG = 0x1C;
+const uint8_t INT_ENABLE =   0x38;
+const uint8_t PWR_MGMT_1 =   0x6B;
+const uint8_t XA_OFFS_H =    0x06;
+const uint8_t XG_OFFS_USRH = 0x13;
+
+const float DEGREES_TO_RADIANS = 3.14159265f / 180.0f;
+
+// Converts to a register value, clipping like the chip does.
+int16_t clip(float value){
+  if(value > 32767){
+    return 32767;
+  }
+  if(value < -32768){
+    return -32768;
+  }
+  return static_cast<int16_t>(lroundf(value));
+}
+
+}
+
+const int16_t SimMpu6050::FACTORY_ACCEL_OFFSETS[3] = {-2913, 1025, 1367};
+
+SimMpu6050::SimMpu6050(VirtualClock & clock, mockInterruptPin *intPin):
+  intPin( intPin )
+{
+  registers[PWR_MGMT_1] = 0x40; // SLEEP
+  registers[0x75] = 0x68;       // WHO_AM_I
+  for(int i = 0; i < 3; i++){
+    registers[XA_OFFS_H + 2 * i] = static_cast<uint16_t>(FACTORY_ACCEL_OFFSETS[i]) >> 8;
+    registers[XA_OFFS_H + 2 * i + 1] = FACTORY_ACCEL_OFFSETS[i] & 0xFF;
+  }
+  clock.addDevice(*this);
+}
+
+void SimMpu6050::setAttitude(float roll, float pitch){
+  this->roll = roll;
+  this->pitch = pitch;
+}
+
+void SimMpu6050::setRates(float x, float y, float z){
+  rateX = x;
+  rateY = y;
+  rateZ = z;
+}
+
+void SimMpu6050::setNoise(float accel, float gyro, uint32_t seed){
+  accelNoise = accel;
+  gyroNoise = gyro;
+  random.seed(seed);
+}
+
+void SimMpu6050::setGyroBias(float x, float y, float z){
+  biasX = x;
+  biasY = y;
+  biasZ = z;
+}
+
+void SimMpu6050::setAccelBias(float x, float y, float z){
+  accelBias[0] = x;
+  accelBias[1] = y;
+  accelBias[2] = z;
+}
+
+int16_t SimMpu6050::offsetRegister(uint8_t address) const {
+  return static_cast<int16_t>(registers[address] << 8 | registers[address + 1]);
+}
+
+uint_fast64_t SimMpu6050::samplePeriod() const {
+  uint8_t dlpf = registers[CONFIG] & 0x07;
+  uint_fast64_t gyroPeriod = (dlpf == 0 || dlpf == 7) ? 125 : 1000;
+  return gyroPeriod * (1 + registers[SMPLRT_DIV]);
+}
+
+Mpu6050Sample SimMpu6050::makeSample() const {
+  float accelSensitivity = 16384 >> ((registers[ACCEL_CONFIG] >> 3) & 0x03);
+  float gyroSensitivity = 131.0f / (1 << ((registers[GYRO_CONFIG] >> 3) & 0x03));
+  float r = roll * DEGREES_TO_RADIANS;
+  float p = pitch * DEGREES_TO_RADIANS;
+
+  // a normal distribution needs a standard deviation above 0, so no noise means not drawing at all
+  std::normal_distribution<float> accelDistribution(0.0f, accelNoise > 0 ? accelNoise : 1.0f);
+  std::normal_distribution<float> gyroDistribution(0.0f, gyroNoise > 0 ? gyroNoise : 1.0f);
+  auto accel = [&](){ return accelNoise > 0 ? accelDistribution(random) : 0.0f; };
+  auto gyro = [&](){ return gyroNoise > 0 ? gyroDistribution(random) : 0.0f; };
+
+  // the offset registers in g and degrees per second, bit 0 of XA_OFFS isn't part of the offset
+  float accelOffset[3];
+  float gyroOffset[3];
+  for(int i = 0; i < 3; i++){
+    accelOffset[i] = accelBias[i] + ((offsetRegister(XA_OFFS_H + 2 * i) & ~1) - (FACTORY_ACCEL_OFFSETS[i] & ~1)) / 2048.0f;
+    gyroOffset[i] = offsetRegister(XG_OFFS_USRH + 2 * i) / 32.8f;
+  }
+
+  Mpu6050Sample s;
+  s.accX = clip((-sinf(p) + accelOffset[0] + accel()) * accelSensitivity);
+  s.accY = clip((sinf(r) * cosf(p) + accelOffset[1] + accel()) * accelSensitivity);
+  s.accZ = clip((cosf(r) * cosf(p) + accelOffset[2] + accel()) * accelSensitivity);
+  s.temperature = clip((25.0f - 36.53f) * 340.0f);
+  s.gyroX = clip((rateX + biasX + gyroOffset[0] + gyro()) * gyroSensitivity);
+  s.gyroY = clip((rateY + biasY + gyroOffset[1] + gyro()) * gyroSensitivity);
+  s.gyroZ = clip((rateZ + biasZ + gyroOffset[2] + gyro()) * gyroSensitivity);
+  return s;
+}
+
+void SimMpu6050::advanceTo(uint_fast64_t now){
+  if(registers[PWR_MGMT_1] & 0x40){
+    nextSample = now + samplePeriod();
+    return;
+  }
+  while(nextSample <= now){
+    sample(makeSample());
+    samplesTaken++;
+    if(intPin != nullptr && (registers[INT_ENABLE] & 0x01)){
+      intPin->fire(nextSample);
+    }
+    nextSample += samplePeriod();
+  }
+}
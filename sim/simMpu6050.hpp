@@ -0,0 +1,102 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SIMMPU6050_HPP
+#define SIMMPU6050_HPP
+
+#include "mockI2cBus.hpp"
+#include "mockInterruptPin.hpp"
+#include "virtualClock.hpp"
+#include <random>
+
+/// @file
+
+/// An MPU6050 that takes samples on a VirtualClock.
+///
+/// Builds on the register map and FIFO of mockI2cBus, and adds what the chip does by itself over time:
+/// at the sample rate set by SMPLRT_DIV and the DLPF in CONFIG it turns its attitude and angular velocity
+/// into a sample, scaled by the full scale ranges in GYRO_CONFIG and ACCEL_CONFIG, stores it in the
+/// measurement registers and the FIFO, and pulses its INT pin when DATA_RDY_EN is set.
+/// Like the real chip it starts in sleep mode and takes no samples until it is woken through PWR_MGMT_1.
+///
+/// The attitude and angular velocity are set by the test or by a physics model, in the frame of the sensor.
+///
+/// The offset registers work too: XG_OFFS_USR is added to the gyroscope samples and the difference between
+/// XA_OFFS and its factory trim, FACTORY_ACCEL_OFFSETS, to the accelerometer samples.
+class SimMpu6050 : public mockI2cBus, public SimDevice {
+private:
+  /// The pin pulsed on every sample, if any.
+  mockInterruptPin *intPin;
+
+  /// The time of the next sample in microseconds.
+  uint_fast64_t nextSample = 0;
+
+  /// The attitude in degrees.
+  float roll = 0;
+  float pitch = 0;
+
+  /// The angular velocity in degrees per second.
+  float rateX = 0;
+  float rateY = 0;
+  float rateZ = 0;
+
+  /// The standard deviation of the noise on the accelerometer in g and on the gyroscope in degrees per second.
+  float accelNoise = 0;
+  float gyroNoise = 0;
+
+  /// The offset of the gyroscope in degrees per second.
+  float biasX = 0;
+  float biasY = 0;
+  float biasZ = 0;
+
+  /// The offset of the accelerometer in g.
+  float accelBias[3] = {0, 0, 0};
+
+  /// Returns the offset register pair at the given address.
+  int16_t offsetRegister(uint8_t address) const;
+
+  /// The source of the noise.
+  mutable std::mt19937 random;
+
+public:
+  /// The values of XA_OFFS, YA_OFFS and ZA_OFFS after power up. Odd, to check that bit 0 is kept.
+  static const int16_t FACTORY_ACCEL_OFFSETS[3];
+
+  /// The amount of samples taken since construction.
+  unsigned int samplesTaken = 0;
+
+  /// Constructor
+  ///
+  /// Constructs a sleeping, level SimMpu6050 that takes samples on the given clock and, when given, pulses intPin.
+  SimMpu6050(VirtualClock & clock, mockInterruptPin *intPin = nullptr);
+
+  /// Sets the attitude in degrees, which determines the direction of gravity in the accelerometer samples.
+  void setAttitude(float roll, float pitch);
+
+  /// Sets the angular velocity around the three axes in degrees per second.
+  void setRates(float x, float y, float z);
+
+  /// Adds normally distributed noise to every sample, with the given standard deviations in g and degrees per second.
+  ///
+  /// The datasheet gives 400ug/sqrt(Hz) and 0.005dps/sqrt(Hz), which at the 44Hz bandwidth of DLPF setting 3
+  /// comes down to about 0.003g and 0.03dps. The seed makes runs repeatable.
+  void setNoise(float accel, float gyro, uint32_t seed = 1);
+
+  /// Sets the offset of the gyroscope in degrees per second, which the datasheet allows to be up to 20dps.
+  void setGyroBias(float x, float y, float z);
+
+  /// Sets the offset of the accelerometer in g, which the datasheet allows to be up to 0.05g for X and Y and 0.08g for Z.
+  void setAccelBias(float x, float y, float z);
+
+  /// Returns the time between samples in microseconds, as configured in the registers.
+  uint_fast64_t samplePeriod() const;
+
+  /// Returns the sample the chip would take now, as raw register values.
+  Mpu6050Sample makeSample() const;
+
+  void advanceTo(uint_fast64_t now) override;
+};
+
+#endif
@@ -0,0 +1,94 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "simStepper.hpp"
+#include <math.h>
+
+namespace {
+
+// The steps table of steppermotor.
+const uint8_t STEPS[8] = {1, 3, 2, 6, 4, 12, 8, 9};
+
+// The longest time the rotor is moved in one go, in microseconds.
+const uint_fast64_t SUBSTEP = 20;
+
+}
+
+SimStepper::SimStepper(VirtualClock & clock, const StepperParameters & parameters):
+  parameters( parameters ),
+  maxAcceleration( parameters.torque / parameters.inertia * parameters.stepsPerRotation / (2 * 3.14159265f) )
+{
+  clock.addDevice(*this);
+}
+
+void SimStepper::flush(){
+  int8_t next = -1;
+  for(int8_t i = 0; i < 8; i++){
+    if(STEPS[i] == buffered){
+      next = i;
+    }
+  }
+  if(next >= 0 && phase >= 0){
+    int8_t delta = (next - phase + 8) % 8;
+    if(delta > 4){
+      delta -= 8;
+    }
+    commanded += delta;
+    steps += delta < 0 ? -delta : delta;
+  }else if(next >= 0){
+    // the coils come back on, the rotor snaps to the nearest position with this phase
+    int32_t rotor = lroundf(position);
+    int8_t rotorPhase = ((rotor % 8) + 8) % 8;
+    int8_t delta = (next - rotorPhase + 8) % 8;
+    if(delta > 4){
+      delta -= 8;
+    }
+    slipped = commanded - (rotor + delta);
+  }
+  phase = next;
+}
+
+float SimStepper::getAngle() const {
+  return position * 360.0f / parameters.stepsPerRotation;
+}
+
+float SimStepper::getSpeed() const {
+  return velocity * 360.0f / parameters.stepsPerRotation;
+}
+
+void SimStepper::advanceTo(uint_fast64_t now){
+  while(lastUpdate < now){
+    uint_fast64_t step = (now - lastUpdate) < SUBSTEP ? (now - lastUpdate) : SUBSTEP;
+    lastUpdate += step;
+    float h = step / 1e6f;
+
+    if(phase < 0){
+      velocity = 0;
+      continue;
+    }
+
+    float error = (commanded - slipped) - position;
+    if(fabsf(error) > 4){
+      int32_t turns = error > 0 ? 8 : -8;
+      slipped += turns;
+      lostSteps += 8;
+      error -= turns;
+    }
+
+    float change = error / parameters.lag - velocity;
+    float limit = maxAcceleration;
+    if(change * velocity > 0){
+      float left = 1.0f - fabsf(velocity) / parameters.maxSpeed;
+      limit *= left > 0 ? left : 0;
+    }
+    if(change > limit * h){
+      change = limit * h;
+    }else if(change < -limit * h){
+      change = -limit * h;
+    }
+    velocity += change;
+    position += velocity * h;
+  }
+}
@@ -0,0 +1,90 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SIMSTEPPER_HPP
+#define SIMSTEPPER_HPP
+
+#include "virtualClock.hpp"
+
+/// @file
+
+/// The physical properties of a steppermotor with its load, by default a 28BYJ-48 turning one axis of the gimbal.
+struct StepperParameters {
+  /// The amount of half steps per rotation of the output shaft, gearbox included.
+  float stepsPerRotation = 4096;
+
+  /// The torque at the output shaft at standstill in Nm. About 0.034Nm for a 28BYJ-48 at 5V.
+  float torque = 0.034f;
+
+  /// The speed in half steps per second at which the torque has dropped to nothing.
+  float maxSpeed = 1800;
+
+  /// The moment of inertia of everything turned by the output shaft in kg m^2, the rotor included.
+  /// 2e-4 is about a 100g platform with its mass 4cm from the axis.
+  float inertia = 2e-4f;
+
+  /// How fast the rotor follows the coils in seconds: the rotor's speed is the distance to the coils divided by this.
+  float lag = 0.001f;
+};
+
+/// A steppermotor with a load, connected through a 4 pin hwlib::port_out.
+///
+/// Every flush that moves the coils to a neighbouring phase of the steppermotor's steps table moves the
+/// commanded position one half step. The rotor follows the commanded position, but its acceleration is limited
+/// by the torque and the inertia, and the torque falls linearly with speed until it is gone at maxSpeed.
+/// When the rotor falls more than 2 full steps behind (or ahead), the coils pull it towards the same phase
+/// one electrical turn (8 half steps) further on: those 8 half steps are lost, and from then on the rotor
+/// is where the driver thinks it isn't. The gearbox of a 28BYJ-48 doesn't turn back, so without current
+/// (all coils off) the shaft stops.
+class SimStepper : public hwlib::port_out, public SimDevice {
+private:
+  StepperParameters parameters;
+
+  /// The acceleration the full torque gives, in half steps per second squared.
+  float maxAcceleration;
+
+  /// The value written but not yet flushed.
+  uint_fast16_t buffered = 0;
+
+  /// The index of the coils in the steps table, or -1 when they are off.
+  int8_t phase = 0;
+
+  /// The position the coils ask for and the part of it lost to slipping, in half steps.
+  int32_t commanded = 0;
+  int32_t slipped = 0;
+
+  /// The position of the rotor in half steps and its speed in half steps per second.
+  float position = 0;
+  float velocity = 0;
+
+  /// The time the rotor was last moved to.
+  uint_fast64_t lastUpdate = 0;
+
+public:
+  /// The amount of half steps commanded and the amount of them lost.
+  unsigned int steps = 0;
+  unsigned int lostSteps = 0;
+
+  /// Constructor
+  ///
+  /// Constructs a SimStepper at position 0 that moves on the given clock.
+  SimStepper(VirtualClock & clock, const StepperParameters & parameters = StepperParameters());
+
+  uint_fast8_t number_of_pins() override { return 4; }
+
+  void write( uint_fast16_t x ) override { buffered = x; }
+
+  void flush() override;
+
+  /// Returns the angle of the output shaft in degrees.
+  float getAngle() const;
+
+  /// Returns the speed of the output shaft in degrees per second.
+  float getSpeed() const;
+
+  void advanceTo(uint_fast64_t now) override;
+};
+
+#endif
@@ -0,0 +1,71 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef SIMUART_HPP
+#define SIMUART_HPP
+
+#include "virtualClock.hpp"
+#include <vector>
+
+/// @file
+
+/// A serial port that sends blocks in the background on a VirtualClock, like DueUartTx does.
+///
+/// Every byte takes 10 bit times (a start bit, 8 data bits and a stop bit) at the given baud rate.
+/// Bytes show up in received as they would arrive on the other side.
+class SimUart : public SimDevice {
+private:
+  /// The time a byte takes in nanoseconds, so fast rates are exact enough too.
+  uint_fast64_t nanosPerByte;
+
+  /// The block being sent.
+  const uint8_t *data = nullptr;
+  size_t length = 0;
+  size_t done = 0;
+
+  /// The time the block started, in nanoseconds.
+  uint_fast64_t started = 0;
+
+  /// The current time in nanoseconds.
+  uint_fast64_t now = 0;
+
+public:
+  /// Every byte sent, in order.
+  std::vector<uint8_t> received;
+
+  /// The amount of blocks sent.
+  unsigned int blocks = 0;
+
+  /// Constructor
+  ///
+  /// Constructs an idle SimUart on the given clock.
+  SimUart(VirtualClock & clock, uint32_t baudrate):
+    nanosPerByte( 10000000000ULL / baudrate )
+  {
+    clock.addDevice(*this);
+    now = clock.now_us() * 1000;
+  }
+
+  bool busy() const {
+    return done < length;
+  }
+
+  void send(const uint8_t block[], size_t n){
+    data = block;
+    length = n;
+    done = 0;
+    started = now;
+    blocks++;
+  }
+
+  void advanceTo(uint_fast64_t time) override {
+    now = time * 1000;
+    while(done < length && started + (done + 1) * nanosPerByte <= now){
+      received.push_back(data[done++]);
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,26 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "virtualClock.hpp"
+
+uint_fast64_t VirtualClock::now_us(){
+  return time;
+}
+
+void VirtualClock::wait_us(uint_fast32_t n){
+  advance(n);
+}
+
+void VirtualClock::advance(uint_fast64_t n){
+  time += n;
+  for(SimDevice *device : devices){
+    device->advanceTo(time);
+  }
+}
+
+void VirtualClock::addDevice(SimDevice & device){
+  devices.push_back(&device);
+  device.advanceTo(time);
+}
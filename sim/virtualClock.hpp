@@ -0,0 +1,47 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef VIRTUALCLOCK_HPP
+#define VIRTUALCLOCK_HPP
+
+#include "clock.hpp"
+#include <vector>
+
+/// @file
+
+/// Something simulated that changes over time, like the sensor in SimMpu6050.
+class SimDevice {
+public:
+  /// Brings the device up to the given time in microseconds, which never goes back.
+  virtual void advanceTo(uint_fast64_t now) = 0;
+};
+
+/// A Clock that only moves when told to.
+///
+/// Time starts at 0 and moves forward by advance and by wait_us, so waiting costs no real time.
+/// Every time the clock moves, the SimDevices added to it are brought up to the new time, which makes
+/// them take their samples and fire their interrupts while the code under test is waiting.
+class VirtualClock : public Clock {
+private:
+  /// The current time in microseconds.
+  uint_fast64_t time = 0;
+
+  /// The devices to bring up to time.
+  std::vector<SimDevice *> devices;
+
+public:
+  uint_fast64_t now_us() override;
+
+  /// Moves the clock n microseconds forward.
+  void wait_us(uint_fast32_t n) override;
+
+  /// Moves the clock n microseconds forward.
+  void advance(uint_fast64_t n);
+
+  /// Makes the clock bring the device up to time whenever it moves.
+  void addDevice(SimDevice & device);
+};
+
+#endif
@@ -5,6 +5,8 @@
 
 #include "hwlib.hpp"
 #include "stepper28BYJ48.hpp"
+#include "stepScheduler.hpp"
+#include "dueStepTimer.hpp"
 
 
 int main(){
@@ -23,5 +25,19 @@ int main(){
   motor.turnClockwiseDegrees(360);
   hwlib::wait_ms(1000);
   motor.turnCounterClockwiseDegrees(360);
+  hwlib::wait_ms(1000);
+
+  // The same rotations again, but stepped by the TC0 interrupt while the main loop only waits for the position
+  hwlib::cout << "The motor's output shaft should make the same rotations again, driven by a timer interrupt" << hwlib::endl;
+  StepScheduler scheduler;
+  auto timer = DueStepTimer( scheduler, 100 );
+  auto m = scheduler.addMotor( motor, 10 );
+  timer.start();
+  scheduler.post( m, 4096 );
+  while( scheduler.getPosition( m ) != 4096 ){}
+  hwlib::wait_ms(1000);
+  scheduler.post( m, 0 );
+  while( scheduler.getPosition( m ) != 0 ){}
+  timer.stop();
   hwlib::cout << "Testing sequence complete" << hwlib::endl;
 }
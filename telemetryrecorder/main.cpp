@@ -0,0 +1,115 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "telemetry.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+
+// Records the telemetry packets of applicatie to a CSV file and reports the lost ones.
+//
+//   ./telemetryrecorder /dev/ttyACM0 log.csv
+//
+// Sets a serial port to 400000 baud, raw, or to the baud rate given as third argument. Also reads a capture
+// made earlier, like cat /dev/ttyACM0 > capture.bin. Every TELEMETRY_LOOP packet becomes a line with the sample,
+// the attitude in degrees and the step rates, other packets a line with their payload in hex.
+// Runs until the input ends or Ctrl-C, and prints how many packets came in, were lost and were damaged.
+
+static volatile sig_atomic_t stopped = 0;
+
+static void onInterrupt(int){
+  stopped = 1;
+}
+
+// Sets a serial port to raw 8N1 at any baud rate, which the termios2 interface of Linux allows.
+static bool setupPort(int fd, unsigned int baudrate){
+  struct termios2 settings;
+  if(ioctl(fd, TCGETS2, &settings) != 0){
+    return false;
+  }
+  settings.c_iflag = 0;
+  settings.c_oflag = 0;
+  settings.c_lflag = 0;
+  settings.c_cflag = CS8 | CREAD | CLOCAL | BOTHER;
+  settings.c_ispeed = baudrate;
+  settings.c_ospeed = baudrate;
+  settings.c_cc[VMIN] = 1;
+  settings.c_cc[VTIME] = 0;
+  return ioctl(fd, TCSETS2, &settings) == 0;
+}
+
+static void writeMessage(FILE *output, const TelemetryMessage & message){
+  TelemetryLoop loop;
+  if(message.decodeLoop(loop)){
+    fprintf(output, "%u,%u,loop,%d,%d,%d,%d,%d,%d,%.2f,%.2f,%d,%d\n", message.sequence, message.time,
+      loop.accX, loop.accY, loop.accZ, loop.gyroX, loop.gyroY, loop.gyroZ,
+      loop.roll / 100.0, loop.pitch / 100.0, loop.pitchSpeed, loop.rollSpeed);
+    return;
+  }
+  fprintf(output, "%u,%u,%u,", message.sequence, message.time, message.type);
+  for(size_t i = 0; i < message.length; i++){
+    fprintf(output, "%02x", message.payload[i]);
+  }
+  fprintf(output, "\n");
+}
+
+static void report(const TelemetryReader & reader){
+  fprintf(stderr, "\r%u packets, %u lost, %u damaged", reader.received, reader.lost, reader.corrupted);
+}
+
+int main(int argc, char *argv[]){
+  if(argc < 3){
+    fprintf(stderr, "usage: %s <serial port or capture> <output.csv> [baud rate]\n", argv[0]);
+    return 2;
+  }
+  int input = open(argv[1], O_RDONLY | O_NOCTTY);
+  if(input < 0){
+    perror(argv[1]);
+    return 1;
+  }
+  unsigned int baudrate = argc > 3 ? strtoul(argv[3], nullptr, 10) : 400000;
+  if(isatty(input) && !setupPort(input, baudrate)){
+    perror("setting the baud rate");
+    return 1;
+  }
+  FILE *output = fopen(argv[2], "w");
+  if(output == nullptr){
+    perror(argv[2]);
+    return 1;
+  }
+  fprintf(output, "sequence,time_us,type,accX,accY,accZ,gyroX,gyroY,gyroZ,roll,pitch,pitchSpeed,rollSpeed\n");
+
+  // no SA_RESTART, so Ctrl-C ends a read that is waiting for the port
+  struct sigaction action = {};
+  action.sa_handler = onInterrupt;
+  sigaction(SIGINT, &action, nullptr);
+
+  TelemetryReader reader;
+  TelemetryMessage message;
+  uint8_t buffer[4096];
+  while(!stopped){
+    ssize_t n = read(input, buffer, sizeof(buffer));
+    if(n <= 0){
+      break;
+    }
+    for(ssize_t i = 0; i < n; i++){
+      if(reader.feed(buffer[i], message) == TelemetryReader::result::packet){
+        writeMessage(output, message);
+        if(reader.received % 1000 == 0){
+          report(reader);
+        }
+      }
+    }
+  }
+  report(reader);
+  fprintf(stderr, "\n");
+  fclose(output);
+  close(input);
+  return reader.received > 0 ? 0 : 1;
+}
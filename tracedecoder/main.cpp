@@ -0,0 +1,133 @@
+//          Copyright Youri de Vor 2018 - 2019.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          https://www.boost.org/LICENSE_1_0.txt)
+
+#include "traceBuffer.hpp"
+#include "sampleLog.hpp"
+#include <stdio.h>
+
+// Decodes the dumps of a TraceBuffer into one line of text per event, and those of a SampleLog into one line per sample.
+//
+// Reads from the file given as argument, or from standard input, for example:
+//   ./tracedecoder /dev/ttyACM0
+// once the port runs at the rate of applicatie, which telemetryrecorder sets up,
+// or a capture made earlier with cat /dev/ttyACM0 > trace.bin.
+// Everything that isn't a dump, like text printed with hwlib::cout, is skipped.
+// Prints the time in microseconds since the first event of each dump, the event and its payload.
+// For a SampleLog it prints the time since its first sample and the raw values of the sample.
+
+// Prints the payload in the way its event id describes.
+static void printPayload(const TraceEvent & e){
+  int16_t high = e.payload >> 16;
+  int16_t low = e.payload & 0xFFFF;
+  switch(e.id){
+    case TRACE_SENSOR_READ:
+      printf("gyroX=%d gyroY=%d", high, low);
+      break;
+    case TRACE_ATTITUDE:
+      printf("roll=%.2f pitch=%.2f", high / 100.0, low / 100.0);
+      break;
+    case TRACE_PITCH_COMMAND:
+    case TRACE_ROLL_COMMAND:
+      printf("%d steps/s", static_cast<int32_t>(e.payload));
+      break;
+    case TRACE_LOOP_TICK:
+      printf("dt=%uus", e.payload);
+      break;
+    case TRACE_PITCH_STEP_LOSS:
+    case TRACE_ROLL_STEP_LOSS:
+      printf("limit=%u steps/s", e.payload);
+      break;
+    default:
+      printf("0x%08x", e.payload);
+  }
+}
+
+int main(int argc, char *argv[]){
+  FILE *input = argc > 1 ? fopen(argv[1], "rb") : stdin;
+  if(input == nullptr){
+    perror(argv[1]);
+    return 1;
+  }
+
+  TraceReader reader;
+  TraceEvent e;
+  uint32_t first = 0;
+  bool started = false;
+  int dumps = 0;
+
+  SampleLogReader logReader;
+  uint32_t firstSample = 0;
+  bool logStarted = false;
+  int logs = 0;
+  auto printSample = [&](uint32_t time, const Mpu6050Sample & s){
+    if(!logStarted){
+      firstSample = time;
+      logStarted = true;
+    }
+    printf("%12u acc=%d,%d,%d temp=%d gyro=%d,%d,%d\n", time - firstSample,
+      s.accX, s.accY, s.accZ, s.temperature, s.gyroX, s.gyroY, s.gyroZ);
+  };
+
+  int c;
+  while((c = fgetc(input)) != EOF){
+    switch(logReader.feed(c)){
+      case SampleLogReader::result::block: {
+        if(logReader.blocksRead == 1){
+          logStarted = false;
+          printf("# sample log %d: %u blocks\n", logs + 1, logReader.count);
+        }
+        // a damaged block stops short of the amount of samples in its header
+        size_t count = logReader.block[0] | logReader.block[1] << 8;
+        if(sampleLogFormat::decodeBlock(logReader.block, printSample) != count){
+          fprintf(stderr, "block %u of sample log %d is damaged\n", logReader.blocksRead, logs + 1);
+        }
+        break;
+      }
+      case SampleLogReader::result::done:
+        logs++;
+        printf("# sample log %d complete\n", logs);
+        fflush(stdout);
+        break;
+      case SampleLogReader::result::error:
+        fprintf(stderr, "sample log %d has a wrong checksum, the samples above may be corrupted\n", logs + 1);
+        break;
+      default:
+        break;
+    }
+    switch(reader.feed(c, e)){
+      case TraceReader::result::event: {
+        if(!started){
+          first = e.timestamp;
+          started = true;
+          printf("# dump %d: %u events at %u Hz\n", dumps + 1, reader.count, reader.clockHz);
+        }
+        // the difference is right even when the counter wrapped around once
+        double us = static_cast<uint32_t>(e.timestamp - first) * 1e6 / reader.clockHz;
+        const char *name = traceEventName(e.id);
+        if(name != nullptr){
+          printf("%12.1f %-13s ", us, name);
+        }else{
+          printf("%12.1f event%-8u ", us, e.id);
+        }
+        printPayload(e);
+        printf("\n");
+        break;
+      }
+      case TraceReader::result::done:
+        dumps++;
+        started = false;
+        printf("# dump %d complete\n", dumps);
+        fflush(stdout);
+        break;
+      case TraceReader::result::error:
+        started = false;
+        fprintf(stderr, "dump %d has a wrong checksum, the events above may be corrupted\n", dumps + 1);
+        break;
+      default:
+        break;
+    }
+  }
+  return dumps + logs > 0 ? 0 : 1;
+}